@@ -0,0 +1,64 @@
+#include "bench_util.hpp"
+#include "../models/atomic/raft_controller.hpp"
+
+// Throughput of per-message RSA signatures versus pairwise HMAC-SHA256 tags, for the
+// payloads RaftControllerModel authenticates (RequestVote, ResponseVote, AppendEntries).
+
+// Run fn repeatedly for roughly the given budget and return operations per second
+template <typename Fn>
+double OpsPerSecond(Fn fn, double budgetSeconds = 0.5) {
+    Stopwatch watch;
+    long ops = 0;
+    while (watch.elapsedSeconds() < budgetSeconds) {
+        fn();
+        ops++;
+    }
+    return ops / watch.elapsedSeconds();
+}
+
+int main() {
+    std::string privateKey = Crypto::PrivateKeyToBase64(Crypto::GeneratePrivateKey());
+    std::string publicKey = Crypto::PublicKeyToBase64(Crypto::GeneratePublicKey(Crypto::LoadPrivateKeyFromBase64(privateKey)));
+    std::string macKey = Crypto::GenerateSymmetricKey();
+
+    // Representative payloads
+    std::vector<std::pair<std::string, std::string>> payloads;
+    payloads.emplace_back("RequestVote", RequestMetadata{7, "node3", 42}.toString());
+    payloads.emplace_back("ResponseVote", ResponseMetadata{7, "node3", 42, true, "node5"}.toString());
+    std::vector<std::shared_ptr<IMessage<LogEntryType>>> entries;
+    for (int i = 0; i < 16; i++) {
+        entries.emplace_back(std::make_shared<LogEntryHeartbeat>(HeartbeatMetadata{"node3", i, 0.05 * i, HEARTBEAT_STATUS::PING}));
+    }
+    payloads.emplace_back("AppendEntries(16)", AppendEntriesMetadata{7, "node3", 41, 7, entries, 40}.toString());
+
+    printBenchHeader("Point-to-point authentication (ops/sec)",
+        {"payload", "bytes", "rsa sign", "rsa verify", "hmac tag", "hmac verify"});
+    for (const auto& [name, data] : payloads) {
+        std::string signature = Crypto::SignData(data, privateKey);
+        std::string mac = Crypto::ComputeHMAC(data, macKey);
+        printBenchRow(name, data.size(),
+            OpsPerSecond([&] { Crypto::SignData(data, privateKey); }),
+            OpsPerSecond([&] { Crypto::VerifySignature(data, publicKey, signature); }),
+            OpsPerSecond([&] { Crypto::ComputeHMAC(data, macKey); }),
+            OpsPerSecond([&] { Crypto::VerifyHMAC(data, macKey, mac); }));
+    }
+
+    // A broadcast is signed once and verified by every peer with RSA, with HMAC the sender
+    // computes one tag per peer (the MAC vector) and each peer verifies its own tag
+    const std::string& data = payloads.back().second;
+    double signSeconds = 1.0 / OpsPerSecond([&] { Crypto::SignData(data, privateKey); });
+    std::string signature = Crypto::SignData(data, privateKey);
+    double verifySeconds = 1.0 / OpsPerSecond([&] { Crypto::VerifySignature(data, publicKey, signature); });
+    double tagSeconds = 1.0 / OpsPerSecond([&] { Crypto::ComputeHMAC(data, macKey); });
+    std::string mac = Crypto::ComputeHMAC(data, macKey);
+    double checkSeconds = 1.0 / OpsPerSecond([&] { Crypto::VerifyHMAC(data, macKey, mac); });
+
+    printBenchHeader("AppendEntries broadcast, total CPU per message (us)",
+        {"nodes", "rsa", "hmac vector", "speedup"});
+    for (int nodes : {3, 5, 9, 33, 101}) {
+        double rsa = signSeconds + (nodes - 1) * verifySeconds;
+        double hmac = (nodes - 1) * (tagSeconds + checkSeconds);
+        printBenchRow(nodes, rsa * 1e6, hmac * 1e6, rsa / hmac);
+    }
+    return 0;
+}
@@ -0,0 +1,46 @@
+#include "bench_util.hpp"
+#include "../utils/cryptography/crypto.hpp"
+
+// SHA-256 throughput of Crypto::EntryDigests on batches of log-entry sized messages,
+// multi-buffer lanes versus the per-entry Crypto::EntryDigest loop the controller used before.
+// On CPUs with SHA extensions the loop is the path BatchHashing::AUTO picks.
+
+// Hash the batch repeatedly for roughly the given budget and return digests per second
+double DigestsPerSecond(const std::vector<std::string>& batch, BatchHashing mode, double budgetSeconds = 0.5) {
+    Stopwatch watch;
+    long digests = 0;
+    while (watch.elapsedSeconds() < budgetSeconds) {
+        digests += Crypto::EntryDigests(batch, mode).size();
+    }
+    return digests / watch.elapsedSeconds();
+}
+
+int main() {
+    const size_t batchSize = 256;
+    std::cout << "multi-buffer path available: " << (Crypto::MultiBufferHashingAvailable() ? "yes (AVX2)" : "no") << "\n";
+
+    printBenchHeader("Batched SHA-256, 256 messages per batch (digests/sec)",
+        {"bytes", "loop", "multi-buffer", "speedup", "loop MB/s", "multi MB/s"});
+    for (size_t bytes : {64, 128, 256, 512, 1024}) {
+        std::vector<std::string> batch;
+        for (size_t i = 0; i < batchSize; i++) {
+            batch.push_back(std::string(bytes, static_cast<char>(i)));
+        }
+        double loop = DigestsPerSecond(batch, BatchHashing::SEQUENTIAL);
+        double multi = DigestsPerSecond(batch, BatchHashing::MULTI_BUFFER);
+        printBenchRow(bytes, loop, multi, multi / loop, loop * bytes / 1e6, multi * bytes / 1e6);
+    }
+
+    // Real batches mix lengths, lanes are refilled as soon as their message is done
+    printBenchHeader("Mixed 64-1024 byte messages (digests/sec)", {"batch", "loop", "multi-buffer", "speedup"});
+    for (size_t count : {4, 8, 16, 64, 256}) {
+        std::vector<std::string> batch;
+        for (size_t i = 0; i < count; i++) {
+            batch.push_back(std::string(64 + (i * 193) % 961, static_cast<char>(i)));
+        }
+        double loop = DigestsPerSecond(batch, BatchHashing::SEQUENTIAL);
+        double multi = DigestsPerSecond(batch, BatchHashing::MULTI_BUFFER);
+        printBenchRow(count, loop, multi, multi / loop);
+    }
+    return 0;
+}
@@ -0,0 +1,44 @@
+#ifndef BENCH_UTIL_HPP
+#define BENCH_UTIL_HPP
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+// Small helpers shared by the benchmark executables
+
+// Wall clock stopwatch, started on construction
+class Stopwatch {
+    public:
+        Stopwatch() : start(std::chrono::steady_clock::now()) {}
+
+        void reset() {
+            start = std::chrono::steady_clock::now();
+        }
+
+        double elapsedSeconds() const {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point start;
+};
+
+// Print a section header followed by the column names
+inline void printBenchHeader(const std::string& title, std::initializer_list<std::string> columns) {
+    std::cout << "\n== " << title << " ==\n";
+    for (const auto& column : columns) {
+        std::cout << std::setw(18) << column;
+    }
+    std::cout << "\n";
+}
+
+// Print one row of values, aligned with printBenchHeader
+template <typename... Values>
+void printBenchRow(const Values&... values) {
+    ((std::cout << std::setw(18) << std::setprecision(6) << values), ...);
+    std::cout << "\n";
+}
+
+#endif
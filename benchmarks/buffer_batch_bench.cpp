@@ -0,0 +1,127 @@
+#include "bench_util.hpp"
+#include "../models/atomic/buffer.hpp"
+#include <cadmium/core/modeling/coupled.hpp>
+#include <cadmium/core/logger/logger.hpp>
+#include <cadmium/core/simulation/root_coordinator.hpp>
+
+// Scheduler cycles and wall time per delivered message when bursts go through a Buffer,
+// forwarding one message per cycle versus batches of B
+
+// Emits `bursts` bags of `burstSize` messages, one per simulated second
+struct BurstState {
+    int bursts;
+    double sigma = 0;
+};
+
+class BurstSource : public Atomic<BurstState> {
+    public:
+        Port<std::shared_ptr<std::string>> output_port;
+
+        BurstSource(const std::string& id, int bursts, int _burstSize) : Atomic<BurstState>(id, {bursts}), burstSize(_burstSize) {
+            output_port = addOutPort<std::shared_ptr<std::string>>("output");
+        }
+
+        void internalTransition(BurstState& s) const override {
+            s.bursts--;
+            s.sigma = s.bursts > 0 ? 1.0 : std::numeric_limits<double>::infinity();
+        }
+
+        void externalTransition(BurstState& s, double e) const override {}
+
+        void output(const BurstState& s) const override {
+            for (int i = 0; i < burstSize; i++) {
+                output_port -> addMessage(message);
+            }
+        }
+
+        double timeAdvance(const BurstState& s) const override {
+            return s.sigma;
+        }
+
+    private:
+        int burstSize;
+        std::shared_ptr<std::string> message = std::make_shared<std::string>("vote");
+};
+
+std::ostream& operator<<(std::ostream& os, const BurstState& s) {
+    return os << "bursts left: " << s.bursts;
+}
+
+// Counts the messages it receives, like a controller consuming a whole bag
+class CountingSink : public Atomic<size_t> {
+    public:
+        Port<std::shared_ptr<std::string>> input_port;
+
+        explicit CountingSink(const std::string& id) : Atomic<size_t>(id, 0) {
+            input_port = addInPort<std::shared_ptr<std::string>>("input");
+        }
+
+        void internalTransition(size_t& s) const override {}
+
+        void externalTransition(size_t& s, double e) const override {
+            s += input_port -> getBag().size();
+        }
+
+        void output(const size_t& s) const override {}
+
+        double timeAdvance(const size_t& s) const override {
+            return std::numeric_limits<double>::infinity();
+        }
+};
+
+class BurstModel : public Coupled {
+    public:
+        std::shared_ptr<CountingSink> sink;
+
+        BurstModel(int bursts, int burstSize, size_t batchSize) : Coupled("burst") {
+            auto source = addComponent<BurstSource>("source", bursts, burstSize);
+            auto buffer = addComponent<Buffer<std::string>>("buffer");
+            sink = addComponent<CountingSink>("sink");
+            buffer -> setBatching(batchSize);
+            addCoupling(source -> getOutPort("output"), buffer -> getInPort("input_buffer"));
+            addCoupling(buffer -> getOutPort("output_buffer"), sink -> getInPort("input"));
+        }
+};
+
+// Counts scheduler cycles, drops everything else
+class CycleCounter : public cadmium::Logger {
+    public:
+        size_t cycles = 0;
+
+        void start() override {}
+        void stop() override {}
+        void logTime(double time) override {
+            cycles++;
+        }
+        void logOutput(double, long, const std::string&, const std::string&, const std::string&) override {}
+        void logState(double, long, const std::string&, const std::string&) override {}
+};
+
+int main() {
+    const int bursts = 2000;
+    const int burstSize = 100;
+
+    printBenchHeader("Buffer batching, " + std::to_string(bursts) + " bursts of " + std::to_string(burstSize) + " messages",
+                     {"batch size", "cycles/msg", "ns/msg", "speedup"});
+    double baseline = 0;
+    for (size_t batchSize : {1, 8, 32, 100}) {
+        auto model = std::make_shared<BurstModel>(bursts, burstSize, batchSize);
+        auto counter = std::make_shared<CycleCounter>();
+        RootCoordinator root(model);
+        root.setLogger(counter);
+        Stopwatch watch;
+        root.simulate(bursts + 1.0);
+        double seconds = watch.elapsedSeconds();
+
+        size_t delivered = model -> sink -> getState();
+        if (delivered != static_cast<size_t>(bursts) * burstSize) {
+            std::cerr << "delivered " << delivered << " messages" << std::endl;
+            return 1;
+        }
+        if (batchSize == 1) {
+            baseline = seconds;
+        }
+        printBenchRow(batchSize, static_cast<double>(counter -> cycles) / delivered, seconds * 1e9 / delivered, baseline / seconds);
+    }
+    return 0;
+}
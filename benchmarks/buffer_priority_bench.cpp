@@ -0,0 +1,137 @@
+#include "bench_util.hpp"
+#include "../models/atomic/buffer.hpp"
+#include "../messages/raft/raft_messages.hpp"
+#include <cadmium/core/modeling/coupled.hpp>
+#include <cadmium/core/simulation/root_coordinator.hpp>
+#include <cmath>
+
+// How long a vote waits in the Raft input buffer behind a replication backlog, per scheduling
+// policy. Every simulated second a burst of AppendEntries batches arrives with one vote request
+// at its tail; the buffer serves one message per 10us.
+
+struct LoadState {
+    int bursts;
+    double sigma = 0;
+};
+
+std::ostream& operator<<(std::ostream& os, const LoadState& s) {
+    return os << "bursts left: " << s.bursts;
+}
+
+class ReplicationLoad : public Atomic<LoadState> {
+    public:
+        Port<std::shared_ptr<RaftMessage>> output_port;
+
+        ReplicationLoad(const std::string& id, int bursts, int _batches) : Atomic<LoadState>(id, {bursts}), batches(_batches) {
+            output_port = addOutPort<std::shared_ptr<RaftMessage>>("output");
+            AppendEntriesMetadata metadata;
+            metadata.entries.resize(16);
+            replication = std::make_shared<RaftMessage>(std::make_shared<AppendEntries>(metadata, ""));
+            vote = std::make_shared<RaftMessage>(std::make_shared<RequestVote>());
+        }
+
+        void internalTransition(LoadState& s) const override {
+            s.bursts--;
+            s.sigma = s.bursts > 0 ? 1.0 : std::numeric_limits<double>::infinity();
+        }
+
+        void externalTransition(LoadState& s, double e) const override {}
+
+        void output(const LoadState& s) const override {
+            for (int i = 0; i < batches; i++) {
+                output_port -> addMessage(replication);
+            }
+            output_port -> addMessage(vote);
+        }
+
+        double timeAdvance(const LoadState& s) const override {
+            return s.sigma;
+        }
+
+    private:
+        int batches;
+        std::shared_ptr<RaftMessage> replication;
+        std::shared_ptr<RaftMessage> vote;
+};
+
+// Time from the start of the burst to delivery, summed per message class
+struct WaitState {
+    double currentTime = 0;
+    double voteWait = 0;
+    double replicationWait = 0;
+    size_t votes = 0;
+    size_t replications = 0;
+};
+
+std::ostream& operator<<(std::ostream& os, const WaitState& s) {
+    return os << "votes: " << s.votes;
+}
+
+class WaitRecorder : public Atomic<WaitState> {
+    public:
+        Port<std::shared_ptr<RaftMessage>> input_port;
+
+        explicit WaitRecorder(const std::string& id) : Atomic<WaitState>(id, {}) {
+            input_port = addInPort<std::shared_ptr<RaftMessage>>("input");
+        }
+
+        void internalTransition(WaitState& s) const override {}
+
+        void externalTransition(WaitState& s, double e) const override {
+            s.currentTime += e;
+            // Bursts start on whole seconds
+            double wait = s.currentTime - std::floor(s.currentTime + 1e-12);
+            for (const auto& msg : input_port -> getBag()) {
+                if (msg -> priorityClass() == 0) {
+                    s.voteWait += wait;
+                    s.votes++;
+                } else {
+                    s.replicationWait += wait;
+                    s.replications++;
+                }
+            }
+        }
+
+        void output(const WaitState& s) const override {}
+
+        double timeAdvance(const WaitState& s) const override {
+            return std::numeric_limits<double>::infinity();
+        }
+};
+
+class LoadModel : public Coupled {
+    public:
+        std::shared_ptr<WaitRecorder> recorder;
+
+        LoadModel(int bursts, int batches, SchedulingPolicy scheduling) : Coupled("load") {
+            auto source = addComponent<ReplicationLoad>("source", bursts, batches);
+            auto buffer = addComponent<Buffer<RaftMessage>>("buffer");
+            recorder = addComponent<WaitRecorder>("recorder");
+            buffer -> setBatching(1, 10e-6);
+            buffer -> setScheduling(scheduling);
+            addCoupling(source -> getOutPort("output"), buffer -> getInPort("input_buffer"));
+            addCoupling(buffer -> getOutPort("output_buffer"), recorder -> getInPort("input"));
+        }
+};
+
+int main() {
+    const int bursts = 200;
+
+    for (int batches : {10, 100, 1000}) {
+        printBenchHeader("Vote behind " + std::to_string(batches) + " AppendEntries batches, " + std::to_string(bursts) + " bursts",
+                         {"scheduling", "vote wait us", "repl wait us", "wall ms"});
+        for (auto [name, scheduling] : {std::make_pair("fifo", SchedulingPolicy::FIFO),
+                                        std::make_pair("strict", SchedulingPolicy::STRICT_PRIORITY),
+                                        std::make_pair("weighted-fair", SchedulingPolicy::WEIGHTED_FAIR)}) {
+            auto model = std::make_shared<LoadModel>(bursts, batches, scheduling);
+            RootCoordinator root(model);
+            Stopwatch watch;
+            root.simulate(bursts + 1.0);
+            double seconds = watch.elapsedSeconds();
+
+            const WaitState& s = model -> recorder -> getState();
+            printBenchRow(name, s.voteWait * 1e6 / s.votes, s.replicationWait * 1e6 / s.replications, seconds * 1e3);
+        }
+    }
+    return 0;
+}
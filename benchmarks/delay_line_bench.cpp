@@ -0,0 +1,143 @@
+#include "bench_util.hpp"
+#include "../utils/queueing/delay_line.hpp"
+#include "../models/atomic/network.hpp"
+#include "../messages/raft/raft_messages.hpp"
+#include <queue>
+#include <random>
+
+// Event list throughput of DelayLine against the layout the processors used before it: a
+// priority_queue of heap-allocated events holding their remaining time, popped one per internal
+// transition. The "hold" workload keeps the list at a fixed size, each event scheduling one more.
+// The "burst" workload pushes groups due at the same instant, which DelayLine pops as one bag.
+
+struct LegacyEvent {
+    std::shared_ptr<int> item;
+    double time;
+};
+
+struct CompareLegacyEvent {
+    bool operator()(const std::shared_ptr<LegacyEvent>& a, const std::shared_ptr<LegacyEvent>& b) const {
+        return a -> time > b -> time;
+    }
+};
+
+using LegacyQueue = std::priority_queue<std::shared_ptr<LegacyEvent>, std::vector<std::shared_ptr<LegacyEvent>>, CompareLegacyEvent>;
+
+// Returns the number of transitions, each item delivered once
+size_t holdLegacy(size_t size, size_t items, int group) {
+    std::mt19937_64 rng(1);
+    std::exponential_distribution<double> delay(1e6);
+    auto item = std::make_shared<int>(0);
+    LegacyQueue queue;
+    double now = 0;
+    auto pushGroup = [&]() {
+        double due = now + delay(rng);
+        for (int i = 0; i < group; i++) {
+            queue.push(std::make_shared<LegacyEvent>(LegacyEvent{item, due}));
+        }
+    };
+    for (size_t i = 0; i < size; i++) {
+        pushGroup();
+    }
+    size_t transitions = 0;
+    for (size_t delivered = 0; delivered < items; ) {
+        now = queue.top() -> time;
+        queue.pop();
+        transitions++;
+        if (++delivered % group == 0) {
+            pushGroup();
+        }
+    }
+    return transitions;
+}
+
+size_t holdDelayLine(size_t size, size_t items, int group) {
+    std::mt19937_64 rng(1);
+    std::exponential_distribution<double> delay(1e6);
+    auto item = std::make_shared<int>(0);
+    DelayLine<std::shared_ptr<int>> line;
+    double now = 0;
+    auto pushGroup = [&]() {
+        double due = now + delay(rng);
+        for (int i = 0; i < group; i++) {
+            line.push(item, now, due);
+        }
+    };
+    for (size_t i = 0; i < size; i++) {
+        pushGroup();
+    }
+    size_t transitions = 0;
+    for (size_t delivered = 0; delivered < items; ) {
+        now = line.nextDue();
+        size_t bag = line.popDue().size();
+        transitions++;
+        for (size_t i = 0; i < bag; i++) {
+            if (++delivered % group == 0) {
+                pushGroup();
+            }
+        }
+    }
+    return transitions;
+}
+
+// Drives a NetworkModel directly, `packets` arriving between deliveries; returns the transitions run
+size_t driveNetwork(size_t packets) {
+    std::vector<std::string> nodes = {"node0", "node1", "node2"};
+    NetworkModel network("network", nodes);
+    NetworkState s;
+    s.activeNodes = nodes;
+    auto message = std::make_shared<RaftMessage>(std::make_shared<RequestVote>());
+    std::mt19937_64 rng(1);
+    std::exponential_distribution<double> gap(2e6);
+
+    size_t transitions = 0;
+    double nextArrival = gap(rng);
+    size_t sent = 0;
+    while (sent < packets || !s.packetQueue.empty()) {
+        double ta = network.timeAdvance(s);
+        double untilArrival = sent < packets ? nextArrival - s.currentTime : std::numeric_limits<double>::infinity();
+        if (untilArrival < ta) {
+            const std::string& dest = nodes[sent % nodes.size()];
+            network.input_ports[dest] -> addMessage(std::make_shared<Packet>(message, dest, nodes[(sent + 1) % nodes.size()]));
+            network.externalTransition(s, untilArrival);
+            network.input_ports[dest] -> clear();
+            nextArrival += gap(rng);
+            sent++;
+        } else {
+            network.output(s);
+            network.internalTransition(s);
+            for (auto& [node, port] : network.output_ports) {
+                port -> clear();
+            }
+        }
+        transitions++;
+    }
+    return transitions;
+}
+
+int main() {
+    const size_t items = 2000000;
+
+    for (int group : {1, 8}) {
+        printBenchHeader(std::string(group == 1 ? "Hold" : "Burst of 8 co-due items") + ", " + std::to_string(items) + " items",
+                         {"list size", "layout", "transitions", "Mitems/s", "Mevents/s"});
+        for (size_t size : {16, 1024, 65536}) {
+            Stopwatch watch;
+            size_t transitions = holdLegacy(size / group, items, group);
+            double seconds = watch.elapsedSeconds();
+            printBenchRow(size, "priority_queue", transitions, items / seconds / 1e6, transitions / seconds / 1e6);
+
+            watch.reset();
+            transitions = holdDelayLine(size / group, items, group);
+            seconds = watch.elapsedSeconds();
+            printBenchRow(size, "DelayLine", transitions, items / seconds / 1e6, transitions / seconds / 1e6);
+        }
+    }
+
+    const size_t packets = 500000;
+    printBenchHeader("NetworkModel, " + std::to_string(packets) + " packets", {"transitions", "Mevents/s"});
+    Stopwatch watch;
+    size_t transitions = driveNetwork(packets);
+    printBenchRow(transitions, transitions / watch.elapsedSeconds() / 1e6);
+    return 0;
+}
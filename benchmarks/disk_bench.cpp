@@ -0,0 +1,141 @@
+#include "bench_util.hpp"
+#include "../models/atomic/disk.hpp"
+#include <cadmium/core/modeling/coupled.hpp>
+#include <cadmium/core/simulation/root_coordinator.hpp>
+
+// What group commit and overlapping the leader's write with replication buy. A leader appends
+// batches of entries at a Poisson rate; each AppendEntries goes through the node's disk before it
+// reaches the network. Reported per disk mode: fsyncs per append, how long an append waits before
+// it can be sent, and how long until the leader's own copy is durable.
+
+struct AppendState {
+    int remaining;
+    double sigma = 0;
+};
+
+std::ostream& operator<<(std::ostream& os, const AppendState& s) {
+    return os << "appends left: " << s.remaining;
+}
+
+class AppendLoad : public Atomic<AppendState> {
+    public:
+        Port<std::shared_ptr<RaftMessage>> output_port;
+
+        AppendLoad(const std::string& id, int appends, double _rate) : Atomic<AppendState>(id, {appends}), rate(_rate) {
+            output_port = addOutPort<std::shared_ptr<RaftMessage>>("output");
+            AppendEntriesMetadata metadata;
+            for (int i = 0; i < 8; i++) {
+                metadata.entries.push_back(std::make_shared<LogEntryHeartbeat>());
+            }
+            append = std::make_shared<RaftMessage>(std::make_shared<AppendEntries>(metadata, ""));
+            append -> dest = "*";
+        }
+
+        void internalTransition(AppendState& s) const override {
+            s.remaining--;
+            s.sigma = s.remaining > 0 ? RandomNumberGeneratorDEVS::generateExponentialDelay(rate) : std::numeric_limits<double>::infinity();
+        }
+
+        void externalTransition(AppendState& s, double e) const override {}
+
+        void output(const AppendState& s) const override {
+            output_port -> addMessage(append);
+        }
+
+        double timeAdvance(const AppendState& s) const override {
+            return s.sigma;
+        }
+
+    private:
+        double rate;
+        std::shared_ptr<RaftMessage> append;
+};
+
+// Sums the time appends spend between the load and the network
+struct SendState {
+    double currentTime = 0;
+    std::vector<double> created;  // The load reuses one message, appends leave the disk in creation order
+    double sendDelay = 0;
+    size_t sent = 0;
+};
+
+std::ostream& operator<<(std::ostream& os, const SendState& s) {
+    return os << "sent: " << s.sent;
+}
+
+class SendRecorder : public Atomic<SendState> {
+    public:
+        Port<std::shared_ptr<RaftMessage>> input_port;
+        Port<std::shared_ptr<RaftMessage>> input_created;
+
+        explicit SendRecorder(const std::string& id) : Atomic<SendState>(id, {}) {
+            input_port = addInPort<std::shared_ptr<RaftMessage>>("input");
+            input_created = addInPort<std::shared_ptr<RaftMessage>>("created");
+        }
+
+        void internalTransition(SendState& s) const override {}
+
+        void externalTransition(SendState& s, double e) const override {
+            s.currentTime += e;
+            for (size_t i = 0; i < input_created -> getBag().size(); i++) {
+                s.created.push_back(s.currentTime);
+            }
+            for (size_t i = 0; i < input_port -> getBag().size(); i++) {
+                s.sendDelay += s.currentTime - s.created[s.sent];
+                s.sent++;
+            }
+        }
+
+        void output(const SendState& s) const override {}
+
+        double timeAdvance(const SendState& s) const override {
+            return std::numeric_limits<double>::infinity();
+        }
+};
+
+class DiskLoadModel : public Coupled {
+    public:
+        std::shared_ptr<SendRecorder> recorder;
+        std::shared_ptr<DiskModel> disk;
+
+        DiskLoadModel(int appends, double rate, const DiskConfig& config) : Coupled("disk-load") {
+            auto source = addComponent<AppendLoad>("source", appends, rate);
+            disk = addComponent<DiskModel>("disk");
+            recorder = addComponent<SendRecorder>("recorder");
+            disk -> setConfig(config);
+            addCoupling(source -> getOutPort("output"), disk -> getInPort("input_raft_message"));
+            addCoupling(source -> getOutPort("output"), recorder -> getInPort("created"));
+            addCoupling(disk -> getOutPort("output_raft_message"), recorder -> getInPort("input"));
+        }
+};
+
+int main() {
+    const int appends = 20000;
+    RandomNumberGeneratorDEVS::seed(1);
+
+    for (double rate : {100.0, 1000.0, 5000.0}) {
+        printBenchHeader("Appends of 8 entries at " + std::to_string(static_cast<int>(rate)) + "/s, 2ms mean fsync",
+                         {"disk", "fsyncs/append", "send wait us", "durable us", "wall ms"});
+        for (auto [name, groupCommit, overlap] : {std::make_tuple("fsync each", false, false),
+                                                  std::make_tuple("group commit", true, false),
+                                                  std::make_tuple("group+overlap", true, true)}) {
+            DiskConfig config;
+            config.groupCommit = groupCommit;
+            config.overlapSend = overlap;
+
+            MetricsRegistry registry;
+            MetricsRegistry::Activate(&registry);
+            auto model = std::make_shared<DiskLoadModel>(appends, rate, config);
+            RootCoordinator root(model);
+            Stopwatch watch;
+            root.simulate(std::numeric_limits<double>::infinity());
+            double seconds = watch.elapsedSeconds();
+            MetricsRegistry::Activate(nullptr);
+
+            const SendState& s = model -> recorder -> getState();
+            printBenchRow(name, static_cast<double>(model -> disk -> getState().fsyncs) / appends, s.sendDelay * 1e6 / s.sent,
+                          registry.findHistogram("disk/write_latency") -> mean() * 1e6, seconds * 1e3);
+        }
+    }
+    return 0;
+}
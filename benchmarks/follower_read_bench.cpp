@@ -0,0 +1,72 @@
+#include "bench_util.hpp"
+#include "../models/coupled/simulation.hpp"
+#include <cadmium/core/simulation/root_coordinator.hpp>
+
+// What follower reads take off the leader as the cluster grows. A Poisson client sends a 95%
+// read mix to clusters of 3, 5 and 7 nodes, each with one CPU core spending 20us on every
+// message it encodes or decodes. Reads go
+// to the leader with ReadIndex, or to random nodes that ask the leader for a read index, or to
+// random nodes that answer from their own state while close enough behind. Reported per mode:
+// reads completed per simulated second, their latency, and how busy the leader's and the
+// followers' CPUs were over the whole run.
+
+int main() {
+    const double start = 0.5;  // After the first election
+    const double duration = 2.0;
+    const double rate = 5000;
+    ServiceTimes times;
+    times.base = 2e-5;
+
+    for (size_t clusterSize : {3, 5, 7}) {
+        printBenchHeader(std::to_string(clusterSize) + " nodes, " + std::to_string(static_cast<int>(rate)) + " requests/s, 95% reads, " + std::to_string(static_cast<int>(duration)) + "s",
+                         {"reads", "reads/s", "p50 us", "p99 us", "leader cpu %", "follower cpu %", "wall ms"});
+        for (auto [name, mode] : {std::make_pair("leader only", FollowerReadMode::OFF),
+                                  std::make_pair("follower index", FollowerReadMode::READ_INDEX),
+                                  std::make_pair("bounded stale", FollowerReadMode::BOUNDED_STALE)}) {
+            RandomNumberGeneratorDEVS::seed(1);
+            ClientConfig client;
+            client.rate = rate;
+            client.start = start;
+            client.readFraction = 0.95;
+            client.spreadReads = mode != FollowerReadMode::OFF;
+
+            auto model = std::make_shared<SimulationModel>("simulation", AuthMode::NONE, client, clusterSize);
+            model -> setCpu(1, times);
+            model -> setReadMode(ReadMode::READ_INDEX);
+            model -> setFollowerReads(mode, 8);
+            RootCoordinator root(model);
+            Stopwatch watch;
+            root.simulate(start + duration);
+            double seconds = watch.elapsedSeconds();
+
+            double leaderCpu = 0;
+            double followerCpu = 0;
+            for (size_t i = 0; i < clusterSize; i++) {
+                auto node = std::dynamic_pointer_cast<NodeModel>(model -> getComponent("node" + std::to_string(i)));
+                auto raft = std::dynamic_pointer_cast<RaftModel>(node -> getComponent("raft"));
+                auto controller = std::dynamic_pointer_cast<RaftControllerModel>(raft -> getComponent("raft-controller"));
+                double utilization = node -> getCpu() -> utilization(start + duration);
+                if (controller -> getState().state == RaftStatus::LEADER) {
+                    leaderCpu = utilization;
+                } else {
+                    followerCpu += utilization / (clusterSize - 1);
+                }
+            }
+
+            const ClientState& s = std::dynamic_pointer_cast<ClientModel>(model -> getComponent("client")) -> getState();
+            std::vector<double> latencies;
+            for (const auto& record : s.completed) {
+                if (record.operation == ClientOperation::READ) {
+                    latencies.push_back(record.responseTime - record.submitTime);
+                }
+            }
+            std::sort(latencies.begin(), latencies.end());
+            auto percentile = [&](double q) {
+                return latencies.empty() ? 0 : latencies[std::min(latencies.size() - 1, static_cast<size_t>(q * latencies.size()))];
+            };
+            printBenchRow(name, latencies.size() / duration, percentile(0.5) * 1e6, percentile(0.99) * 1e6,
+                          leaderCpu * 100, followerCpu * 100, seconds * 1e3);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include "bench_util.hpp"
+#include "../models/coupled/simulation.hpp"
+#include "../logger/raft_logger.hpp"
+#include <cadmium/core/simulation/root_coordinator.hpp>
+#include <cstdio>
+
+// Simulation events per second with logging off, with the old synchronous text logger
+// (std::endl on every line) and with RAFTLogger's asynchronous ring buffer.
+
+// The previous RAFTLogger: formats and flushes on the simulation thread
+class SyncTextLogger : public cadmium::Logger {
+    public:
+        explicit SyncTextLogger(const std::string& path) : logFile(path, std::ios::out | std::ios::trunc) {}
+
+        void start() override { logFile << "RAFT Simulation Started." << std::endl; }
+        void stop() override { logFile << "RAFT Simulation Ended." << std::endl; }
+        void logTime(double time) override { logFile << "Simulation Time: " << time << std::endl; }
+        void logOutput(double time, long, const std::string&, const std::string&, const std::string& output) override {
+            logFile << "[" << time << "] " << " | Output size: " << output.size() << " | Ouput: " << output << std::endl;
+        }
+        void logState(double time, long, const std::string& modelName, const std::string& state) override {
+            logFile << "[" << time << "] " << modelName << " | Current State: " << state << std::endl;
+        }
+
+    private:
+        std::ofstream logFile;
+};
+
+// Counts state transitions (one logState per event) and forwards to another logger, if any
+class CountingLogger : public cadmium::Logger {
+    public:
+        explicit CountingLogger(std::shared_ptr<cadmium::Logger> _inner) : inner(std::move(_inner)) {}
+
+        long events = 0;
+
+        void start() override { if (inner) inner -> start(); }
+        void stop() override { if (inner) inner -> stop(); }
+        void logTime(double time) override { if (inner) inner -> logTime(time); }
+        void logOutput(double time, long modelId, const std::string& modelName, const std::string& portName, const std::string& output) override {
+            if (inner) inner -> logOutput(time, modelId, modelName, portName, output);
+        }
+        void logState(double time, long modelId, const std::string& modelName, const std::string& state) override {
+            events++;
+            if (inner) inner -> logState(time, modelId, modelName, state);
+        }
+
+    private:
+        std::shared_ptr<cadmium::Logger> inner;
+};
+
+int main() {
+    const double simulatedSeconds = 200.0;
+    const std::string path = "logs/bench_logger.txt";
+
+    struct Run { std::string name; double loopSeconds; double totalSeconds; long events; uint64_t dropped; };
+    std::vector<Run> runs;
+    for (const std::string mode : {"off", "sync endl", "async block", "async drop"}) {
+        std::shared_ptr<cadmium::Logger> inner;
+        std::shared_ptr<RAFTLogger> async;
+        if (mode == "sync endl") {
+            inner = std::make_shared<SyncTextLogger>(path);
+        } else if (mode == "async block") {
+            async = std::make_shared<RAFTLogger>(LogOverflowPolicy::BLOCK, 1 << 14, path);
+        } else if (mode == "async drop") {
+            async = std::make_shared<RAFTLogger>(LogOverflowPolicy::DROP, 1 << 14, path);
+        }
+        if (async) {
+            inner = async;
+        }
+        auto logger = std::make_shared<CountingLogger>(inner);
+
+        auto model = std::make_shared<SimulationModel>("simulation");
+        RootCoordinator root(model);
+        root.setLogger(logger);
+
+        Stopwatch watch;
+        logger -> start();
+        root.simulate(simulatedSeconds);
+        double loopSeconds = watch.elapsedSeconds();
+        // Includes draining whatever is still queued
+        logger -> stop();
+        runs.push_back({mode, loopSeconds, watch.elapsedSeconds(), logger -> events, async ? async -> droppedRecords() : 0});
+    }
+    std::remove(path.c_str());
+
+    // One transition's worth of state logging for a controller: full dump versus delta
+    RaftControllerModel controller("raft-controller");
+    controller.getState().privateKey = std::string(1600, 'k');
+    controller.getState().publicKeys.assign(5, std::string(400, 'p'));
+    const int calls = 200000;
+    size_t bytes[2] = {0, 0};
+    double seconds[2];
+    for (int delta = 0; delta < 2; delta++) {
+        Stopwatch stateWatch;
+        for (int i = 0; i < calls; i++) {
+            controller.getState().currentTime = i * 0.001;
+            if (delta) {
+                bytes[delta] += controller.logState().size();
+            } else {
+                std::stringstream ss;
+                ss << controller.getState();
+                bytes[delta] += ss.str().size();
+            }
+        }
+        seconds[delta] = stateWatch.elapsedSeconds();
+    }
+
+    printBenchHeader("RaftState logging, only currentTime changes", {"mode", "ns/call", "bytes/call"});
+    printBenchRow("full", seconds[0] / calls * 1e9, bytes[0] / calls);
+    printBenchRow("delta", seconds[1] / calls * 1e9, bytes[1] / calls);
+
+    printBenchHeader("Simulation with logging, 200 simulated seconds",
+        {"logger", "events", "loop (s)", "with drain (s)", "events/sec", "dropped"});
+    for (const auto& run : runs) {
+        printBenchRow(run.name, run.events, run.loopSeconds, run.totalSeconds, run.events / run.totalSeconds, run.dropped);
+    }
+    return 0;
+}
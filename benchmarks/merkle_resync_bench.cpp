@@ -0,0 +1,46 @@
+#include "bench_util.hpp"
+#include "../models/atomic/raft_controller.hpp"
+
+// Cost of bringing a rejoining follower back in line with the leader when their logs share a
+// prefix and then diverge. Compares the Merkle subtree exchange with a binary search over the
+// chain digests and with resending the whole leader log.
+
+int main() {
+    const size_t sharedPrefix = 100000;
+    // Heartbeat entries are what the log mostly holds, use their serialized size
+    const size_t entrySize = LogEntryHeartbeat(HeartbeatMetadata{"node1", 100000, 12.5, HEARTBEAT_STATUS::PING}).toString().size();
+
+    printBenchHeader("Follower resync, shared prefix of 1e5 entries",
+        {"tail", "merkle rtt", "merkle bytes", "chain rtt", "chain bytes", "resend bytes", "reconcile(s)"});
+
+    for (size_t tail : {size_t(10), size_t(10000), size_t(1000000)}) {
+        MerkleLogIndex follower;
+        MerkleLogIndex leader;
+        std::vector<std::string> followerChain;
+        std::vector<std::string> leaderChain;
+        for (size_t i = 0; i < sharedPrefix + tail; i++) {
+            std::string leaderDigest = Crypto::EntryDigest("entry-" + std::to_string(i));
+            std::string followerDigest = i < sharedPrefix ? leaderDigest : Crypto::EntryDigest("stale-" + std::to_string(i));
+            leader.append(leaderDigest);
+            follower.append(followerDigest);
+            leaderChain.push_back(Crypto::LinkDigest(leaderChain.empty() ? "" : leaderChain.back(), leaderDigest));
+            followerChain.push_back(Crypto::LinkDigest(followerChain.empty() ? "" : followerChain.back(), followerDigest));
+        }
+
+        Stopwatch watch;
+        ResyncReport report = MerkleLogIndex::Reconcile(follower, leader, [&](size_t) { return entrySize; });
+        double reconcileSeconds = watch.elapsedSeconds();
+
+        // Chain digests: one digest per round trip to find the shared prefix, then the suffix
+        int chainLookups = 0;
+        int divergence = RaftControllerModel::FindDivergenceIndex(followerChain, leaderChain.size(), [&](int index) {
+            chainLookups++;
+            return leaderChain[index];
+        });
+        size_t chainBytes = chainLookups * SHA256::DIGESTSIZE + (leaderChain.size() - divergence) * entrySize;
+
+        printBenchRow(tail, report.roundTrips, report.hashBytes + report.entryBytes,
+            chainLookups + 1, chainBytes, leader.size() * entrySize, reconcileSeconds);
+    }
+    return 0;
+}
@@ -0,0 +1,42 @@
+// Every atomic in the coupled models is wrapped in Profiled
+#define RAFT_PROFILE_MODELS
+#include "bench_util.hpp"
+#include "../models/coupled/simulation.hpp"
+#include <cadmium/core/simulation/root_coordinator.hpp>
+#include <sstream>
+
+// Cost of the Profiled wrapper with the profiler off and on, then the ranked report of one run
+
+double Simulate(double simulatedSeconds, bool profile, std::ostream& report) {
+    auto model = std::make_shared<SimulationModel>("simulation");
+    RootCoordinator root(model);
+    Stopwatch watch;
+    if (profile) {
+        SimulateProfiled(root, simulatedSeconds, report);
+    } else {
+        root.simulate(simulatedSeconds);
+    }
+    return watch.elapsedSeconds();
+}
+
+int main() {
+    const double simulatedSeconds = 20;
+    const int runs = 5;
+
+    std::ostringstream report;
+    double offSeconds = 0;
+    double onSeconds = 0;
+    for (int i = 0; i < runs; i++) {
+        offSeconds += Simulate(simulatedSeconds, false, report);
+        report.str("");
+        onSeconds += Simulate(simulatedSeconds, true, report);
+    }
+
+    printBenchHeader("Profiled wrapper, " + std::to_string(runs) + " runs of " + std::to_string(static_cast<int>(simulatedSeconds)) + "s simulated",
+                     {"profiler", "wall ms/run", "overhead %"});
+    printBenchRow("off", offSeconds * 1e3 / runs, 0);
+    printBenchRow("on", onSeconds * 1e3 / runs, 100 * (onSeconds - offSeconds) / offSeconds);
+
+    std::cout << "\n" << report.str();
+    return 0;
+}
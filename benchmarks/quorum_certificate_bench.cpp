@@ -0,0 +1,65 @@
+#include "bench_util.hpp"
+#include "../models/atomic/raft_controller.hpp"
+
+// Compares the size of the first AppendEntries a new leader broadcasts when the proof is
+// the copied ResponseVote list (previous layout) versus the compact QuorumCertificate.
+
+// Base64 RSA-2048 signature length, used so both layouts carry realistic signatures
+const std::string SIGNATURE(344, 'A');
+
+// Serialized size of the proof as the previous LogEntryRAFT::toString() produced it
+size_t LegacyProofBytes(const RequestVote& request, const std::vector<ResponseVote>& votes) {
+    std::stringstream ss;
+    ss << "LogEntryRAFT { "
+       << "requestMessage: {" << request.toString() << "}, "
+       << "messageList: [";
+    for (const auto& vote : votes) {
+        ss << vote.toString() << ", ";
+    }
+    ss << "] }";
+    return ss.str().size();
+}
+
+int main() {
+    printBenchHeader("First AppendEntries proof size (bytes, toString)",
+        {"nodes", "legacy/follower", "qc/follower", "legacy/election", "qc/election", "validate(us)"});
+
+    for (int nodes : {3, 5, 9, 33, 101, 257, 1001}) {
+        RaftControllerModel model("bench");
+        RaftState s;
+        s.nodeID = "node0";
+        s.currentTerm = 1;
+        for (int i = 1; i < nodes; i++) {
+            s.peers.push_back("node" + std::to_string(i));
+        }
+        RaftControllerModel::InternClusterMembers(s);
+
+        RequestVote request(RequestMetadata{1, "node0", 0}, SIGNATURE);
+        std::vector<ResponseVote> votes;
+        for (const auto& peer : s.peers) {
+            auto vote = std::make_shared<ResponseVote>(ResponseMetadata{1, "node0", 0, true, peer}, SIGNATURE);
+            votes.push_back(*vote);
+            s.tempMessageStorage.push_back(vote);
+        }
+
+        QuorumCertificate certificate = model.BuildQuorumCertificate(s);
+        auto entry = std::make_shared<LogEntryRAFT>(logEntryMetadata{request, certificate});
+
+        size_t legacyBytes = LegacyProofBytes(request, votes);
+        size_t compactBytes = entry -> toString().size();
+
+        // Validation cost now that votes are counted with popcount
+        const int iterations = 10000;
+        bool valid = true;
+        Stopwatch watch;
+        for (int i = 0; i < iterations; i++) {
+            valid &= model.ValidateRAFTEntry(s, entry);
+        }
+        double validateMicros = watch.elapsedSeconds() / iterations * 1e6;
+
+        // The proof is broadcast once to every follower per election
+        printBenchRow(nodes, legacyBytes, compactBytes,
+            legacyBytes * (nodes - 1), compactBytes * (nodes - 1), valid ? validateMicros : -1.0);
+    }
+    return 0;
+}
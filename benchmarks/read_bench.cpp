@@ -0,0 +1,47 @@
+#include "bench_util.hpp"
+#include "../models/coupled/simulation.hpp"
+#include <cadmium/core/simulation/root_coordinator.hpp>
+
+// What serving reads outside the log buys. A closed-loop client keeps reads in flight against a
+// 3-node cluster with default disks, once through the log, once with ReadIndex and once with
+// leader leases. Reported per mode: reads completed per simulated second, their latency, and the
+// entries the leader's log grew by.
+
+int main() {
+    const double start = 0.5;  // After the first election
+    const double duration = 2.0;
+
+    for (size_t outstanding : {1, 8, 32}) {
+        printBenchHeader("Closed-loop reads, " + std::to_string(outstanding) + " outstanding, " + std::to_string(static_cast<int>(duration)) + "s",
+                         {"read mode", "reads/s", "p50 us", "p99 us", "log entries", "wall ms"});
+        for (auto [name, mode] : {std::make_pair("log", ReadMode::LOG),
+                                  std::make_pair("read index", ReadMode::READ_INDEX),
+                                  std::make_pair("lease", ReadMode::LEASE)}) {
+            RandomNumberGeneratorDEVS::seed(1);
+            ClientConfig client;
+            client.arrivals = ArrivalProcess::CLOSED_LOOP;
+            client.outstanding = outstanding;
+            client.start = start;
+            client.readFraction = 1;
+
+            auto model = std::make_shared<SimulationModel>("simulation", AuthMode::NONE, client);
+            model -> setDisk(DiskConfig());
+            model -> setReadMode(mode);
+            RootCoordinator root(model);
+            Stopwatch watch;
+            root.simulate(start + duration);
+            double seconds = watch.elapsedSeconds();
+
+            size_t logEntries = 0;
+            for (const std::string nodeID : {"node0", "node1", "node2"}) {
+                auto raft = std::dynamic_pointer_cast<RaftModel>(std::dynamic_pointer_cast<NodeModel>(model -> getComponent(nodeID)) -> getComponent("raft"));
+                auto controller = std::dynamic_pointer_cast<RaftControllerModel>(raft -> getComponent("raft-controller"));
+                logEntries = std::max(logEntries, controller -> getState().messageLog.size());
+            }
+            const ClientState& s = std::dynamic_pointer_cast<ClientModel>(model -> getComponent("client")) -> getState();
+            printBenchRow(name, s.completed.size() / duration, s.latencyPercentile(0.5) * 1e6, s.latencyPercentile(0.99) * 1e6,
+                          logEntries, seconds * 1e3);
+        }
+    }
+    return 0;
+}
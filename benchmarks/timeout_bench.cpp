@@ -0,0 +1,89 @@
+#include "bench_util.hpp"
+#include "../models/coupled/simulation.hpp"
+#include <cadmium/core/simulation/root_coordinator.hpp>
+
+// Fixed election timers against timers derived from observed round trips, on three network
+// profiles. A 3-node cluster runs without faults for 10s, an election started after the first 3s
+// is a false one. In a second run the leader is cut off for good at 3s, failover is the time until
+// another node wins an election. Reported per profile: the smoothed RTT and the lower end of the
+// election window the leader ends up with, false elections, and failover time.
+
+struct Profile {
+    std::string name;  // With the delays, for the header
+    double latency;  // One-way, fixed part
+    double jitter;  // Mean of the exponential part
+};
+
+struct Outcome {
+    std::vector<RaftState> states;  // Every node's controller at the end
+    uint64_t elections = 0;  // Started, over all nodes
+    double rtt = 0;  // The last leader's smoothed RTT
+    double electionTimeout = 0;  // and the lower end of its election window
+};
+
+// A seeded 3-node cluster run until `until`, with `isolated` cut off from `crash` on
+static Outcome Run(const Profile& profile, bool adaptive, double until, const std::string& isolated = "", double crash = 0) {
+    RandomNumberGeneratorDEVS::seed(1);
+    MetricsRegistry registry;
+    MetricsRegistry::Activate(&registry);
+    auto model = std::make_shared<SimulationModel>("simulation");
+    model -> setLatency(profile.latency, profile.jitter);
+    TimeoutConfig timeouts;
+    timeouts.adaptive = adaptive;
+    model -> setTimeouts(timeouts);
+    if (!isolated.empty()) {
+        model -> isolate(isolated, crash);
+    }
+    RootCoordinator root(model);
+    root.simulate(until);
+    MetricsRegistry::Activate(nullptr);
+
+    Outcome outcome;
+    for (const std::string nodeID : {"node0", "node1", "node2"}) {
+        auto raft = std::dynamic_pointer_cast<RaftModel>(std::dynamic_pointer_cast<NodeModel>(model -> getComponent(nodeID)) -> getComponent("raft"));
+        auto controller = std::dynamic_pointer_cast<RaftControllerModel>(raft -> getComponent("raft-controller"));
+        outcome.states.push_back(controller -> getState());
+        outcome.elections += registry.findCounter(nodeID + "/raft-controller/elections_started") -> value();
+        if (controller -> getState().state == RaftStatus::LEADER) {
+            outcome.rtt = controller -> getState().timers.getEstimator().smoothed();
+            outcome.electionTimeout = controller -> getState().timers.electionTimeoutMin();
+        }
+    }
+    return outcome;
+}
+
+int main() {
+    const double duration = 10.0;
+    const double crash = 3.0;
+
+    for (const Profile& profile : {Profile{"LAN, 50us + exp(20us) one way", 50e-6, 20e-6},
+                                   Profile{"regional, 5ms + exp(2ms) one way", 5e-3, 2e-3},
+                                   Profile{"WAN, 60ms + exp(30ms) one way", 60e-3, 30e-3}}) {
+        printBenchHeader(profile.name, {"timers", "rtt ms", "election ms", "false elections", "failover ms", "wall ms"});
+        for (bool adaptive : {false, true}) {
+            Stopwatch watch;
+            Outcome steady = Run(profile, adaptive, duration);
+
+            // Same seed, so the run matches the one above up to the cut and the same node leads then
+            Outcome warmup = Run(profile, adaptive, crash);
+            std::string leader;
+            int term = 0;
+            for (const RaftState& s : warmup.states) {
+                if (s.state == RaftStatus::LEADER && s.currentTerm >= term) {
+                    leader = s.nodeID;
+                    term = s.currentTerm;
+                }
+            }
+            double failover = -1;
+            for (const RaftState& s : Run(profile, adaptive, duration, leader, crash).states) {
+                if (s.nodeID != leader && s.state == RaftStatus::LEADER && s.currentTerm > term) {
+                    failover = s.electedAt - crash;
+                }
+            }
+            double seconds = watch.elapsedSeconds();
+            printBenchRow(adaptive ? "adaptive" : "fixed", steady.rtt * 1e3, steady.electionTimeout * 1e3,
+                          steady.elections - warmup.elections, failover * 1e3, seconds * 1e3);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include "bench_util.hpp"
+#include "../models/coupled/simulation.hpp"
+#include "../logger/raft_logger.hpp"
+#include "../logger/binary_trace_logger.hpp"
+#include <cadmium/core/simulation/root_coordinator.hpp>
+#include <cstdio>
+
+// Size of the same simulation logged as RAFTLogger text and as a binary trace, and the time
+// to read each back into records.
+
+template <typename LoggerType>
+double Simulate(std::shared_ptr<LoggerType> logger, double simulatedSeconds, AuthMode authMode) {
+    auto model = std::make_shared<SimulationModel>("simulation", authMode);
+    RootCoordinator root(model);
+    root.setLogger(logger);
+    Stopwatch watch;
+    logger -> start();
+    root.simulate(simulatedSeconds);
+    logger -> stop();
+    return watch.elapsedSeconds();
+}
+
+std::string ReadFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+// Log the same simulation both ways and print one comparison table
+void Compare(const std::string& title, AuthMode authMode, double simulatedSeconds) {
+    const std::string textPath = "logs/bench_trace.txt";
+    const std::string binaryPath = "logs/bench_trace.bin";
+
+    double textSeconds = Simulate(std::make_shared<RAFTLogger>(LogOverflowPolicy::BLOCK, 1 << 14, textPath), simulatedSeconds, authMode);
+    double binarySeconds = Simulate(std::make_shared<BinaryTraceLogger>(binaryPath), simulatedSeconds, authMode);
+
+    // Reading back: split the text into lines and parse the time of each, decode the binary trace
+    std::string text = ReadFile(textPath);
+    Stopwatch watch;
+    long textRecords = 0;
+    double timeSum = 0;
+    for (size_t start = 0; start < text.size();) {
+        size_t end = text.find('\n', start);
+        end = (end == std::string::npos) ? text.size() : end;
+        if (text[start] == '[') {
+            timeSum += std::strtod(text.c_str() + start + 1, nullptr);
+        }
+        textRecords++;
+        start = end + 1;
+    }
+    double textParse = watch.elapsedSeconds();
+
+    std::string binary = ReadFile(binaryPath);
+    watch.reset();
+    BinaryTrace::Decoder decoder(binary.data(), binary.size());
+    LogRecord record;
+    long binaryRecords = 0;
+    while (decoder.next(record)) {
+        timeSum += record.time;
+        binaryRecords++;
+    }
+    double binaryParse = watch.elapsedSeconds();
+
+    printBenchHeader(title, {"format", "records", "bytes", "simulate (s)", "read back (s)"});
+    printBenchRow("text", textRecords, text.size(), textSeconds, textParse);
+    printBenchRow("binary", binaryRecords, binary.size(), binarySeconds, binaryParse);
+    std::cout << "size ratio: " << static_cast<double>(text.size()) / binary.size() << "x\n";
+
+    std::remove(textPath.c_str());
+    std::remove(binaryPath.c_str());
+}
+
+int main() {
+    // With authentication on, every controller state dump carries the node's keys
+    Compare("200 simulated seconds, no authentication", AuthMode::NONE, 200.0);
+    Compare("200 simulated seconds, RSA authentication", AuthMode::RSA, 200.0);
+    return 0;
+}
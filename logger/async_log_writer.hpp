@@ -0,0 +1,222 @@
+#ifndef ASYNC_LOG_WRITER_HPP
+#define ASYNC_LOG_WRITER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// What the producer does when the ring is full
+enum class LogOverflowPolicy {
+    BLOCK,  // Wait for the writer thread to free slots, nothing is lost
+    DROP    // Discard the record and count it, the simulation never waits on I/O
+};
+
+enum class LogRecordKind : uint8_t { START, STOP, TIME, OUTPUT, STATE, DIAGNOSTIC };
+
+// A log call as seen by the writer thread
+struct LogRecord {
+    LogRecordKind kind;
+    double time;
+    long modelId;
+    std::string modelName;
+    std::string portName;
+    std::string payload;
+};
+
+// Moves log records off the simulation thread. The producer copies each record into fixed-size
+// slots of a bounded single-producer/single-consumer ring (records longer than one slot use
+// consecutive slots), and a background thread reassembles them, formats them and writes the
+// result to the stream in large blocks. cadmium serializes logger calls through the logger
+// mutex, so there is one producer at a time.
+class AsyncLogWriter {
+    public:
+        using Formatter = std::function<void(const LogRecord&, std::string&)>;
+
+        static constexpr size_t SLOT_BYTES = 232;
+        static constexpr size_t FLUSH_BYTES = 1 << 20;
+
+        // capacity is rounded up to a power of two slots
+        AsyncLogWriter(std::ostream& _out, Formatter _formatter, LogOverflowPolicy _policy = LogOverflowPolicy::BLOCK, size_t capacity = 1 << 14)
+            : out(_out), formatter(std::move(_formatter)), policy(_policy) {
+            size_t slotCount = 1;
+            while (slotCount < capacity) {
+                slotCount <<= 1;
+            }
+            slots.resize(slotCount);
+            mask = slotCount - 1;
+            writer = std::thread([this] { run(); });
+        }
+
+        ~AsyncLogWriter() {
+            stop();
+        }
+
+        AsyncLogWriter(const AsyncLogWriter&) = delete;
+        AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+
+        // Queue one record, returns false if it was dropped
+        bool push(LogRecordKind kind, double time, long modelId, const std::string& modelName,
+                  const std::string& portName, const std::string& payload) {
+            // Packed as [u16 name length][name][u16 port length][port][payload]
+            size_t nameLength = std::min<size_t>(modelName.size(), UINT16_MAX);
+            size_t portLength = std::min<size_t>(portName.size(), UINT16_MAX);
+            size_t length = 4 + nameLength + portLength + payload.size();
+            size_t needed = std::max<size_t>(1, (length + SLOT_BYTES - 1) / SLOT_BYTES);
+            // A record larger than the whole ring could never be written, cut its payload
+            if (needed > slots.size()) {
+                needed = slots.size();
+                length = needed * SLOT_BYTES;
+            }
+
+            size_t head = headIndex.load(std::memory_order_relaxed);
+            while (head + needed - tailIndex.load(std::memory_order_acquire) > slots.size()) {
+                if (policy == LogOverflowPolicy::DROP) {
+                    droppedRecords.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                std::this_thread::yield();
+            }
+
+            Slot& first = slots[head & mask];
+            first.time = time;
+            first.modelId = modelId;
+            first.length = static_cast<uint32_t>(length);
+            first.kind = kind;
+
+            size_t written = 0;
+            auto put = [&](const char* data, size_t size) {
+                while (size > 0 && written < length) {
+                    size_t offset = written % SLOT_BYTES;
+                    size_t chunk = std::min({size, SLOT_BYTES - offset, length - written});
+                    std::memcpy(slots[(head + written / SLOT_BYTES) & mask].bytes + offset, data, chunk);
+                    data += chunk;
+                    size -= chunk;
+                    written += chunk;
+                }
+            };
+            uint16_t prefix = static_cast<uint16_t>(nameLength);
+            put(reinterpret_cast<const char*>(&prefix), 2);
+            put(modelName.data(), nameLength);
+            prefix = static_cast<uint16_t>(portLength);
+            put(reinterpret_cast<const char*>(&prefix), 2);
+            put(portName.data(), portLength);
+            put(payload.data(), payload.size());
+
+            headIndex.store(head + needed, std::memory_order_release);
+            return true;
+        }
+
+        // Drain everything queued so far, write it out and stop the writer thread
+        void stop() {
+            if (writer.joinable()) {
+                stopping.store(true, std::memory_order_release);
+                writer.join();
+            }
+        }
+
+        uint64_t dropped() const {
+            return droppedRecords.load(std::memory_order_relaxed);
+        }
+
+        size_t capacity() const {
+            return slots.size();
+        }
+
+    private:
+        struct Slot {
+            double time;
+            long modelId;
+            uint32_t length;      // Packed bytes of the whole record, only meaningful in its first slot
+            LogRecordKind kind;
+            char bytes[SLOT_BYTES];
+        };
+
+        std::ostream& out;
+        Formatter formatter;
+        LogOverflowPolicy policy;
+        std::vector<Slot> slots;
+        size_t mask = 0;
+
+        // Producer and consumer positions on separate cache lines, both only ever grow
+        alignas(64) std::atomic<size_t> headIndex{0};
+        alignas(64) std::atomic<size_t> tailIndex{0};
+        alignas(64) std::atomic<uint64_t> droppedRecords{0};
+        std::atomic<bool> stopping{false};
+        std::thread writer;
+
+        void run() {
+            std::string block;
+            block.reserve(FLUSH_BYTES + SLOT_BYTES);
+            std::string packed;
+            LogRecord record;
+
+            while (true) {
+                // Read the stop flag first so records queued before stop() are still drained
+                bool finishing = stopping.load(std::memory_order_acquire);
+                size_t tail = tailIndex.load(std::memory_order_relaxed);
+                size_t head = headIndex.load(std::memory_order_acquire);
+
+                if (tail == head) {
+                    if (!block.empty()) {
+                        out.write(block.data(), block.size());
+                        block.clear();
+                    }
+                    if (finishing) {
+                        break;
+                    }
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    continue;
+                }
+
+                while (tail != head) {
+                    const Slot& first = slots[tail & mask];
+                    size_t needed = std::max<size_t>(1, (first.length + SLOT_BYTES - 1) / SLOT_BYTES);
+                    packed.clear();
+                    for (size_t i = 0; i < needed; i++) {
+                        size_t chunk = std::min<size_t>(SLOT_BYTES, first.length - packed.size());
+                        packed.append(slots[(tail + i) & mask].bytes, chunk);
+                    }
+                    record.kind = first.kind;
+                    record.time = first.time;
+                    record.modelId = first.modelId;
+                    unpack(packed, record);
+
+                    tail += needed;
+                    tailIndex.store(tail, std::memory_order_release);
+
+                    formatter(record, block);
+                    if (block.size() >= FLUSH_BYTES) {
+                        out.write(block.data(), block.size());
+                        block.clear();
+                    }
+                }
+            }
+            out.flush();
+        }
+
+        static void unpack(const std::string& packed, LogRecord& record) {
+            size_t offset = 0;
+            auto field = [&](std::string& target) {
+                uint16_t size = 0;
+                if (offset + 2 <= packed.size()) {
+                    std::memcpy(&size, packed.data() + offset, 2);
+                    offset += 2;
+                }
+                size = static_cast<uint16_t>(std::min<size_t>(size, packed.size() - offset));
+                target.assign(packed, offset, size);
+                offset += size;
+            };
+            field(record.modelName);
+            field(record.portName);
+            record.payload.assign(packed, std::min(offset, packed.size()), std::string::npos);
+        }
+};
+
+#endif
@@ -0,0 +1,391 @@
+#ifndef BINARY_TRACE_HPP
+#define BINARY_TRACE_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include "async_log_writer.hpp"
+
+// Binary simulation trace.
+//
+// File header: "RTRC", u8 version, f64 time resolution in seconds (little endian).
+// Then a sequence of records, each starting with a u8 tag:
+//   STRING  varint length, bytes       defines the next string id (model and port names)
+//   MODEL   varint model id, varint name id
+//   START / STOP                       no body
+//   TIME    zigzag varint tick delta
+//   OUTPUT  zigzag varint tick delta, varint model id, varint port id, payload
+//   STATE   zigzag varint tick delta, varint model id, payload
+// A model's name is given once by a MODEL record ahead of its first OUTPUT or STATE.
+// Times are integer ticks of the resolution, each delta is taken against the previous timed
+// record. A payload starts with a u8 encoding relative to the previous payload of the same
+// (kind, model, port) stream:
+//   FULL    varint length, bytes
+//   SAME    identical to the previous one
+//   DELTA   varint shared prefix, varint shared suffix, varint length, middle bytes
+//   TOKENS  varint changed count, then per changed token: varint index gap, varint length,
+//           bytes. Tokens end after a space, both payloads have the same token count.
+namespace BinaryTrace {
+
+const char MAGIC[4] = {'R', 'T', 'R', 'C'};
+const uint8_t VERSION = 1;
+const size_t HEADER_BYTES = 4 + 1 + 8;
+
+enum Tag : uint8_t { STRING = 1, START = 2, STOP = 3, TIME = 4, OUTPUT = 5, STATE = 6, MODEL = 7 };
+enum PayloadEncoding : uint8_t { FULL = 0, SAME = 1, DELTA = 2, TOKENS = 3 };
+
+inline void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+inline void putZigzag(std::string& out, int64_t value) {
+    putVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+inline std::string header(double resolution) {
+    std::string out(MAGIC, sizeof(MAGIC));
+    out += static_cast<char>(VERSION);
+    char bytes[8];
+    std::memcpy(bytes, &resolution, sizeof(bytes));
+    out.append(bytes, sizeof(bytes));
+    return out;
+}
+
+// Split a payload into tokens that each end after a space (the last one may not)
+inline void tokenize(const std::string& payload, std::vector<std::pair<size_t, size_t>>& tokens) {
+    tokens.clear();
+    size_t start = 0;
+    while (start < payload.size()) {
+        size_t end = payload.find(' ', start);
+        end = (end == std::string::npos) ? payload.size() : end + 1;
+        tokens.emplace_back(start, end - start);
+        start = end;
+    }
+}
+
+// Stream a payload is delta-encoded against
+using StreamKey = std::tuple<uint8_t, long, uint64_t>;
+
+// Turns LogRecords into trace bytes. Keeps the string table and the last payload of every
+// stream, so one encoder must see the records in order (the AsyncLogWriter thread).
+class Encoder {
+    public:
+        explicit Encoder(double _resolution = 1e-9) : resolution(_resolution) {}
+
+        void encode(const LogRecord& record, std::string& out) {
+            switch (record.kind) {
+                case LogRecordKind::START:
+                    out += static_cast<char>(START);
+                    break;
+                case LogRecordKind::STOP:
+                    out += static_cast<char>(STOP);
+                    break;
+                case LogRecordKind::TIME:
+                    out += static_cast<char>(TIME);
+                    putTime(out, record.time);
+                    break;
+                case LogRecordKind::OUTPUT:
+                case LogRecordKind::STATE: {
+                    bool output = record.kind == LogRecordKind::OUTPUT;
+                    // Definitions go first so the reader knows them when it reaches the ids
+                    uint64_t nameId = intern(record.modelName, out);
+                    auto model = modelNames.find(record.modelId);
+                    if (model == modelNames.end() || model -> second != nameId) {
+                        modelNames[record.modelId] = nameId;
+                        out += static_cast<char>(MODEL);
+                        putVarint(out, static_cast<uint64_t>(record.modelId));
+                        putVarint(out, nameId);
+                    }
+                    uint64_t portId = output ? intern(record.portName, out) : 0;
+                    out += static_cast<char>(output ? OUTPUT : STATE);
+                    putTime(out, record.time);
+                    putVarint(out, static_cast<uint64_t>(record.modelId));
+                    if (output) {
+                        putVarint(out, portId);
+                    }
+                    putPayload(out, lastPayloads[StreamKey{static_cast<uint8_t>(record.kind), record.modelId, portId}], record.payload);
+                    break;
+                }
+                case LogRecordKind::DIAGNOSTIC:
+                    // Not part of the trace format
+                    break;
+            }
+        }
+
+    private:
+        double resolution;
+        int64_t lastTicks = 0;
+        std::unordered_map<std::string, uint64_t> strings;
+        std::unordered_map<long, uint64_t> modelNames;
+        std::map<StreamKey, std::string> lastPayloads;
+
+        uint64_t intern(const std::string& value, std::string& out) {
+            auto it = strings.find(value);
+            if (it != strings.end()) {
+                return it -> second;
+            }
+            uint64_t id = strings.size();
+            strings.emplace(value, id);
+            out += static_cast<char>(STRING);
+            putVarint(out, value.size());
+            out += value;
+            return id;
+        }
+
+        void putTime(std::string& out, double time) {
+            int64_t ticks = std::isfinite(time) ? std::llround(time / resolution) : lastTicks;
+            putZigzag(out, ticks - lastTicks);
+            lastTicks = ticks;
+        }
+
+        std::vector<std::pair<size_t, size_t>> previousTokens;
+        std::vector<std::pair<size_t, size_t>> payloadTokens;
+        std::string tokenDelta;
+
+        void putPayload(std::string& out, std::string& previous, const std::string& payload) {
+            if (payload == previous) {
+                out += static_cast<char>(SAME);
+                return;
+            }
+
+            // Model states keep their layout and change a few fields, replace only those
+            tokenize(previous, previousTokens);
+            tokenize(payload, payloadTokens);
+            if (!payloadTokens.empty() && previousTokens.size() == payloadTokens.size()) {
+                tokenDelta.clear();
+                size_t changed = 0;
+                size_t lastIndex = 0;
+                for (size_t i = 0; i < payloadTokens.size(); i++) {
+                    const auto& [oldStart, oldLength] = previousTokens[i];
+                    const auto& [newStart, newLength] = payloadTokens[i];
+                    if (oldLength == newLength && previous.compare(oldStart, oldLength, payload, newStart, newLength) == 0) {
+                        continue;
+                    }
+                    putVarint(tokenDelta, i - lastIndex);
+                    putVarint(tokenDelta, newLength);
+                    tokenDelta.append(payload, newStart, newLength);
+                    lastIndex = i;
+                    changed++;
+                }
+                if (tokenDelta.size() < payload.size() / 2) {
+                    out += static_cast<char>(TOKENS);
+                    putVarint(out, changed);
+                    out += tokenDelta;
+                    previous = payload;
+                    return;
+                }
+            }
+
+            size_t limit = std::min(previous.size(), payload.size());
+            size_t prefix = 0;
+            while (prefix < limit && previous[prefix] == payload[prefix]) {
+                prefix++;
+            }
+            size_t suffix = 0;
+            while (suffix < limit - prefix && previous[previous.size() - 1 - suffix] == payload[payload.size() - 1 - suffix]) {
+                suffix++;
+            }
+            // Only worth it when a good part of the payload is shared
+            if (prefix + suffix > 8) {
+                out += static_cast<char>(DELTA);
+                putVarint(out, prefix);
+                putVarint(out, suffix);
+                putVarint(out, payload.size() - prefix - suffix);
+                out.append(payload, prefix, payload.size() - prefix - suffix);
+            } else {
+                out += static_cast<char>(FULL);
+                putVarint(out, payload.size());
+                out += payload;
+            }
+            previous = payload;
+        }
+};
+
+// Walks a trace held in memory (typically mmapped) and rebuilds every record. Names and
+// payloads are rebuilt for every record since payload deltas need the full history.
+class Decoder {
+    public:
+        Decoder(const char* _data, size_t _size) : data(_data), size(_size) {
+            if (size < HEADER_BYTES || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) {
+                throw std::runtime_error("not a binary simulation trace");
+            }
+            if (static_cast<uint8_t>(data[4]) != VERSION) {
+                throw std::runtime_error("unsupported trace version");
+            }
+            std::memcpy(&resolution, data + 5, sizeof(resolution));
+            offset = HEADER_BYTES;
+        }
+
+        double getResolution() const {
+            return resolution;
+        }
+
+        // Decode the next record, returns false at the end of the trace
+        bool next(LogRecord& record) {
+            while (offset < size) {
+                uint8_t tag = static_cast<uint8_t>(data[offset++]);
+                switch (tag) {
+                    case STRING:
+                        strings.emplace_back(bytes(varint()));
+                        continue;
+                    case MODEL: {
+                        long modelId = static_cast<long>(varint());
+                        modelNames[modelId] = lookup(varint());
+                        continue;
+                    }
+                    case START:
+                    case STOP:
+                        record.kind = (tag == START) ? LogRecordKind::START : LogRecordKind::STOP;
+                        record.time = ticks * resolution;
+                        record.modelId = -1;
+                        record.modelName.clear();
+                        record.portName.clear();
+                        record.payload.clear();
+                        return true;
+                    case TIME:
+                        record.kind = LogRecordKind::TIME;
+                        readTime(record);
+                        record.modelId = -1;
+                        record.modelName.clear();
+                        record.portName.clear();
+                        record.payload.clear();
+                        return true;
+                    case OUTPUT:
+                    case STATE: {
+                        record.kind = (tag == OUTPUT) ? LogRecordKind::OUTPUT : LogRecordKind::STATE;
+                        readTime(record);
+                        record.modelId = static_cast<long>(varint());
+                        auto model = modelNames.find(record.modelId);
+                        if (model == modelNames.end()) {
+                            throw std::runtime_error("corrupt trace: undefined model id");
+                        }
+                        record.modelName = model -> second;
+                        uint64_t portId = 0;
+                        record.portName.clear();
+                        if (tag == OUTPUT) {
+                            portId = varint();
+                            record.portName = lookup(portId);
+                        }
+                        std::string& previous = lastPayloads[StreamKey{static_cast<uint8_t>(record.kind), record.modelId, portId}];
+                        readPayload(previous);
+                        record.payload = previous;
+                        return true;
+                    }
+                    default:
+                        throw std::runtime_error("corrupt trace: unknown record tag");
+                }
+            }
+            return false;
+        }
+
+    private:
+        const char* data;
+        size_t size;
+        size_t offset = 0;
+        double resolution = 1e-9;
+        int64_t ticks = 0;
+        std::vector<std::string> strings;
+        std::unordered_map<long, std::string> modelNames;
+        std::map<StreamKey, std::string> lastPayloads;
+        std::vector<std::pair<size_t, size_t>> tokens;
+
+        uint64_t varint() {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                if (offset >= size) {
+                    throw std::runtime_error("corrupt trace: truncated varint");
+                }
+                uint8_t current = static_cast<uint8_t>(data[offset++]);
+                value |= static_cast<uint64_t>(current & 0x7f) << shift;
+                if (!(current & 0x80)) {
+                    return value;
+                }
+            }
+            throw std::runtime_error("corrupt trace: varint too long");
+        }
+
+        std::string bytes(uint64_t length) {
+            if (length > size - offset) {
+                throw std::runtime_error("corrupt trace: truncated record");
+            }
+            std::string value(data + offset, length);
+            offset += length;
+            return value;
+        }
+
+        const std::string& lookup(uint64_t id) const {
+            if (id >= strings.size()) {
+                throw std::runtime_error("corrupt trace: undefined string id");
+            }
+            return strings[id];
+        }
+
+        void readTime(LogRecord& record) {
+            uint64_t zigzag = varint();
+            ticks += static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+            record.time = ticks * resolution;
+        }
+
+        void readPayload(std::string& previous) {
+            if (offset >= size) {
+                throw std::runtime_error("corrupt trace: truncated payload");
+            }
+            uint8_t encoding = static_cast<uint8_t>(data[offset++]);
+            if (encoding == SAME) {
+                return;
+            }
+            if (encoding == FULL) {
+                previous = bytes(varint());
+                return;
+            }
+            if (encoding == TOKENS) {
+                tokenize(previous, tokens);
+                uint64_t changed = varint();
+                std::string rebuilt;
+                size_t index = 0;
+                size_t copied = 0;
+                for (uint64_t i = 0; i < changed; i++) {
+                    index += varint();
+                    if (index >= tokens.size() || (i > 0 && index < copied)) {
+                        throw std::runtime_error("corrupt trace: token delta out of range");
+                    }
+                    // Unchanged tokens up to this one, then the replacement
+                    for (; copied < index; copied++) {
+                        rebuilt.append(previous, tokens[copied].first, tokens[copied].second);
+                    }
+                    rebuilt += bytes(varint());
+                    copied = index + 1;
+                }
+                for (; copied < tokens.size(); copied++) {
+                    rebuilt.append(previous, tokens[copied].first, tokens[copied].second);
+                }
+                previous = std::move(rebuilt);
+                return;
+            }
+            if (encoding != DELTA) {
+                throw std::runtime_error("corrupt trace: unknown payload encoding");
+            }
+            uint64_t prefix = varint();
+            uint64_t suffix = varint();
+            std::string middle = bytes(varint());
+            if (prefix + suffix > previous.size()) {
+                throw std::runtime_error("corrupt trace: payload delta out of range");
+            }
+            previous = previous.substr(0, prefix) + middle + previous.substr(previous.size() - suffix);
+        }
+};
+
+}  // namespace BinaryTrace
+
+#endif
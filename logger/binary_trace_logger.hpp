@@ -0,0 +1,111 @@
+#ifndef BINARY_TRACE_LOGGER_HPP
+#define BINARY_TRACE_LOGGER_HPP
+
+#include <cadmium/core/logger/logger.hpp>
+#include <fstream>
+#include <iostream>
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <sstream>
+#include "async_log_writer.hpp"
+#include "binary_trace.hpp"
+
+// Writes the simulation as a compact binary trace (see binary_trace.hpp), read back with
+// tools/trace_reader. Encoding happens on the AsyncLogWriter thread.
+class BinaryTraceLogger : public cadmium::Logger {
+private:
+    std::ofstream traceFile;
+    BinaryTrace::Encoder encoder;
+    std::unique_ptr<AsyncLogWriter> writer;
+    bool stopped = false;
+
+    std::string generateTimestampedFilename() {
+        auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        std::tm* now_tm = std::localtime(&now);
+
+        std::stringstream ss;
+        ss << "simulation_trace_"
+           << (now_tm->tm_year + 1900) << "-"
+           << (now_tm->tm_mon + 1) << "-"
+           << now_tm->tm_mday << "_"
+           << now_tm->tm_hour << "-"
+           << now_tm->tm_min << "-"
+           << now_tm->tm_sec << ".bin";
+
+        return ss.str();
+    }
+
+    void finish() {
+        if (!writer || stopped) {
+            return;
+        }
+        writer -> stop();
+        stopped = true;
+        if (writer -> dropped() > 0) {
+            std::cerr << "Binary trace dropped " << writer -> dropped() << " records" << std::endl;
+        }
+        traceFile.flush();
+    }
+
+    void push(LogRecordKind kind, double time, long modelId, const std::string& modelName,
+              const std::string& portName, const std::string& payload) {
+        if (writer) {
+            writer -> push(kind, time, modelId, modelName, portName, payload);
+        }
+    }
+
+public:
+
+    // resolution is the smallest simulation time step kept in the trace, in seconds
+    BinaryTraceLogger(const std::string& path = "", double resolution = 1e-9,
+                      LogOverflowPolicy policy = LogOverflowPolicy::BLOCK, size_t capacity = 1 << 14)
+        : encoder(resolution) {
+        std::string filename = path.empty() ? "logs/" + generateTimestampedFilename() : path;
+        traceFile.open(filename, std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!traceFile) {
+            std::cerr << "Error opening trace file!" << std::endl;
+            return;
+        }
+        std::string header = BinaryTrace::header(resolution);
+        traceFile.write(header.data(), header.size());
+        writer = std::make_unique<AsyncLogWriter>(traceFile,
+            [this](const LogRecord& record, std::string& block) { encoder.encode(record, block); }, policy, capacity);
+    }
+
+    ~BinaryTraceLogger() {
+        finish();
+        if (traceFile.is_open()) {
+            traceFile.close();
+        }
+    }
+
+    void start() override {
+        push(LogRecordKind::START, 0, -1, "", "", "");
+    }
+
+    void stop() override {
+        push(LogRecordKind::STOP, 0, -1, "", "", "");
+        finish();
+    }
+
+    void logTime(double time) override {
+        push(LogRecordKind::TIME, time, -1, "", "", "");
+    }
+
+    void logOutput(double time, long modelId, const std::string& modelName,
+                   const std::string& portName, const std::string& output) override {
+        push(LogRecordKind::OUTPUT, time, modelId, modelName, portName, output);
+    }
+
+    void logState(double time, long modelId, const std::string& modelName,
+                  const std::string& state) override {
+        push(LogRecordKind::STATE, time, modelId, modelName, "", state);
+    }
+
+    uint64_t droppedRecords() const {
+        return writer ? writer -> dropped() : 0;
+    }
+};
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef CHROME_TRACE_LOGGER_HPP
+#define CHROME_TRACE_LOGGER_HPP
+
+#include <cadmium/core/logger/logger.hpp>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include "../utils/tracing/message_tracer.hpp"
+
+// Traces every Raft message through its hops and writes the run as Chrome trace-event JSON at
+// the end, to open in chrome://tracing or ui.perfetto.dev. While it exists its tracer is the
+// active one. Other records go on to the inner logger, if any.
+//
+//   root.setLogger(std::make_shared<ChromeTraceLogger>(std::make_shared<RAFTLogger>()));
+class ChromeTraceLogger : public cadmium::Logger {
+private:
+    std::shared_ptr<cadmium::Logger> inner;
+    MessageTracer tracer;
+    std::string path;
+    bool finished = false;
+
+    std::string generateTimestampedFilename() {
+        auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        std::tm* now_tm = std::localtime(&now);
+
+        std::stringstream ss;
+        ss << "message_trace_"
+           << (now_tm->tm_year + 1900) << "-"  // Year
+           << (now_tm->tm_mon + 1) << "-"     // Month
+           << now_tm->tm_mday << "_"
+           << now_tm->tm_hour << "-"          // Hour
+           << now_tm->tm_min << "-"           // Minute
+           << now_tm->tm_sec << ".json";      // Second
+
+        return ss.str();
+    }
+
+    void finish() {
+        if (finished) {
+            return;
+        }
+        finished = true;
+        std::ofstream traceFile(path, std::ios::out | std::ios::trunc);
+        if (!traceFile) {
+            std::cerr << "Error opening trace file!" << std::endl;
+            return;
+        }
+        tracer.writeChromeTrace(traceFile);
+    }
+
+public:
+    // inner may be null
+    explicit ChromeTraceLogger(std::shared_ptr<cadmium::Logger> _inner = nullptr, const std::string& _path = "")
+        : inner(std::move(_inner)), path(_path.empty() ? "logs/" + generateTimestampedFilename() : _path) {
+        MessageTracer::Activate(&tracer);
+    }
+
+    ~ChromeTraceLogger() {
+        // cadmium does not call stop() unless the root coordinator is stopped explicitly
+        finish();
+        if (MessageTracer::Active() == &tracer) {
+            MessageTracer::Activate(nullptr);
+        }
+    }
+
+    void start() override {
+        if (inner) {
+            inner -> start();
+        }
+    }
+
+    void stop() override {
+        if (inner) {
+            inner -> stop();
+        }
+        finish();
+    }
+
+    void logTime(double time) override {
+        if (inner) {
+            inner -> logTime(time);
+        }
+    }
+
+    void logOutput(double time, long modelId, const std::string& modelName,
+                   const std::string& portName, const std::string& output) override {
+        if (inner) {
+            inner -> logOutput(time, modelId, modelName, portName, output);
+        }
+    }
+
+    void logState(double time, long modelId, const std::string& modelName,
+                  const std::string& state) override {
+        if (inner) {
+            inner -> logState(time, modelId, modelName, state);
+        }
+    }
+
+    const MessageTracer& getTracer() const {
+        return tracer;
+    }
+};
+
+#endif
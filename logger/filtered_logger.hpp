@@ -0,0 +1,79 @@
+#ifndef FILTERED_LOGGER_HPP
+#define FILTERED_LOGGER_HPP
+
+#include <cadmium/core/logger/logger.hpp>
+#include <memory>
+#include "../utils/logging/log_filter.hpp"
+
+// Passes on only the records selected by a LogFilter to another logger (RAFTLogger,
+// BinaryTraceLogger, ...). While it exists its filter is the active one, so models skip
+// formatting states that would be dropped.
+//
+//   LogFilterConfig config;
+//   config.models = {"node1/raft-controller"};
+//   config.windows = {{5.0, 10.0}};
+//   root.setLogger(std::make_shared<FilteredLogger>(std::make_shared<RAFTLogger>(), config));
+class FilteredLogger : public cadmium::Logger {
+private:
+    std::shared_ptr<cadmium::Logger> inner;
+    LogFilter filter;
+    uint64_t passed = 0;
+    uint64_t filtered = 0;
+
+public:
+    FilteredLogger(std::shared_ptr<cadmium::Logger> _inner, LogFilterConfig config)
+        : inner(std::move(_inner)), filter(std::move(config)) {
+        LogFilter::Activate(&filter);
+    }
+
+    ~FilteredLogger() {
+        if (LogFilter::Active() == &filter) {
+            LogFilter::Activate(nullptr);
+        }
+    }
+
+    void start() override {
+        inner -> start();
+    }
+
+    void stop() override {
+        inner -> stop();
+    }
+
+    void logTime(double time) override {
+        filter.setTime(time);
+        if (filter.inWindow()) {
+            inner -> logTime(time);
+        }
+    }
+
+    void logOutput(double time, long modelId, const std::string& modelName,
+                   const std::string& portName, const std::string& output) override {
+        if (filter.admitOutput(modelId, modelName, portName)) {
+            passed++;
+            inner -> logOutput(time, modelId, modelName, portName, output);
+        } else {
+            filtered++;
+        }
+    }
+
+    void logState(double time, long modelId, const std::string& modelName,
+                  const std::string& state) override {
+        if (filter.takeStateDecision(modelId, modelName)) {
+            passed++;
+            inner -> logState(time, modelId, modelName, state);
+        } else {
+            filtered++;
+        }
+    }
+
+    uint64_t passedRecords() const {
+        return passed;
+    }
+
+    uint64_t filteredRecords() const {
+        return filtered;
+    }
+};
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef METRICS_LOGGER_HPP
+#define METRICS_LOGGER_HPP
+
+#include <cadmium/core/logger/logger.hpp>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include "../utils/metrics/metrics.hpp"
+
+// Exports a MetricsRegistry as CSV snapshots (see MetricsRegistry::writeSnapshot) every interval
+// of simulation time and once more at the end of the run. While it exists its registry is the
+// active one, so the models record into it. Other records go on to the inner logger, if any.
+//
+//   auto registry = std::make_shared<MetricsRegistry>();
+//   root.setLogger(std::make_shared<MetricsLogger>(std::make_shared<RAFTLogger>(), registry, 0.1));
+class MetricsLogger : public cadmium::Logger {
+private:
+    std::shared_ptr<cadmium::Logger> inner;
+    std::shared_ptr<MetricsRegistry> registry;
+    std::ofstream metricsFile;
+    double interval;
+    double nextSnapshot;
+    double lastTime = 0;
+    bool finished = false;
+
+    std::string generateTimestampedFilename() {
+        auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        std::tm* now_tm = std::localtime(&now);
+
+        std::stringstream ss;
+        ss << "metrics_"
+           << (now_tm->tm_year + 1900) << "-"  // Year
+           << (now_tm->tm_mon + 1) << "-"     // Month
+           << now_tm->tm_mday << "_"
+           << now_tm->tm_hour << "-"          // Hour
+           << now_tm->tm_min << "-"           // Minute
+           << now_tm->tm_sec << ".csv";       // Second
+
+        return ss.str();
+    }
+
+    // End-of-run snapshot, at the last simulation time seen
+    void finish() {
+        if (finished) {
+            return;
+        }
+        finished = true;
+        if (metricsFile) {
+            registry -> writeSnapshot(metricsFile, lastTime);
+            metricsFile.flush();
+        }
+    }
+
+public:
+    // interval <= 0 writes only the end-of-run snapshot. inner may be null.
+    MetricsLogger(std::shared_ptr<cadmium::Logger> _inner, std::shared_ptr<MetricsRegistry> _registry,
+                  double _interval = 0, const std::string& path = "")
+        : inner(std::move(_inner)), registry(std::move(_registry)), interval(_interval), nextSnapshot(_interval) {
+        std::string filename = path.empty() ? "logs/" + generateTimestampedFilename() : path;
+        metricsFile.open(filename, std::ios::out | std::ios::trunc);
+        if (!metricsFile) {
+            std::cerr << "Error opening metrics file!" << std::endl;
+        } else {
+            MetricsRegistry::WriteSnapshotHeader(metricsFile);
+        }
+        MetricsRegistry::Activate(registry.get());
+    }
+
+    ~MetricsLogger() {
+        // cadmium does not call stop() unless the root coordinator is stopped explicitly
+        finish();
+        if (MetricsRegistry::Active() == registry.get()) {
+            MetricsRegistry::Activate(nullptr);
+        }
+    }
+
+    void start() override {
+        if (inner) {
+            inner -> start();
+        }
+    }
+
+    void stop() override {
+        if (inner) {
+            inner -> stop();
+        }
+        finish();
+    }
+
+    // Called before the transitions at time, so a snapshot taken here holds the metrics up
+    // to the interval boundary. Boundaries crossed without events share one snapshot.
+    void logTime(double time) override {
+        if (interval > 0 && time >= nextSnapshot && metricsFile) {
+            double boundary = nextSnapshot + std::floor((time - nextSnapshot) / interval) * interval;
+            registry -> writeSnapshot(metricsFile, boundary);
+            nextSnapshot = boundary + interval;
+        }
+        lastTime = time;
+        if (inner) {
+            inner -> logTime(time);
+        }
+    }
+
+    void logOutput(double time, long modelId, const std::string& modelName,
+                   const std::string& portName, const std::string& output) override {
+        if (inner) {
+            inner -> logOutput(time, modelId, modelName, portName, output);
+        }
+    }
+
+    void logState(double time, long modelId, const std::string& modelName,
+                  const std::string& state) override {
+        if (inner) {
+            inner -> logState(time, modelId, modelName, state);
+        }
+    }
+
+    const MetricsRegistry& getRegistry() const {
+        return *registry;
+    }
+};
+
+#endif
@@ -3,15 +3,21 @@
 #include <iostream>
 #include <chrono>
 #include <ctime>
+#include <cstdio>
+#include <memory>
 #include <sstream>
+#include "async_log_writer.hpp"
+#include "../utils/logging/diagnostics.hpp"
 
-class RAFTLogger : public cadmium::Logger {
+class RAFTLogger : public cadmium::Logger, public DiagnosticSink {
 private:
     std::ofstream logFile;
+    std::unique_ptr<AsyncLogWriter> writer;
+    bool stopped = false;
 
     std::string generateTimestampedFilename() {
         auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-        std::tm* now_tm = std::localtime(&now); 
+        std::tm* now_tm = std::localtime(&now);
 
         std::stringstream ss;
         ss << "simulation_log_"
@@ -25,48 +31,140 @@ private:
         return ss.str();
     }
 
+    // Same text as the stream operator would give for a double
+    static void appendTime(std::string& out, double time) {
+        char buffer[32];
+        int length = std::snprintf(buffer, sizeof(buffer), "%g", time);
+        out.append(buffer, length);
+    }
+
+    // Runs on the writer thread
+    static void formatRecord(const LogRecord& record, std::string& out) {
+        switch (record.kind) {
+            case LogRecordKind::START:
+                out += "RAFT Simulation Started.\n";
+                break;
+            case LogRecordKind::STOP:
+                out += "RAFT Simulation Ended.\n";
+                break;
+            case LogRecordKind::TIME:
+                out += "Simulation Time: ";
+                appendTime(out, record.time);
+                out += '\n';
+                break;
+            case LogRecordKind::OUTPUT:
+                out += '[';
+                appendTime(out, record.time);
+                out += "]  | Output size: ";
+                out += std::to_string(record.payload.size());
+                out += " | Ouput: ";
+                out += record.payload;
+                out += '\n';
+                break;
+            case LogRecordKind::STATE:
+                out += '[';
+                appendTime(out, record.time);
+                out += "] ";
+                out += record.modelName;
+                out += " | Current State: ";
+                out += record.payload;
+                out += '\n';
+                break;
+            case LogRecordKind::DIAGNOSTIC:
+                out += '[';
+                appendTime(out, record.time);
+                out += "] ";
+                out += record.portName;
+                out += " Node #";
+                out += record.modelName;
+                out += " | ";
+                out += record.payload;
+                out += '\n';
+                break;
+        }
+    }
+
+    // Drain the ring and note any losses at the end of the file
+    void finish() {
+        if (!writer || stopped) {
+            return;
+        }
+        writer -> stop();
+        stopped = true;
+        if (writer -> dropped() > 0) {
+            logFile << "Dropped log records: " << writer -> dropped() << "\n";
+        }
+        logFile.flush();
+    }
+
+    void push(LogRecordKind kind, double time, long modelId, const std::string& modelName,
+              const std::string& portName, const std::string& payload) {
+        if (writer) {
+            writer -> push(kind, time, modelId, modelName, portName, payload);
+        }
+    }
+
 public:
 
-    RAFTLogger() {
-        std::string filename = generateTimestampedFilename();  
-        logFile.open("logs/" + filename, std::ios::out | std::ios::trunc);  
+    // Log lines are written by a background thread. With DROP the simulation never waits
+    // for the disk, records that do not fit in the ring are counted instead. The logger also
+    // becomes the sink for model diagnostics (RAFT_DIAG) until it is destroyed.
+    RAFTLogger(LogOverflowPolicy policy = LogOverflowPolicy::BLOCK, size_t capacity = 1 << 14, const std::string& path = "") {
+        std::string filename = path.empty() ? "logs/" + generateTimestampedFilename() : path;
+        logFile.open(filename, std::ios::out | std::ios::trunc);
         if (!logFile) {
             std::cerr << "Error opening log file!" << std::endl;
+            return;
         }
+        writer = std::make_unique<AsyncLogWriter>(logFile, formatRecord, policy, capacity);
+        Diagnostics::SetSink(this);
     }
 
 
     ~RAFTLogger() {
+        if (Diagnostics::Sink() == this) {
+            Diagnostics::SetSink(nullptr);
+        }
+        // cadmium does not call stop() unless the root coordinator is stopped explicitly
+        finish();
         if (logFile.is_open()) {
             logFile.close();
         }
     }
 
     void start() override {
-        logFile << "RAFT Simulation Started." << std::endl;
+        push(LogRecordKind::START, 0, -1, "", "", "");
     }
 
     void stop() override {
-        logFile << "RAFT Simulation Ended." << std::endl;
+        push(LogRecordKind::STOP, 0, -1, "", "", "");
+        finish();
     }
 
     void logTime(double time) override {
-        logFile << "Simulation Time: " << time << std::endl;
+        push(LogRecordKind::TIME, time, -1, "", "", "");
     }
 
-    void logOutput(double time, long modelId, const std::string& modelName, 
+    void logOutput(double time, long modelId, const std::string& modelName,
                    const std::string& portName, const std::string& output) override {
-        logFile << "[" << time << "] "
-                << " | Output size: " << output.size()  // Assuming output is a log entry
-                << " | Ouput: " << output 
-                << std::endl;
+        push(LogRecordKind::OUTPUT, time, modelId, modelName, portName, output);
     }
 
-    void logState(double time, long modelId, const std::string& modelName, 
+    void logState(double time, long modelId, const std::string& modelName,
                   const std::string& state) override {
-        logFile << "[" << time << "] "
-                << modelName
-                << " | Current State: " << state 
-                << std::endl;
+        push(LogRecordKind::STATE, time, modelId, modelName, "", state);
     }
+
+    // The level name travels in the port field
+    void logDiagnostic(DiagLevel level, double time, const std::string& source, const std::string& message) override {
+        if (!stopped) {
+            push(LogRecordKind::DIAGNOSTIC, time, -1, source, Diagnostics::LevelName(level), message);
+        }
+    }
+
+    // Records lost to a full ring under LogOverflowPolicy::DROP
+    uint64_t droppedRecords() const {
+        return writer ? writer -> dropped() : 0;
+    }
+
 };
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include "../binary_trace_logger.hpp"
+
+
+class BinaryTraceFixture: public ::testing::Test
+{
+protected:
+    std::vector<LogRecord> records;
+
+    void SetUp() override
+    {
+        std::string key(1600, 'k');
+        records = {
+            {LogRecordKind::START, 0, -1, "", "", ""},
+            {LogRecordKind::TIME, 0.15, -1, "", "", ""},
+            {LogRecordKind::STATE, 0.15, 3, "raft-controller", "", "term 1 | time 0.15 | key " + key},
+            {LogRecordKind::OUTPUT, 0.15, 3, "raft-controller", "out", "vote request"},
+            {LogRecordKind::STATE, 0.15, 4, "buffer", "", "empty"},
+            {LogRecordKind::TIME, 0.3000001, -1, "", "", ""},
+            // Same stream as above with a small change, then an identical repeat
+            {LogRecordKind::STATE, 0.3000001, 3, "raft-controller", "", "term 2 | time 0.3 | key " + key},
+            {LogRecordKind::STATE, 0.3000001, 3, "raft-controller", "", "term 2 | time 0.3 | key " + key},
+            {LogRecordKind::OUTPUT, 0.3000001, 3, "raft-controller", "out", "vote request"},
+            {LogRecordKind::OUTPUT, 0.3000001, 3, "raft-controller", "heartbeat", ""},
+            // Different token counts fall back to prefix/suffix deltas
+            {LogRecordKind::STATE, 0.4, 4, "buffer", "", "queue: " + key},
+            {LogRecordKind::STATE, 0.5, 4, "buffer", "", "queue: a " + key},
+            {LogRecordKind::STOP, 0, -1, "", "", ""},
+        };
+    }
+
+    std::string encode() {
+        BinaryTrace::Encoder encoder;
+        std::string trace = BinaryTrace::header(1e-9);
+        for (const auto& record : records) {
+            encoder.encode(record, trace);
+        }
+        return trace;
+    }
+};
+
+
+TEST_F(BinaryTraceFixture, TestRoundTrip) {
+    std::string trace = encode();
+    BinaryTrace::Decoder decoder(trace.data(), trace.size());
+
+    LogRecord record;
+    for (const auto& expected : records) {
+        ASSERT_TRUE(decoder.next(record));
+        EXPECT_EQ(record.kind, expected.kind);
+        EXPECT_EQ(record.modelName, expected.modelName);
+        EXPECT_EQ(record.portName, expected.portName);
+        EXPECT_EQ(record.payload, expected.payload);
+        if (expected.kind != LogRecordKind::START && expected.kind != LogRecordKind::STOP) {
+            EXPECT_NEAR(record.time, expected.time, 1e-9);
+            EXPECT_EQ(record.modelId, expected.modelId);
+        }
+    }
+    EXPECT_FALSE(decoder.next(record));
+}
+
+TEST_F(BinaryTraceFixture, TestRepeatedStateIsDeltaEncoded) {
+    std::string trace = encode();
+    // The 1600 byte key is stored once per stream
+    EXPECT_LT(trace.size(), 3400);
+}
+
+TEST_F(BinaryTraceFixture, TestCorruptTraceThrows) {
+    std::string trace = encode();
+    EXPECT_THROW(BinaryTrace::Decoder("text log", 8), std::runtime_error);
+
+    std::string truncated = trace.substr(0, trace.size() / 2);
+    BinaryTrace::Decoder decoder(truncated.data(), truncated.size());
+    LogRecord record;
+    EXPECT_THROW({ while (decoder.next(record)) {} }, std::runtime_error);
+}
+
+TEST_F(BinaryTraceFixture, TestDiagnosticsAreLeftOut) {
+    std::string trace = encode();
+    records.insert(records.begin() + 3, {LogRecordKind::DIAGNOSTIC, 0.15, -1, "node0", "WARN", "Invalid RAFT entry detected."});
+    EXPECT_EQ(encode(), trace);
+
+    BinaryTrace::Decoder decoder(trace.data(), trace.size());
+    LogRecord record;
+    while (decoder.next(record)) {
+        EXPECT_NE(record.kind, LogRecordKind::DIAGNOSTIC);
+    }
+}
+
+TEST_F(BinaryTraceFixture, TestLoggerWritesReadableTrace) {
+    std::string path = "logs/binary_trace_test.bin";
+    {
+        BinaryTraceLogger logger(path);
+        for (const auto& record : records) {
+            switch (record.kind) {
+                case LogRecordKind::START: logger.start(); break;
+                case LogRecordKind::STOP: logger.stop(); break;
+                case LogRecordKind::TIME: logger.logTime(record.time); break;
+                case LogRecordKind::OUTPUT: logger.logOutput(record.time, record.modelId, record.modelName, record.portName, record.payload); break;
+                case LogRecordKind::STATE: logger.logState(record.time, record.modelId, record.modelName, record.payload); break;
+                // Diagnostics go to the RAFTLogger text log, the binary trace has no record for them
+                case LogRecordKind::DIAGNOSTIC: break;
+            }
+        }
+    }
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    EXPECT_EQ(contents.str(), encode());
+    std::remove(path.c_str());
+}
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include "../chrome_trace_logger.hpp"
+#include "../../models/coupled/simulation.hpp"
+#include <cadmium/core/simulation/root_coordinator.hpp>
+
+
+TEST(ChromeTraceTest, TestBroadcastGetsOneFlowPerDestination) {
+    MessageTracer tracer;
+    MessageTracer::Activate(&tracer);
+    uint64_t id = MessageTracer::NextTraceId();
+    MessageTracer::Activate(nullptr);
+    EXPECT_EQ(MessageTracer::NextTraceId(), 0);
+
+    tracer.instant(id, "node0", "raft-controller", "send APPEND_ENTRIES", 0.1);
+    tracer.span(id, "node0", "message-processor", "APPEND_ENTRIES", 0.1, 0.2);
+    tracer.span(id, "network", "node1", "packet", 0.2, 0.3, "node1");
+    tracer.span(id, "network", "node2", "packet", 0.2, 0.4, "node2");
+    tracer.instant(id, "node1", "raft-controller", "receive APPEND_ENTRIES", 0.35, "node1");
+    // Untraced messages are ignored
+    tracer.span(0, "node0", "message-processor", "APPEND_ENTRIES", 0.1, 0.2);
+    EXPECT_EQ(tracer.getEvents().size(), 5);
+
+    std::ostringstream out;
+    tracer.writeChromeTrace(out);
+    std::string json = out.str();
+    EXPECT_EQ(json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["), 0);
+    EXPECT_NE(json.find("\"ph\":\"X\",\"ts\":100000,\"dur\":100000"), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"args\":{\"name\":\"network\"}"), std::string::npos);
+    // node1's chain: send, processor, network, receive. node2's chain ends at the network
+    auto count = [&](const std::string& text) {
+        size_t n = 0;
+        for (size_t at = json.find(text); at != std::string::npos; at = json.find(text, at + 1)) {
+            n++;
+        }
+        return n;
+    };
+    EXPECT_EQ(count("\"ph\":\"s\""), 2);
+    EXPECT_EQ(count("\"ph\":\"t\""), 3);
+    EXPECT_EQ(count("\"ph\":\"f\""), 2);
+}
+
+TEST(ChromeTraceTest, TestSimulationTracesEveryHop) {
+    std::string path = "logs/chrome_trace_test.json";
+    std::shared_ptr<ChromeTraceLogger> logger = std::make_shared<ChromeTraceLogger>(nullptr, path);
+    {
+        auto model = std::make_shared<SimulationModel>("simulation");
+        RootCoordinator root(model);
+        root.setLogger(logger);
+        root.simulate(0.3);
+    }
+
+    // Hops of every copy of a message after the network, in the order they were recorded
+    std::map<std::pair<uint64_t, std::string>, std::vector<const TraceEvent*>> journeys;
+    for (const auto& event : logger -> getTracer().getEvents()) {
+        if (!event.branch.empty()) {
+            journeys[{event.traceId, event.branch}].push_back(&event);
+        }
+    }
+    size_t delivered = 0;
+    for (const auto& [key, events] : journeys) {
+        auto receive = std::find_if(events.begin(), events.end(), [](const TraceEvent* event) { return event -> instant; });
+        if (receive == events.end()) {
+            continue;
+        }
+        delivered++;
+        EXPECT_EQ((*receive) -> node, key.second);
+        EXPECT_EQ((*receive) -> name.rfind("receive", 0), 0);
+
+        // The hops before the controller, back to back up to the receive
+        std::vector<std::string> hops;
+        const TraceEvent* previous = nullptr;
+        for (const TraceEvent* event : events) {
+            if (event -> instant) {
+                continue;
+            }
+            hops.push_back(event -> node == "network" ? "network" : event -> model);
+            EXPECT_LE(event -> begin, event -> end);
+            if (previous) {
+                EXPECT_NEAR(previous -> end, event -> begin, 1e-12);
+            }
+            previous = event;
+        }
+        std::vector<std::string> expected = {"network", "packet-processor", "buffer"};
+        EXPECT_EQ(hops, expected);
+        ASSERT_NE(previous, nullptr);
+        EXPECT_NEAR(previous -> end, (*receive) -> begin, 1e-9);
+    }
+    EXPECT_GT(delivered, 0);
+
+    logger.reset();
+    std::ifstream in(path);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    EXPECT_NE(contents.str().find("\"name\":\"thread_name\""), std::string::npos);
+    std::remove(path.c_str());
+}
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
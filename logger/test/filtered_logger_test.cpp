@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include "../filtered_logger.hpp"
+#include "../../models/atomic/raft_controller.hpp"
+#include "../../models/atomic/buffer.hpp"
+
+
+// Keeps what reaches it as "<kind> <model>[:<port>] @<time>" lines
+class CapturingLogger : public cadmium::Logger {
+public:
+    std::vector<std::string> records;
+
+    void start() override {}
+    void stop() override {}
+    void logTime(double time) override {
+        records.push_back("time @" + std::to_string(time));
+    }
+    void logOutput(double time, long, const std::string& modelName, const std::string& portName, const std::string&) override {
+        records.push_back("output " + modelName + ":" + portName + " @" + std::to_string(time));
+    }
+    void logState(double time, long, const std::string& modelName, const std::string&) override {
+        records.push_back("state " + modelName + " @" + std::to_string(time));
+    }
+};
+
+
+class FilteredLoggerFixture: public ::testing::Test
+{
+protected:
+    std::shared_ptr<CapturingLogger> capture = std::make_shared<CapturingLogger>();
+};
+
+
+TEST(LogFilterTest, TestGlobMatch) {
+    EXPECT_TRUE(LogFilter::GlobMatch("raft-*", "raft-controller"));
+    EXPECT_TRUE(LogFilter::GlobMatch("*controller", "heartbeat-controller"));
+    EXPECT_TRUE(LogFilter::GlobMatch("node?/raft-controller", "node1/raft-controller"));
+    EXPECT_TRUE(LogFilter::GlobMatch("*", ""));
+    EXPECT_FALSE(LogFilter::GlobMatch("node?/raft-controller", "node10/raft-controller"));
+    EXPECT_FALSE(LogFilter::GlobMatch("raft-*", "buffer"));
+}
+
+TEST_F(FilteredLoggerFixture, TestModelPortAndWindowRules) {
+    LogFilterConfig config;
+    config.models = {"raft-*", "network"};
+    config.ports = {"output_external"};
+    config.windows = {{1.0, 2.0}};
+    FilteredLogger logger(capture, config);
+
+    for (double time : {0.5, 1.5, 2.5}) {
+        logger.logTime(time);
+        logger.logState(time, 1, "raft-controller", "s");
+        logger.logState(time, 2, "buffer", "s");
+        logger.logOutput(time, 1, "raft-controller", "output_external", "o");
+        logger.logOutput(time, 1, "raft-controller", "output_heartbeat", "o");
+    }
+    std::vector<std::string> expected = {"time @1.500000", "state raft-controller @1.500000", "output raft-controller:output_external @1.500000"};
+    EXPECT_EQ(capture -> records, expected);
+    EXPECT_EQ(logger.passedRecords(), 2);
+    EXPECT_EQ(logger.filteredRecords(), 10);
+}
+
+TEST_F(FilteredLoggerFixture, TestSamplingKeepsOneInN) {
+    LogFilterConfig config;
+    config.sampleEvery = 4;
+    config.outputs = false;
+    FilteredLogger logger(capture, config);
+
+    for (int i = 0; i < 20; i++) {
+        logger.logState(i, 1, "raft-controller", "s");
+        logger.logState(i, 2, "buffer", "s");
+    }
+    // Counted per model: 5 of each
+    EXPECT_EQ(capture -> records.size(), 10);
+}
+
+TEST_F(FilteredLoggerFixture, TestModelHookSkipsFormattingAndSelectsNode) {
+    RaftControllerModel node0("raft-controller");
+    RaftControllerModel node1("raft-controller");
+    node0.setNodeID("node0");
+    node1.setNodeID("node1");
+
+    LogFilterConfig config;
+    config.models = {"node1/*"};
+    FilteredLogger logger(capture, config);
+
+    // As the root coordinator does: the model formats its state, then the logger gets it
+    std::string state0 = node0.logState();
+    logger.logState(0.1, 10, node0.getId(), state0);
+    std::string state1 = node1.logState();
+    logger.logState(0.1, 11, node1.getId(), state1);
+
+    EXPECT_EQ(state0, "");
+    EXPECT_NE(state1.find("RaftState {"), std::string::npos);
+    ASSERT_EQ(capture -> records.size(), 1);
+
+    // Outputs of node1's controller are matched by the node learned from its state
+    logger.logOutput(0.1, 10, "raft-controller", "output_external", "o");
+    logger.logOutput(0.1, 11, "raft-controller", "output_external", "o");
+    EXPECT_EQ(capture -> records.back(), "output raft-controller:output_external @0.100000");
+    EXPECT_EQ(capture -> records.size(), 2);
+}
+
+TEST_F(FilteredLoggerFixture, TestNodeGlobSelectsOneNodesBuffer) {
+    // Every node's buffer has the same bare name, only the node tells them apart
+    Buffer<RaftMessage> node0("buffer");
+    Buffer<RaftMessage> node1("buffer");
+    node0.setNodeID("node0");
+    node1.setNodeID("node1");
+
+    LogFilterConfig config;
+    config.models = {"node1/buffer"};
+    FilteredLogger logger(capture, config);
+
+    std::string state0 = node0.logState();
+    logger.logState(0.1, 20, node0.getId(), state0);
+    std::string state1 = node1.logState();
+    logger.logState(0.1, 21, node1.getId(), state1);
+
+    EXPECT_EQ(state0, "");
+    EXPECT_NE(state1.find("BufferState"), std::string::npos);
+    ASSERT_EQ(capture -> records.size(), 1);
+    EXPECT_EQ(capture -> records.back(), "state buffer @0.100000");
+}
+
+TEST_F(FilteredLoggerFixture, TestNoActiveFilterAfterDestruction) {
+    {
+        FilteredLogger logger(capture, LogFilterConfig{});
+        EXPECT_NE(LogFilter::Active(), nullptr);
+    }
+    EXPECT_EQ(LogFilter::Active(), nullptr);
+    EXPECT_TRUE(LogFilter::WantsState(this, "raft-controller"));
+}
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
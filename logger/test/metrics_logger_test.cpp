@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include "../metrics_logger.hpp"
+#include "../../models/coupled/simulation.hpp"
+#include <cadmium/core/simulation/root_coordinator.hpp>
+
+
+// Lines of a metrics CSV whose metric column is name
+static std::vector<std::string> RowsFor(const std::string& path, const std::string& name) {
+    std::ifstream in(path);
+    std::vector<std::string> rows;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.find("," + name + ",") != std::string::npos) {
+            rows.push_back(line);
+        }
+    }
+    return rows;
+}
+
+
+TEST(MetricsTest, TestHistogramPercentilesStayWithinBucketPrecision) {
+    Histogram histogram(1e-6);
+    for (int i = 1; i <= 10000; i++) {
+        histogram.record(i * 1e-6);
+    }
+    EXPECT_EQ(histogram.count(), 10000);
+    EXPECT_DOUBLE_EQ(histogram.min(), 1e-6);
+    EXPECT_DOUBLE_EQ(histogram.max(), 10000e-6);
+    EXPECT_NEAR(histogram.mean(), 5000.5e-6, 1e-9);
+    // 6 significant bits, every bucket is within 1/32 of its values
+    for (double q : {0.5, 0.9, 0.99}) {
+        EXPECT_NEAR(histogram.percentile(q), q * 10000e-6, q * 10000e-6 / 32);
+    }
+    // Small values are exact
+    Histogram exact(1);
+    exact.record(3);
+    exact.record(5);
+    EXPECT_DOUBLE_EQ(exact.percentile(0.5), 3);
+    EXPECT_DOUBLE_EQ(exact.percentile(1), 5);
+}
+
+TEST(MetricsTest, TestRegistrySnapshotRows) {
+    MetricsRegistry registry;
+    registry.counter("node0/raft-controller", "elections_started").add(2);
+    Gauge& depth = registry.gauge("node0/buffer", "depth");
+    depth.set(4);
+    depth.set(1);
+    EXPECT_EQ(&registry.gauge("node0/buffer", "depth"), &depth);
+    EXPECT_EQ(registry.findCounter("node0/buffer/missing"), nullptr);
+
+    std::ostringstream out;
+    registry.writeSnapshot(out, 0.5);
+    EXPECT_EQ(out.str(), "0.5,node0/raft-controller/elections_started,counter,2,,,,,,\n"
+                         "0.5,node0/buffer/depth,gauge,1,,,,,,4\n");
+}
+
+TEST(MetricsTest, TestLoggerWritesIntervalAndFinalSnapshots) {
+    std::string path = "logs/metrics_logger_test.csv";
+    auto registry = std::make_shared<MetricsRegistry>();
+    {
+        MetricsLogger logger(nullptr, registry, 0.1, path);
+        EXPECT_EQ(MetricsRegistry::Active(), registry.get());
+        Counter& events = registry -> counter("network", "delivered");
+        for (double time : {0.05, 0.12, 0.35, 0.38}) {
+            logger.logTime(time);
+            events.add();
+        }
+    }
+    EXPECT_EQ(MetricsRegistry::Active(), nullptr);
+
+    // Boundaries 0.1 and 0.3 (0.2 passed without events), then the end of the run
+    std::vector<std::string> expected = {"0.1,network/delivered,counter,1,,,,,,",
+                                         "0.3,network/delivered,counter,2,,,,,,",
+                                         "0.38,network/delivered,counter,4,,,,,,"};
+    EXPECT_EQ(RowsFor(path, "network/delivered"), expected);
+    std::remove(path.c_str());
+}
+
+TEST(MetricsTest, TestSimulationRecordsPerNodeMetrics) {
+    std::string path = "logs/metrics_simulation_test.csv";
+    auto registry = std::make_shared<MetricsRegistry>();
+    {
+        auto model = std::make_shared<SimulationModel>("simulation");
+        RootCoordinator root(model);
+        root.setLogger(std::make_shared<MetricsLogger>(nullptr, registry, 0.1, path));
+        root.simulate(0.3);
+    }
+
+    uint64_t electionsWon = 0;
+    uint64_t entriesAppended = 0;
+    uint64_t queued = 0;
+    for (const std::string nodeID : {"node0", "node1", "node2"}) {
+        electionsWon += registry -> findCounter(nodeID + "/raft-controller/elections_won") -> value();
+        entriesAppended += registry -> findCounter(nodeID + "/raft-controller/entries_appended") -> value();
+        queued += registry -> findHistogram(nodeID + "/packet-processor/queue_wait") -> count();
+        ASSERT_NE(registry -> findGauge(nodeID + "/buffer/depth"), nullptr);
+    }
+    EXPECT_GE(electionsWon, 1);
+    EXPECT_GT(entriesAppended, 0);
+    EXPECT_GT(queued, 0);
+    EXPECT_GT(registry -> findCounter("network/delivered") -> value(), 0);
+    EXPECT_EQ(registry -> findCounter("network/dropped") -> value(), 0);
+    EXPECT_FALSE(RowsFor(path, "network/delivered").empty());
+    std::remove(path.c_str());
+}
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
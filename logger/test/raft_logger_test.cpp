@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include "../raft_logger.hpp"
+
+
+class AsyncLogWriterFixture: public ::testing::Test
+{
+protected:
+    std::ostringstream out;
+
+    // One line per record: kind, model, port and payload size, then the payload itself
+    static void formatRecord(const LogRecord& record, std::string& block) {
+        block += std::to_string(static_cast<int>(record.kind)) + " " + record.modelName + " " + record.portName
+               + " " + std::to_string(record.payload.size()) + " " + record.payload + "\n";
+    }
+};
+
+
+TEST_F(AsyncLogWriterFixture, TestRecordsSpanningSlotsKeepOrder) {
+    std::string expected;
+    {
+        // Small ring so the producer has to wait for the writer thread
+        AsyncLogWriter writer(out, formatRecord, LogOverflowPolicy::BLOCK, 8);
+        for (int i = 0; i < 1000; i++) {
+            std::string payload(i % 700, static_cast<char>('a' + i % 26));
+            ASSERT_TRUE(writer.push(LogRecordKind::OUTPUT, i * 0.5, i, "node" + std::to_string(i % 3), "out", payload));
+            formatRecord({LogRecordKind::OUTPUT, i * 0.5, i, "node" + std::to_string(i % 3), "out", payload}, expected);
+        }
+        writer.stop();
+        EXPECT_EQ(writer.dropped(), 0);
+    }
+    EXPECT_EQ(out.str(), expected);
+}
+
+TEST_F(AsyncLogWriterFixture, TestDropPolicyCountsLostRecords) {
+    std::atomic<bool> entered{false};
+    std::atomic<bool> release{false};
+    // The writer stalls inside the first record until released
+    auto stallingFormatter = [&](const LogRecord& record, std::string& block) {
+        entered = true;
+        while (!release) {
+            std::this_thread::yield();
+        }
+        formatRecord(record, block);
+    };
+
+    AsyncLogWriter writer(out, stallingFormatter, LogOverflowPolicy::DROP, 4);
+    ASSERT_TRUE(writer.push(LogRecordKind::STATE, 0, 0, "node0", "", "first"));
+    while (!entered) {
+        std::this_thread::yield();
+    }
+
+    // Four slots are free again, everything after them is dropped
+    int accepted = 0;
+    for (int i = 0; i < 10; i++) {
+        accepted += writer.push(LogRecordKind::STATE, 1, 0, "node0", "", "x");
+    }
+    EXPECT_EQ(accepted, 4);
+    EXPECT_EQ(writer.dropped(), 6);
+
+    release = true;
+    writer.stop();
+    std::string written = out.str();
+    EXPECT_EQ(std::count(written.begin(), written.end(), '\n'), 5);
+}
+
+TEST(RAFTLoggerTest, TestLoggerWritesTextFormat) {
+    std::string path = "logs/raft_logger_test.txt";
+    {
+        RAFTLogger logger(LogOverflowPolicy::BLOCK, 16, path);
+        logger.start();
+        logger.logTime(0.15);
+        logger.logOutput(0.15, 1, "node0", "out", "msg");
+        logger.logState(0.15, 1, "node0", "state");
+        logger.stop();
+    }
+    std::ifstream in(path);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    EXPECT_EQ(contents.str(), "RAFT Simulation Started.\n"
+                              "Simulation Time: 0.15\n"
+                              "[0.15]  | Output size: 3 | Ouput: msg\n"
+                              "[0.15] node0 | Current State: state\n"
+                              "RAFT Simulation Ended.\n");
+    std::remove(path.c_str());
+}
+
+TEST(RAFTLoggerTest, TestDiagnosticsAreLeveledAndRoutedToTheLogger) {
+    std::string path = "logs/raft_logger_diagnostics_test.txt";
+    int evaluated = 0;
+    auto count = [&]() { return ++evaluated; };
+    {
+        RAFTLogger logger(LogOverflowPolicy::BLOCK, 16, path);
+        EXPECT_EQ(Diagnostics::Sink(), &logger);
+
+        Diagnostics::SetLevel(DiagLevel::WARN);
+        RAFT_DIAG(DiagLevel::DEBUG, 0.1, "node0", "debug " << count());
+        RAFT_DIAG(DiagLevel::WARN, 0.2, "node0", "warn " << count());
+        // Below RAFT_DIAG_COMPILED_LEVEL, so stripped even when enabled at runtime
+        Diagnostics::SetLevel(DiagLevel::TRACE);
+        RAFT_DIAG(DiagLevel::TRACE, 0.3, "node1", "trace " << count());
+        RAFT_DIAG(DiagLevel::DEBUG, 0.4, "node1", "debug " << count());
+        Diagnostics::SetLevel(DiagLevel::INFO);
+    }
+    EXPECT_EQ(Diagnostics::Sink(), nullptr);
+    EXPECT_EQ(evaluated, 2);
+
+    std::ifstream in(path);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    EXPECT_EQ(contents.str(), "[0.2] WARN Node #node0 | warn 1\n"
+                              "[0.4] DEBUG Node #node1 | debug 2\n");
+    std::remove(path.c_str());
+}
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -3,6 +3,7 @@
 
 #include "../messages.hpp"
 #include <string>
+#include <optional>
 
 enum class DatabaseTask {INSERT, QUERY};
 
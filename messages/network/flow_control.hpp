@@ -0,0 +1,14 @@
+#ifndef FLOW_CONTROL_HPP
+#define FLOW_CONTROL_HPP
+
+#include <ostream>
+
+// Backpressure signal from a bounded buffer to the model feeding it
+enum class FlowControl { STOP, RESUME };
+
+inline std::ostream& operator<<(std::ostream& os, FlowControl signal) {
+    os << (signal == FlowControl::STOP ? "STOP" : "RESUME");
+    return os;
+}
+
+#endif
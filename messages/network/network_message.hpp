@@ -2,6 +2,7 @@
 #define NETWORK_MESSAGES_HPP
 
 #include "../messages.hpp"
+#include <cstdint>
 #include <string>
 
 class Packet {
@@ -12,7 +13,8 @@ class Packet {
         std::shared_ptr<IMessage<PacketPayloadType>> payload;
         std::string destination; 
         std::string source;
-        double timestamp;
+        double timestamp = 0;  // Simulation time the packet entered the network
+        uint64_t traceId = 0;  // Trace id of the carried message, 0 when untraced
 
         friend std::ostream& operator<<(std::ostream& os, const Packet& msg) {
             os << "Packet";
@@ -21,27 +23,5 @@ class Packet {
 };
 
 
-struct PacketEvent {
-    public:
-        PacketEvent(std::shared_ptr<Packet> _packet, double _delay, double _dispatchTime) : packet(std::move(_packet)), delay(_delay),
-        dispatchTime(_dispatchTime) {}
-        std::shared_ptr<Packet> packet;
-        double delay;
-        double dispatchTime;
-
-        // Min check
-        bool operator<(const PacketEvent& b) const {
-            return (this->dispatchTime + this->delay) > (b.dispatchTime + b.delay); 
-        }
-
-};
-
-struct ComparePacketEvent {
-    bool operator()(const std::shared_ptr<PacketEvent>& a, const std::shared_ptr<PacketEvent>& b) const {
-        return *a < *b;  // Dereference shared_ptr to compare PacketEvent objects
-    }
-};
-
-
 
 #endif
\ No newline at end of file
@@ -3,6 +3,10 @@
 
 #include "../messages.hpp"
 #include "../util/heartbeat_messages.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
 
 enum class HeartbeatStatus {ALIVE, TIMEOUT, UPDATE, INIT};
 
@@ -11,9 +15,39 @@ std::ostream& operator<<(std::ostream& os, HeartbeatStatus status) {
     return os;
 }
 
+// What the Raft controller tells its heartbeat controller: restart the election countdown (ALIVE)
+// or run the leader's heartbeat loop (UPDATE), with the timeouts the node currently derives. Seconds.
+struct HeartbeatUpdate {
+    HeartbeatStatus status = HeartbeatStatus::ALIVE;
+    double heartbeatInterval = 0;
+    double electionTimeoutMin = 0;  // Lower end of the election window
+};
+
+std::ostream& operator<<(std::ostream& os, const HeartbeatUpdate& update) {
+    os << update.status << " heartbeat " << update.heartbeatInterval << " election " << update.electionTimeoutMin;
+    return os;
+}
 
 
-enum class Task {VOTE_REQUEST, APPEND_ENTRIES, VOTE_RESPONSE};
+
+enum class Task {VOTE_REQUEST, APPEND_ENTRIES, VOTE_RESPONSE, APPEND_ENTRIES_RESPONSE, CLIENT_REQUEST, CLIENT_RESPONSE,
+                 READ_INDEX_REQUEST, READ_INDEX_RESPONSE, PRE_VOTE_REQUEST, PRE_VOTE_RESPONSE};
+
+inline std::string taskToString(Task task) {
+    switch (task) {
+        case Task::VOTE_REQUEST: return "VOTE_REQUEST";
+        case Task::APPEND_ENTRIES: return "APPEND_ENTRIES";
+        case Task::VOTE_RESPONSE: return "VOTE_RESPONSE";
+        case Task::APPEND_ENTRIES_RESPONSE: return "APPEND_ENTRIES_RESPONSE";
+        case Task::CLIENT_REQUEST: return "CLIENT_REQUEST";
+        case Task::CLIENT_RESPONSE: return "CLIENT_RESPONSE";
+        case Task::READ_INDEX_REQUEST: return "READ_INDEX_REQUEST";
+        case Task::READ_INDEX_RESPONSE: return "READ_INDEX_RESPONSE";
+        case Task::PRE_VOTE_REQUEST: return "PRE_VOTE_REQUEST";
+        case Task::PRE_VOTE_RESPONSE: return "PRE_VOTE_RESPONSE";
+        default: return "UNKNOWN";
+    }
+}
 
 class RaftMessage : public IMessage<PacketPayloadType> {
     public:
@@ -22,6 +56,15 @@ class RaftMessage : public IMessage<PacketPayloadType> {
         std::shared_ptr<IMessage<Task>> content;
         std::string source = "";
         std::string dest = "";
+        std::unordered_map<std::string, std::string> macVector; // HMAC tag per recipient (HMAC channel mode)
+        uint64_t traceId = 0;  // Ties the hops of this message together in a MessageTracer, 0 when untraced
+
+        // An AppendEntries from the leader's heartbeat loop: it carries heartbeat entries and nothing else
+        bool isHeartbeat() const;
+
+        // Scheduling class in a prioritized Buffer: 0 votes and pre-votes, 1 heartbeats (see isHeartbeat()),
+        // 2 replication and read-confirmation rounds, 3 client traffic
+        size_t priorityClass() const;
 
         PacketPayloadType getType() override {
             return PacketPayloadType::RAFT;
@@ -125,9 +168,61 @@ class ResponseVote : public IMessage<Task> {
 
 enum class LogEntryType {RAFT, HEARTBEAT, EXTERNAL};
 
+// Compact proof of an election win. Each cluster member owns one bit in voterBitmap
+// (its position in the sorted membership list) and the granted votes' signatures are
+// stored in bitmap order, so the certificate grows by one bit + one signature per voter.
+struct QuorumCertificate {
+    int termNumber = 0;
+    std::string candidateID;
+    std::vector<uint64_t> voterBitmap;
+    std::vector<std::string> signatures;
+
+    bool hasVoter(size_t index) const {
+        size_t word = index / 64;
+        return word < voterBitmap.size() && ((voterBitmap[word] >> (index % 64)) & 1ULL);
+    }
+
+    // Voters must be added in ascending index order to keep signatures in bitmap order
+    void addVoter(size_t index, const std::string& signature) {
+        size_t word = index / 64;
+        if (word >= voterBitmap.size()) {
+            voterBitmap.resize(word + 1, 0);
+        }
+        voterBitmap[word] |= (1ULL << (index % 64));
+        signatures.push_back(signature);
+    }
+
+    int voteCount() const {
+        int count = 0;
+        for (uint64_t word : voterBitmap) {
+            count += __builtin_popcountll(word);
+        }
+        return count;
+    }
+
+    std::string toString() const {
+        std::stringstream ss;
+        ss << "QuorumCertificate { "
+           << "termNumber: " << termNumber << ", "
+           << "candidateID: \"" << candidateID << "\", "
+           << "voterBitmap: [" << std::hex;
+        for (size_t i = 0; i < voterBitmap.size(); ++i) {
+            ss << "0x" << voterBitmap[i];
+            if (i < voterBitmap.size() - 1) ss << ", ";
+        }
+        ss << std::dec << "], signatures: [";
+        for (size_t i = 0; i < signatures.size(); ++i) {
+            ss << "\"" << signatures[i] << "\"";
+            if (i < signatures.size() - 1) ss << ", ";
+        }
+        ss << "] }";
+        return ss.str();
+    }
+};
+
 struct logEntryMetadata {
     RequestVote requestMessage;
-    std::vector<ResponseVote> messageList;
+    QuorumCertificate certificate;
 };
 
 class LogEntryRAFT : public IMessage<LogEntryType> {
@@ -143,11 +238,8 @@ public:
         std::stringstream ss;
         ss << "LogEntryRAFT { "
            << "requestMessage: {" << metadata.requestMessage.toString() << "}, "
-           << "messageList: [";
-        for (const auto& msg : metadata.messageList) {
-            ss << msg.toString() << ", ";
-        }
-        ss << "] }";
+           << "certificate: {" << metadata.certificate.toString() << "}"
+           << " }";
         return ss.str();
     }
 };
@@ -172,16 +264,46 @@ class LogEntryHeartbeat : public IMessage<LogEntryType> {
         }
 };
 
+enum class ClientOperation { WRITE, READ };
+
+// A client's command, replicated as a log entry unless it is a read served without the log
+struct ClientCommand {
+    std::string clientID;
+    uint64_t requestID = 0;
+    std::string key;
+    std::string value;  // Empty for reads
+    ClientOperation operation = ClientOperation::WRITE;
+
+    std::string toString() const {
+        std::stringstream ss;
+        ss << "ClientCommand { "
+           << "clientID: \"" << clientID << "\", "
+           << "requestID: " << requestID << ", "
+           << "key: \"" << key << "\", "
+           << "value: " << value.size() << " bytes, "
+           << "operation: " << (operation == ClientOperation::READ ? "READ" : "WRITE")
+           << " }";
+        return ss.str();
+    }
+};
+
 class LogEntryExternal : public IMessage<LogEntryType>  { 
     public:
         LogEntryExternal() = default;
+        LogEntryExternal(ClientCommand _command) : command(std::move(_command)) {};
+
+        ClientCommand command;
 
         LogEntryType getType() override {
             return LogEntryType::EXTERNAL;
         }
 
+        // The value is part of the entry, it is hashed and persisted with it
         std::string toString() const override {
-            return "LogEntryExternal { }";
+            if (command.clientID.empty()) {
+                return "LogEntryExternal { }";
+            }
+            return "LogEntryExternal { " + command.toString() + ", value: \"" + command.value + "\" }";
         }
 };
 
@@ -192,6 +314,11 @@ struct AppendEntriesMetadata {
     int prevLogTerm;   // Term of the log entry at PrevLogIndex
     std::vector<std::shared_ptr<IMessage<LogEntryType>>> entries; // List of log entries to be replicated (empty for heartbeat)
     int leaderCommit;  // The index of the highest log entry known to be committed
+    std::string prevLogDigest; // Chain digest of the leader's log up to PrevLogIndex (empty for an empty prefix)
+    uint64_t round = 0;  // Leader's broadcast sequence number, echoed back to confirm its leadership for reads
+    double sentAt = 0;  // Leader's send time, echoed back as a round-trip sample
+    double rtt = 0;  // Leader's smoothed round-trip time, 0 before its first sample
+    double rttVar = 0;  // Its mean deviation
 
     std::string toString() const {
         std::stringstream ss;
@@ -207,7 +334,14 @@ struct AppendEntriesMetadata {
             if (i < entries.size() - 1) ss << ", ";
         }
 
-        ss << "], " << "leaderCommit: " << leaderCommit << " }";
+        ss << "], " << "leaderCommit: " << leaderCommit << ", "
+           << "prevLogDigest: \"";
+        // Digest is raw bytes, print it as hex
+        static const char* hexDigits = "0123456789abcdef";
+        for (unsigned char c : prevLogDigest) {
+            ss << hexDigits[c >> 4] << hexDigits[c & 0x0F];
+        }
+        ss << "\", round: " << round << ", sentAt: " << sentAt << ", rtt: " << rtt << ", rttVar: " << rttVar << " }";
         return ss.str();
     }
 };
@@ -233,4 +367,288 @@ class AppendEntries : public IMessage<Task> {
         }
 };
 
+struct AppendEntriesResponseMetadata {
+    int term;
+    std::string nodeId;
+    bool success;
+    int matchIndex;  // Last index known to match the leader's log, on failure the index to retry from
+    int appended;  // Entries this request added to the follower's log
+    uint64_t round = 0;  // The request's round if the sender follows its leader, 0 otherwise
+    double sentAt = 0;  // The request's send time
+
+    std::string toString() const {
+        std::stringstream ss;
+        ss << "AppendEntriesResponseMetadata { "
+           << "term: " << term << ", "
+           << "nodeId: \"" << nodeId << "\", "
+           << "success: " << (success ? "true" : "false") << ", "
+           << "matchIndex: " << matchIndex << ", "
+           << "appended: " << appended << ", "
+           << "round: " << round << ", "
+           << "sentAt: " << sentAt
+           << " }";
+        return ss.str();
+    }
+};
+
+class AppendEntriesResponse : public IMessage<Task> {
+    public:
+        AppendEntriesResponse() = default;
+        AppendEntriesResponse(AppendEntriesResponseMetadata _metadata, std::string_view _msgDigestSigned) : metadata(_metadata), msgDigestSigned(_msgDigestSigned) {};
+        AppendEntriesResponseMetadata metadata;
+        std::string msgDigestSigned;
+
+        Task getType() override {
+            return Task::APPEND_ENTRIES_RESPONSE;
+        }
+
+        std::string toString() const override {
+            std::stringstream ss;
+            ss << "AppendEntriesResponse { "
+               << "metadata: {" << metadata.toString() << "}, "
+               << "msgDigestSigned: \"" << msgDigestSigned << "\""
+               << " }";
+            return ss.str();
+        }
+};
+
+// Clients are not cluster members, their messages are not authenticated
+class ClientRequest : public IMessage<Task> {
+    public:
+        ClientRequest() = default;
+        ClientRequest(ClientCommand _command) : command(std::move(_command)) {};
+        ClientCommand command;
+
+        Task getType() override {
+            return Task::CLIENT_REQUEST;
+        }
+
+        std::string toString() const override {
+            return "ClientRequest { " + command.toString() + " }";
+        }
+};
+
+enum class ClientStatus {OK, REDIRECT};
+
+struct ClientResponseMetadata {
+    uint64_t requestID = 0;
+    ClientStatus status = ClientStatus::OK;
+    std::string leaderHint;  // REDIRECT: the leader as far as the node knows, empty if it does not
+    int logIndex = -1;  // OK: where the command was committed
+    double commitTime = 0;  // OK: when the leader saw the entry committed
+    double applyTime = 0;  // OK: when the leader applied it
+
+    std::string toString() const {
+        std::stringstream ss;
+        ss << "ClientResponseMetadata { "
+           << "requestID: " << requestID << ", "
+           << "status: " << (status == ClientStatus::OK ? "OK" : "REDIRECT") << ", "
+           << "leaderHint: \"" << leaderHint << "\", "
+           << "logIndex: " << logIndex << ", "
+           << "commitTime: " << commitTime << ", "
+           << "applyTime: " << applyTime
+           << " }";
+        return ss.str();
+    }
+};
+
+class ClientResponse : public IMessage<Task> {
+    public:
+        ClientResponse() = default;
+        ClientResponse(ClientResponseMetadata _metadata) : metadata(std::move(_metadata)) {};
+        ClientResponseMetadata metadata;
+
+        Task getType() override {
+            return Task::CLIENT_RESPONSE;
+        }
+
+        std::string toString() const override {
+            return "ClientResponse { metadata: {" + metadata.toString() + "} }";
+        }
+};
+
+// A follower asking the leader for the index its reads must wait for, one request per batch of reads
+struct ReadIndexRequestMetadata {
+    std::string nodeId;
+    uint64_t batch;
+
+    std::string toString() const {
+        std::stringstream ss;
+        ss << "ReadIndexRequestMetadata { "
+           << "nodeId: \"" << nodeId << "\", "
+           << "batch: " << batch
+           << " }";
+        return ss.str();
+    }
+};
+
+class ReadIndexRequest : public IMessage<Task> {
+    public:
+        ReadIndexRequest() = default;
+        ReadIndexRequest(ReadIndexRequestMetadata _metadata, std::string_view _msgDigestSigned) : metadata(_metadata), msgDigestSigned(_msgDigestSigned) {};
+        ReadIndexRequestMetadata metadata;
+        std::string msgDigestSigned;
+
+        Task getType() override {
+            return Task::READ_INDEX_REQUEST;
+        }
+
+        std::string toString() const override {
+            std::stringstream ss;
+            ss << "ReadIndexRequest { "
+               << "metadata: {" << metadata.toString() << "}, "
+               << "msgDigestSigned: \"" << msgDigestSigned << "\""
+               << " }";
+            return ss.str();
+        }
+};
+
+struct ReadIndexResponseMetadata {
+    std::string nodeId;
+    uint64_t batch;
+    bool success;  // False when the node asked no longer leads
+    int readIndex;  // The leader's commit index once its leadership was confirmed
+
+    std::string toString() const {
+        std::stringstream ss;
+        ss << "ReadIndexResponseMetadata { "
+           << "nodeId: \"" << nodeId << "\", "
+           << "batch: " << batch << ", "
+           << "success: " << (success ? "true" : "false") << ", "
+           << "readIndex: " << readIndex
+           << " }";
+        return ss.str();
+    }
+};
+
+class ReadIndexResponse : public IMessage<Task> {
+    public:
+        ReadIndexResponse() = default;
+        ReadIndexResponse(ReadIndexResponseMetadata _metadata, std::string_view _msgDigestSigned) : metadata(_metadata), msgDigestSigned(_msgDigestSigned) {};
+        ReadIndexResponseMetadata metadata;
+        std::string msgDigestSigned;
+
+        Task getType() override {
+            return Task::READ_INDEX_RESPONSE;
+        }
+
+        std::string toString() const override {
+            std::stringstream ss;
+            ss << "ReadIndexResponse { "
+               << "metadata: {" << metadata.toString() << "}, "
+               << "msgDigestSigned: \"" << msgDigestSigned << "\""
+               << " }";
+            return ss.str();
+        }
+};
+
+// Asks whether a node would vote for the sender in `termNumber`, before the sender moves to that term.
+// Its own metadata types keep a pre-vote's signature from passing for a real vote.
+struct PreVoteMetadata {
+    int termNumber;  // The term the sender would start, one past its current term
+    std::string candidateID;
+    int lastLogIndex;
+
+    std::string toString() const {
+        std::stringstream ss;
+        ss << "PreVoteMetadata { "
+           << "termNumber: " << termNumber << ", "
+           << "candidateID: \"" << candidateID << "\", "
+           << "lastLogIndex: " << lastLogIndex
+           << " }";
+        return ss.str();
+    }
+};
+
+class PreVoteRequest : public IMessage<Task> {
+    public:
+        PreVoteRequest() = default;
+        PreVoteRequest(PreVoteMetadata _metadata, std::string_view _msgDigestSigned) : metadata(_metadata), msgDigestSigned(_msgDigestSigned) {};
+        PreVoteMetadata metadata;
+        std::string msgDigestSigned;
+
+        Task getType() override {
+            return Task::PRE_VOTE_REQUEST;
+        }
+
+        std::string toString() const override {
+            std::stringstream ss;
+            ss << "PreVoteRequest { "
+               << "metadata: {" << metadata.toString() << "}, "
+               << "msgDigestSigned: \"" << msgDigestSigned << "\""
+               << " }";
+            return ss.str();
+        }
+};
+
+struct PreVoteResponseMetadata {
+    int termNumber;  // The term asked about
+    std::string candidateID;
+    bool granted;
+    std::string nodeId;
+
+    std::string toString() const {
+        std::stringstream ss;
+        ss << "PreVoteResponseMetadata { "
+           << "termNumber: " << termNumber << ", "
+           << "candidateID: \"" << candidateID << "\", "
+           << "granted: " << (granted ? "true" : "false") << ", "
+           << "nodeId: \"" << nodeId << "\""
+           << " }";
+        return ss.str();
+    }
+};
+
+class PreVoteResponse : public IMessage<Task> {
+    public:
+        PreVoteResponse() = default;
+        PreVoteResponse(PreVoteResponseMetadata _metadata, std::string_view _msgDigestSigned) : metadata(_metadata), msgDigestSigned(_msgDigestSigned) {};
+        PreVoteResponseMetadata metadata;
+        std::string msgDigestSigned;
+
+        Task getType() override {
+            return Task::PRE_VOTE_RESPONSE;
+        }
+
+        std::string toString() const override {
+            std::stringstream ss;
+            ss << "PreVoteResponse { "
+               << "metadata: {" << metadata.toString() << "}, "
+               << "msgDigestSigned: \"" << msgDigestSigned << "\""
+               << " }";
+            return ss.str();
+        }
+};
+
+inline bool RaftMessage::isHeartbeat() const {
+    if (!content || content -> getType() != Task::APPEND_ENTRIES) {
+        return false;
+    }
+    // Empty rounds confirm the leadership for reads, losing one stalls them
+    const auto& entries = std::static_pointer_cast<AppendEntries>(content) -> metadata.entries;
+    return !entries.empty() && std::all_of(entries.begin(), entries.end(), [](const std::shared_ptr<IMessage<LogEntryType>>& entry) {
+        return entry && entry -> getType() == LogEntryType::HEARTBEAT;
+    });
+}
+
+inline size_t RaftMessage::priorityClass() const {
+    if (!content) {
+        return 3;
+    }
+    switch (content -> getType()) {
+        case Task::VOTE_REQUEST:
+        case Task::VOTE_RESPONSE:
+        case Task::PRE_VOTE_REQUEST:
+        case Task::PRE_VOTE_RESPONSE:
+            return 0;
+        case Task::APPEND_ENTRIES:
+            // Empty read-confirmation rounds go with replication, their acknowledgements do too
+            return isHeartbeat() ? 1 : 2;
+        case Task::APPEND_ENTRIES_RESPONSE:
+            return 2;
+        default:
+            return 3;
+    }
+}
+
 #endif
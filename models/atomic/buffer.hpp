@@ -2,29 +2,134 @@
 #define BUFFER_HPP
 
 #include <cadmium/core/modeling/atomic.hpp>
-#include <queue>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include "../../utils/stochastic/random.hpp"
+#include "../../utils/logging/state_delta.hpp"
+#include "../../utils/logging/log_filter.hpp"
+#include "../../utils/metrics/metrics.hpp"
+#include "../../utils/tracing/message_tracer.hpp"
+#include "../../utils/queueing/ring_buffer.hpp"
+#include "../../messages/network/flow_control.hpp"
 
 
 using namespace cadmium;
 
+// Scheduling classes of a Buffer. Unprioritized buffers only use class 0.
+constexpr size_t BUFFER_CLASSES = 4;
+
+// A queued message and when it arrived
+template <typename MessageType>
+struct BufferedMessage {
+    std::shared_ptr<MessageType> message;
+    double arrivalTime = 0;
+    uint64_t sequence = 0;  // Arrival order across all classes
+};
+
 // State struct
 template <typename MessageType>
 struct BufferState {
-    std::queue<std::shared_ptr<MessageType>> buffer;
+    std::array<RingBuffer<BufferedMessage<MessageType>>, BUFFER_CLASSES> queues;  // One FIFO per scheduling class
+    std::array<int64_t, BUFFER_CLASSES> credits{};  // Weighted-fair service credit per class
+    size_t queued = 0;  // Messages across all classes
+    uint64_t arrivals = 0;
     bool busy = false;
+    double currentTime = 0;
+    size_t dropped = 0;  // Messages lost to overflow
+    size_t highWater = 0;  // Most messages ever queued at once
+    bool backpressure = false;  // Upstream has been told to stop sending
+    bool backpressureChanged = false;  // backpressure still has to be sent upstream
+
+    template <typename Writer>
+    void describe(Writer& w) const {
+        w.field("busy", busy);
+        w.field("messages", queued);
+        w.field("dropped", dropped);
+        w.field("highWater", highWater);
+        w.field("backpressure", backpressure);
+    }
 
     // Overload operator<< for BufferState, allows us to log state in a cleaner way
     friend std::ostream& operator<<(std::ostream& os, const BufferState<MessageType>& state) {
-        os << "BufferState: {busy: " << (state.busy ? "true" : "false") << ", messages: [";
-        os << "] }";
+        StateDelta::full(os, "BufferState", state);
         return os;
     }
 
 };
 
+// Metrics recorded by a buffer, scoped "<node>/buffer"
+struct BufferMetrics {
+    Gauge* depth = nullptr;  // Its max is the high-water mark
+    Counter* dropped = nullptr;
+
+    BufferMetrics() = default;
+    BufferMetrics(MetricsRegistry& registry, const std::string& scope)
+        : depth(&registry.gauge(scope, "depth")),
+          dropped(&registry.counter(scope, "dropped")) {}
+};
+
+// Queue depth per scheduling class, "class<i>_depth", recorded only by prioritized buffers
+struct BufferClassMetrics {
+    std::array<Gauge*, BUFFER_CLASSES> depth{};
+
+    BufferClassMetrics() = default;
+    BufferClassMetrics(MetricsRegistry& registry, const std::string& scope) {
+        for (size_t i = 0; i < BUFFER_CLASSES; i++) {
+            depth[i] = &registry.gauge(scope, "class" + std::to_string(i) + "_depth");
+        }
+    }
+};
+
+// What a bounded buffer does with a message that arrives when it is full
+enum class OverflowPolicy {
+    DROP_TAIL,        // Drop the arriving message
+    DROP_OLDEST,      // Drop the message that arrived first
+    DROP_HEARTBEATS,  // Drop a queued heartbeat (the arriving one if it is a heartbeat), else the arriving message
+    BACKPRESSURE      // Tell upstream to stop when full and to resume at half capacity, drop what still arrives
+};
+
+// Which queued message a buffer serves next
+enum class SchedulingPolicy {
+    FIFO,             // Arrival order, ignoring classes
+    STRICT_PRIORITY,  // Lowest class first, FIFO within a class
+    WEIGHTED_FAIR     // Classes share service in proportion to their weights, FIFO within a class
+};
+
+// Whether a message is a heartbeat, false for message types without isHeartbeat()
+template <typename Message, typename = void>
+struct IsHeartbeat {
+    static bool get(const Message&) {
+        return false;
+    }
+};
+
+template <typename Message>
+struct IsHeartbeat<Message, std::void_t<decltype(std::declval<const Message&>().isHeartbeat())>> {
+    static bool get(const Message& message) {
+        return message.isHeartbeat();
+    }
+};
+
+// Scheduling class of a message, 0 for message types without priorityClass()
+template <typename Message, typename = void>
+struct PriorityClassOf {
+    static size_t get(const Message&) {
+        return 0;
+    }
+};
+
+template <typename Message>
+struct PriorityClassOf<Message, std::void_t<decltype(std::declval<const Message&>().priorityClass())>> {
+    static size_t get(const Message& message) {
+        return std::min<size_t>(message.priorityClass(), BUFFER_CLASSES - 1);
+    }
+};
+
 // Add Overload operator for >>, for input stream
 
 template <typename MessageType>
@@ -33,44 +138,241 @@ class Buffer : public Atomic<BufferState<MessageType>> {
 public:
     Port<std::shared_ptr<MessageType>> input_port;
     Port<std::shared_ptr<MessageType>> output_port;
+    Port<FlowControl> output_backpressure;  // Only with OverflowPolicy::BACKPRESSURE
 
 
-    Buffer(const std::string& id) : Atomic<BufferState<MessageType>>(id, {}) {
+    Buffer(const std::string& id) : Atomic<BufferState<MessageType>>(id, {}), metricsScope(id) {
         input_port = cadmium::Component::addInPort<std::shared_ptr<MessageType>>("input_buffer");
         output_port = cadmium::Component::addOutPort<std::shared_ptr<MessageType>>("output_buffer");
+        output_backpressure = cadmium::Component::addOutPort<FlowControl>("output_backpressure");
     }
     
 
     void internalTransition(BufferState<MessageType>& s) const override {
-        if (!s.buffer.empty()) {
-            s.buffer.pop();
+        s.currentTime += getProcessingDelay();
+        s.backpressureChanged = false;
+        // The batch just sent by output
+        for (size_t c : nextBatch(s, &s.credits)) {
+            const BufferedMessage<MessageType>& sent = s.queues[c].front();
+            if (MessageTracer* tracer = MessageTracer::Active()) {
+                tracer -> span(TraceIdOf<MessageType>::get(*sent.message), nodeID, this -> getId(), "message",
+                               sent.arrivalTime, s.currentTime, nodeID);
+            }
+            s.queues[c].pop_front();
+            s.queued--;
         }
-        s.busy = !s.buffer.empty();
+        s.busy = s.queued > 0;
+        updateBackpressure(s);
+        recordDepth(s);
     }
 
     void externalTransition(BufferState<MessageType>& s, double e) const override {
+        s.currentTime += e;
         std::vector<std::shared_ptr<MessageType>> msgs = input_port -> getBag();
         for (auto msg : msgs) {
-            s.buffer.push(msg);
+            enqueue(s, msg);
         }
-        s.busy = true;
+        s.busy = s.queued > 0;
+        updateBackpressure(s);
+        recordDepth(s);
     }
 
     void output(const BufferState<MessageType>& s) const override {
-        if (!s.buffer.empty()) {
-            output_port -> addMessage(s.buffer.front());
+        std::array<size_t, BUFFER_CLASSES> taken{};
+        for (size_t c : nextBatch(s, nullptr)) {
+            output_port -> addMessage(s.queues[c][taken[c]++].message);
+        }
+        if (s.backpressureChanged) {
+            output_backpressure -> addMessage(s.backpressure ? FlowControl::STOP : FlowControl::RESUME);
         }
     }
 
     double timeAdvance(const BufferState<MessageType>& s) const override {
-        return s.busy ? getProcessingDelay() : std::numeric_limits<double>::infinity();
+        return (s.busy || s.backpressureChanged) ? getProcessingDelay() : std::numeric_limits<double>::infinity();
+    }
+
+    // Setter function for the queue bound: at most `capacity` messages (0 = unbounded), `overflow` decides
+    // what gives when it is full. Call before the simulation starts, it empties the queue.
+    void setCapacity(size_t _capacity, OverflowPolicy overflow = OverflowPolicy::DROP_TAIL) {
+        capacity = _capacity;
+        // Every class can take the whole bound, so no ring ever reallocates
+        for (auto& queue : this -> state.queues) {
+            queue = RingBuffer<BufferedMessage<MessageType>>(capacity);
+        }
+        this -> state.queued = 0;
+        policy = overflow;
+    }
+
+    // Setter function for the service order. Classes come from the message's priorityClass(); with
+    // WEIGHTED_FAIR class i gets weights[i] of every sum(weights) messages served while it has any queued.
+    void setScheduling(SchedulingPolicy _scheduling, std::array<int64_t, BUFFER_CLASSES> _weights = {8, 4, 2, 1}) {
+        scheduling = _scheduling;
+        weights = _weights;
+    }
+
+    // Setter function for the node this buffer belongs to, its metrics become "<id>/buffer"
+    void setNodeID(const std::string& id) {
+        nodeID = id;
+        metricsScope = id + "/" + this -> getId();
+        metrics.reset();
+        classMetrics.reset();
+    }
+
+    // Setter function for batch mode: forward up to `size` messages per cycle, one cycle every `delay` seconds.
+    // The default (1, 1e-8) forwards one message at a time.
+    void setBatching(size_t size, double delay = 0.00000001) {
+        batchSize = std::max<size_t>(size, 1);
+        batchDelay = delay;
+    }
+
+    size_t getBatchSize() const {
+        return batchSize;
     }
 
+    // Service time of one cycle, however many messages it forwards
     double getProcessingDelay() const {
-        // Keeping it static for now for simplicity 
-        return 0.00000001;
+        return batchDelay;
+    }
+
+    // Log only the fields that changed since the previous transition, nothing if the log filter drops it
+    std::string logState() const override {
+        if (!LogFilter::WantsState(this, this -> getId(), nodeID)) {
+            return "";
+        }
+        return stateDelta.log("BufferState", this -> state);
+    }
+
+private:
+    mutable StateDelta stateDelta;
+    OverflowPolicy policy = OverflowPolicy::DROP_TAIL;
+    size_t capacity = 0;
+    SchedulingPolicy scheduling = SchedulingPolicy::FIFO;
+    std::array<int64_t, BUFFER_CLASSES> weights = {8, 4, 2, 1};
+    size_t batchSize = 1;
+    double batchDelay = 0.00000001;
+    std::string nodeID;
+    std::string metricsScope;
+    mutable MetricsBinding<BufferMetrics> metrics;
+    mutable MetricsBinding<BufferClassMetrics> classMetrics;
+
+    // Classes of the messages the next cycle serves, in order. With `credits` set the weighted-fair
+    // credits are advanced past the batch; output passes null and leaves them alone.
+    std::vector<size_t> nextBatch(const BufferState<MessageType>& s, std::array<int64_t, BUFFER_CLASSES>* credits) const {
+        std::vector<size_t> batch;
+        std::array<size_t, BUFFER_CLASSES> taken{};
+        std::array<int64_t, BUFFER_CLASSES> credit = s.credits;
+        size_t size = std::min(batchSize, s.queued);
+        for (size_t n = 0; n < size; n++) {
+            size_t chosen = BUFFER_CLASSES;
+            if (scheduling == SchedulingPolicy::WEIGHTED_FAIR) {
+                // Smooth weighted round robin over the classes that still have messages
+                int64_t total = 0;
+                for (size_t c = 0; c < BUFFER_CLASSES; c++) {
+                    if (s.queues[c].size() > taken[c]) {
+                        credit[c] += weights[c];
+                        total += weights[c];
+                        if (chosen == BUFFER_CLASSES || credit[c] > credit[chosen]) {
+                            chosen = c;
+                        }
+                    }
+                }
+                credit[chosen] -= total;
+            } else {
+                // FIFO buffers only fill class 0, so this is arrival order for them
+                chosen = 0;
+                while (s.queues[chosen].size() == taken[chosen]) {
+                    chosen++;
+                }
+            }
+            taken[chosen]++;
+            batch.push_back(chosen);
+        }
+        if (credits) {
+            *credits = credit;
+        }
+        return batch;
     }
 
+    // Queue an arriving message, making room or dropping as the overflow policy says
+    void enqueue(BufferState<MessageType>& s, const std::shared_ptr<MessageType>& msg) const {
+        if (capacity != 0 && s.queued >= capacity) {
+            switch (policy) {
+                case OverflowPolicy::DROP_OLDEST: {
+                    // The oldest message is at the head of its class
+                    s.queues[findOldest(s, [](const MessageType&) { return true; }).first].pop_front();
+                    break;
+                }
+                case OverflowPolicy::DROP_HEARTBEATS: {
+                    auto [c, i] = findOldest(s, [](const MessageType& queued) { return IsHeartbeat<MessageType>::get(queued); });
+                    if (IsHeartbeat<MessageType>::get(*msg) || c == BUFFER_CLASSES) {
+                        drop(s);
+                        return;
+                    }
+                    s.queues[c].erase(i);
+                    break;
+                }
+                default:
+                    drop(s);
+                    return;
+            }
+            s.queued--;
+            drop(s);
+        }
+        size_t c = scheduling == SchedulingPolicy::FIFO ? 0 : PriorityClassOf<MessageType>::get(*msg);
+        s.queues[c].push_back({msg, s.currentTime, s.arrivals++});
+        s.queued++;
+        s.highWater = std::max(s.highWater, s.queued);
+    }
+
+    // Class and position of the earliest queued message matching `match`, class BUFFER_CLASSES if none
+    template <typename Match>
+    std::pair<size_t, size_t> findOldest(const BufferState<MessageType>& s, Match match) const {
+        std::pair<size_t, size_t> oldest = {BUFFER_CLASSES, 0};
+        for (size_t c = 0; c < BUFFER_CLASSES; c++) {
+            for (size_t i = 0; i < s.queues[c].size(); i++) {
+                if (match(*s.queues[c][i].message)) {
+                    if (oldest.first == BUFFER_CLASSES || s.queues[c][i].sequence < s.queues[oldest.first][oldest.second].sequence) {
+                        oldest = {c, i};
+                    }
+                    // Later entries of this class arrived after this one
+                    break;
+                }
+            }
+        }
+        return oldest;
+    }
+
+    void recordDepth(const BufferState<MessageType>& s) const {
+        if (BufferMetrics* m = metrics.get(metricsScope)) {
+            m -> depth -> set(s.queued);
+        }
+        if (scheduling != SchedulingPolicy::FIFO) {
+            if (BufferClassMetrics* m = classMetrics.get(metricsScope)) {
+                for (size_t c = 0; c < BUFFER_CLASSES; c++) {
+                    m -> depth[c] -> set(s.queues[c].size());
+                }
+            }
+        }
+    }
+
+    void drop(BufferState<MessageType>& s) const {
+        s.dropped++;
+        if (BufferMetrics* m = metrics.get(metricsScope)) {
+            m -> dropped -> add();
+        }
+    }
+
+    // Stop upstream when the ring fills, let it resume once half of it has drained
+    void updateBackpressure(BufferState<MessageType>& s) const {
+        if (policy != OverflowPolicy::BACKPRESSURE) {
+            return;
+        }
+        bool stop = s.backpressure ? s.queued > capacity / 2 : (capacity != 0 && s.queued >= capacity);
+        if (stop != s.backpressure) {
+            s.backpressure = stop;
+            s.backpressureChanged = true;
+        }
+    }
 };
 
 #endif
@@ -0,0 +1,382 @@
+#ifndef CLIENT_HPP
+#define CLIENT_HPP
+
+#include <cadmium/core/modeling/atomic.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+#include "../../messages/network/network_message.hpp"
+#include "../../messages/raft/raft_messages.hpp"
+#include "../../utils/stochastic/random.hpp"
+#include "../../utils/stochastic/zipf.hpp"
+#include "../../utils/logging/state_delta.hpp"
+#include "../../utils/logging/log_filter.hpp"
+#include "../../utils/metrics/metrics.hpp"
+#include "../../utils/queueing/delay_line.hpp"
+
+using namespace cadmium;
+
+// POISSON: open loop at `rate`. MMPP: open loop switching between `rate` and `burstRate`.
+// CLOSED_LOOP: `outstanding` requests in flight, each response followed by a think time.
+// TRACE: one request at each time in `trace`.
+enum class ArrivalProcess { POISSON, MMPP, CLOSED_LOOP, TRACE };
+enum class KeyDistribution { UNIFORM, ZIPFIAN };
+
+struct ClientConfig {
+    ArrivalProcess arrivals = ArrivalProcess::POISSON;
+    double rate = 100;  // Requests per second, POISSON and the calm state of MMPP
+    double burstRate = 1000;  // MMPP burst state
+    double calmTime = 0.2;  // MMPP: mean seconds in the calm state
+    double burstTime = 0.02;  // MMPP: mean seconds in the burst state
+    size_t outstanding = 1;  // CLOSED_LOOP
+    double thinkTime = 0;  // CLOSED_LOOP: mean seconds between a response and the next request
+    std::vector<double> trace;  // TRACE: submit times, ascending
+    double start = 0;  // First request, open loops and CLOSED_LOOP
+    size_t requests = 0;  // Requests to issue, 0 for no limit
+    size_t keys = 1000;
+    KeyDistribution keyDistribution = KeyDistribution::UNIFORM;
+    double zipfTheta = 0.99;
+    size_t valueSize = 64;  // Bytes per value
+    double readFraction = 0;  // Share of requests that are reads, the rest are writes
+    bool spreadReads = false;  // Send each read to a random server instead of the leader, for follower reads
+    double timeout = 0.1;  // Resend to the next node when nothing came back
+    double redirectBackoff = 0.01;  // Wait before retrying when the node knew no leader
+    std::vector<std::string> servers;  // Nodes to try, the first is tried first
+};
+
+// One request from creation to response. Times are -1 until they happen.
+struct ClientRecord {
+    uint64_t requestID = 0;
+    std::string key;
+    ClientOperation operation = ClientOperation::WRITE;
+    double submitTime = -1;  // First send
+    double commitTime = -1;  // When the leader saw it committed
+    double applyTime = -1;  // When the leader applied it
+    double responseTime = -1;  // When the response reached the client
+    int logIndex = -1;
+    std::string server;  // spreadReads: the node this read goes to, empty to follow the client's target
+    std::string servedBy;  // The node that answered
+    int attempt = 0;  // Latest scheduled send or timeout, older ones are stale
+    int sends = 0;
+    int redirects = 0;
+};
+
+enum class SubmissionKind { SEND, TIMEOUT };
+
+struct Submission {
+    uint64_t requestID;
+    int attempt;
+    SubmissionKind kind;
+};
+
+struct ClientState {
+    double currentTime = 0;
+    DelayLine<Submission> submissions;  // Sends and timeouts, due when they happen
+    std::map<uint64_t, ClientRecord> inFlight;
+    std::vector<ClientRecord> completed;
+    uint64_t issued = 0;  // Requests created so far
+    std::string target;  // Node requests are sent to, the leader as far as the client knows
+    bool burst = false;  // MMPP state
+    double nextSwitch = std::numeric_limits<double>::infinity();  // MMPP: when the state flips
+    size_t traceIndex = 0;
+
+    // Response latency at quantile q in [0, 1] over the completed requests, 0 when there are none
+    double latencyPercentile(double q) const {
+        std::vector<double> latencies;
+        latencies.reserve(completed.size());
+        for (const auto& record : completed) {
+            latencies.push_back(record.responseTime - record.submitTime);
+        }
+        if (latencies.empty()) {
+            return 0;
+        }
+        size_t rank = std::min(latencies.size() - 1, static_cast<size_t>(q * latencies.size()));
+        std::nth_element(latencies.begin(), latencies.begin() + rank, latencies.end());
+        return latencies[rank];
+    }
+
+    template <typename Writer>
+    void describe(Writer& w) const {
+        w.field("issued", issued);
+        w.field("inFlight", inFlight.size());
+        w.field("completed", completed.size());
+        w.field("target", target);
+        w.field("currentTime", currentTime);
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const ClientState& s) {
+        StateDelta::full(os, "ClientState", s);
+        return os;
+    }
+};
+
+// Metrics recorded by each client, scoped by its id
+struct ClientMetrics {
+    Histogram* latency = nullptr;  // First send to response, in seconds
+    Histogram* commitLatency = nullptr;  // First send to commit, writes only
+    Histogram* readLatency = nullptr;  // First send to response, reads only
+    Counter* completed = nullptr;
+    Counter* redirects = nullptr;
+    Counter* timeouts = nullptr;
+
+    ClientMetrics() = default;
+    ClientMetrics(MetricsRegistry& registry, const std::string& scope)
+        : latency(&registry.histogram(scope, "latency")),
+          commitLatency(&registry.histogram(scope, "commit_latency")),
+          readLatency(&registry.histogram(scope, "read_latency")),
+          completed(&registry.counter(scope, "completed")),
+          redirects(&registry.counter(scope, "redirects")),
+          timeouts(&registry.counter(scope, "timeouts")) {}
+};
+
+
+// Issues reads and writes to the cluster and times them end to end. Requests go to the node the
+// client believes leads, spread reads to a server picked per read; a follower's redirect or a
+// timeout moves them to another node.
+class ClientModel : public Atomic<ClientState> {
+public:
+    Port<std::shared_ptr<Packet>> input_packet;
+    Port<std::shared_ptr<Packet>> output_packet;
+
+    ClientModel(const std::string& id, const ClientConfig& _config)
+    : Atomic<ClientState>(id, {}), config(_config), zipf(_config.keys, _config.zipfTheta) {
+        input_packet = addInPort<std::shared_ptr<Packet>>("input_packet");
+        output_packet = addOutPort<std::shared_ptr<Packet>>("output_packet");
+
+        state.target = config.servers.empty() ? "" : config.servers.front();
+        switch (config.arrivals) {
+            case ArrivalProcess::CLOSED_LOOP:
+                for (size_t i = 0; i < config.outstanding; i++) {
+                    NewRequest(state, config.start);
+                }
+                break;
+            case ArrivalProcess::TRACE:
+                NextTraceRequest(state);
+                break;
+            case ArrivalProcess::MMPP:
+                state.nextSwitch = config.start + RandomNumberGeneratorDEVS::generateExponentialDelay(1.0 / config.calmTime);
+                NewRequest(state, NextArrival(state, config.start));
+                break;
+            default:
+                NewRequest(state, NextArrival(state, config.start));
+                break;
+        }
+    }
+
+    void internalTransition(ClientState& s) const override {
+        s.currentTime = std::max(s.currentTime, s.submissions.nextDue());
+        for (const auto& event : s.submissions.popDue()) {
+            const Submission& submission = event.item;
+            auto record = s.inFlight.find(submission.requestID);
+            if (record == s.inFlight.end() || record -> second.attempt != submission.attempt) {
+                continue;
+            }
+            if (submission.kind == SubmissionKind::TIMEOUT) {
+                // Nothing came back, try the next node
+                if (ClientMetrics* m = metrics.get(getId())) {
+                    m -> timeouts -> add();
+                }
+                std::string& destination = Destination(s, record -> second);
+                destination = NextServer(destination);
+                Schedule(s, record -> second, SubmissionKind::SEND, s.currentTime);
+                continue;
+            }
+            // The request output just sent
+            ClientRecord& sent = record -> second;
+            if (sent.sends++ == 0) {
+                sent.submitTime = s.currentTime;
+                NextOpenLoopRequest(s);
+            }
+            Schedule(s, sent, SubmissionKind::TIMEOUT, s.currentTime + config.timeout);
+        }
+    }
+
+    void externalTransition(ClientState& s, double e) const override {
+        s.currentTime += e;
+        for (const auto& packet : input_packet -> getBag()) {
+            auto message = std::static_pointer_cast<RaftMessage>(packet -> payload);
+            if (message -> content -> getType() != Task::CLIENT_RESPONSE) {
+                continue;
+            }
+            const ClientResponseMetadata& response = std::static_pointer_cast<ClientResponse>(message -> content) -> metadata;
+            auto record = s.inFlight.find(response.requestID);
+            // Answer to a request already completed, e.g. one that was resent
+            if (record == s.inFlight.end()) {
+                continue;
+            }
+            ClientRecord& request = record -> second;
+
+            if (response.status == ClientStatus::REDIRECT) {
+                request.redirects++;
+                if (ClientMetrics* m = metrics.get(getId())) {
+                    m -> redirects -> add();
+                }
+                // No leader known yet, give the election time before asking the next node
+                bool hinted = !response.leaderHint.empty() && response.leaderHint != message -> source;
+                std::string& destination = Destination(s, request);
+                destination = hinted ? response.leaderHint : NextServer(destination);
+                Schedule(s, request, SubmissionKind::SEND, s.currentTime + (hinted ? 0 : config.redirectBackoff));
+                continue;
+            }
+
+            // A spread read answered by a follower says nothing about who leads
+            if (request.server.empty()) {
+                s.target = message -> source;
+            }
+            request.servedBy = message -> source;
+            request.commitTime = response.commitTime;
+            request.applyTime = response.applyTime;
+            request.responseTime = s.currentTime;
+            request.logIndex = response.logIndex;
+            if (ClientMetrics* m = metrics.get(getId())) {
+                m -> latency -> record(request.responseTime - request.submitTime);
+                // Reads never commit, their commit time is when the server answered
+                if (request.operation == ClientOperation::READ) {
+                    m -> readLatency -> record(request.responseTime - request.submitTime);
+                } else {
+                    m -> commitLatency -> record(request.commitTime - request.submitTime);
+                }
+                m -> completed -> add();
+            }
+            s.completed.push_back(std::move(request));
+            s.inFlight.erase(record);
+
+            if (config.arrivals == ArrivalProcess::CLOSED_LOOP) {
+                double think = config.thinkTime > 0 ? RandomNumberGeneratorDEVS::generateExponentialDelay(1.0 / config.thinkTime) : 0;
+                NewRequest(s, s.currentTime + think);
+            }
+        }
+    }
+
+    // Output: every request due to be sent now, to the node believed to lead or the read's own server
+    void output(const ClientState& s) const override {
+        s.submissions.forEachDue([&](const auto& event) {
+            const Submission& submission = event.item;
+            auto record = s.inFlight.find(submission.requestID);
+            if (submission.kind != SubmissionKind::SEND || record == s.inFlight.end() || record -> second.attempt != submission.attempt) {
+                return;
+            }
+            const ClientRecord& request = record -> second;
+            bool read = request.operation == ClientOperation::READ;
+            ClientCommand command{getId(), submission.requestID, request.key, read ? "" : std::string(config.valueSize, 'v'), request.operation};
+            const std::string& destination = request.server.empty() ? s.target : request.server;
+            auto message = std::make_shared<RaftMessage>(std::make_shared<ClientRequest>(command));
+            message -> source = getId();
+            message -> dest = destination;
+            auto packet = std::make_shared<Packet>(message, destination, getId());
+            packet -> timestamp = event.due;
+            output_packet -> addMessage(packet);
+        });
+    }
+
+    double timeAdvance(const ClientState& s) const override {
+        return s.submissions.timeUntilNext(s.currentTime);
+    }
+
+    const ClientConfig& getConfig() const {
+        return config;
+    }
+
+    // Log only the fields that changed since the previous transition, nothing if the log filter drops it
+    std::string logState() const override {
+        if (!LogFilter::WantsState(this, getId())) {
+            return "";
+        }
+        return stateDelta.log("ClientState", state);
+    }
+
+private:
+    mutable StateDelta stateDelta;
+    ClientConfig config;
+    ZipfDistribution zipf;
+    mutable MetricsBinding<ClientMetrics> metrics;
+
+    // Create the next request, first sent at `at`, unless the request budget is spent
+    void NewRequest(ClientState& s, double at) const {
+        if ((config.requests != 0 && s.issued >= config.requests) || at == std::numeric_limits<double>::infinity()) {
+            return;
+        }
+        ClientRecord record;
+        record.requestID = ++s.issued;
+        size_t rank = config.keyDistribution == KeyDistribution::ZIPFIAN
+            ? zipf.sample()
+            : static_cast<size_t>(RandomNumberGeneratorDEVS::generateUniformDelay(0, static_cast<double>(config.keys)));
+        record.key = "key" + std::to_string(std::min(rank, config.keys - 1));
+        if (config.readFraction > 0 && RandomNumberGeneratorDEVS::generateUniformDelay(0, 1) < config.readFraction) {
+            record.operation = ClientOperation::READ;
+            if (config.spreadReads && !config.servers.empty()) {
+                size_t server = static_cast<size_t>(RandomNumberGeneratorDEVS::generateUniformDelay(0, static_cast<double>(config.servers.size())));
+                record.server = config.servers[std::min(server, config.servers.size() - 1)];
+            }
+        }
+        ClientRecord& stored = s.inFlight[record.requestID] = record;
+        Schedule(s, stored, SubmissionKind::SEND, at);
+    }
+
+    // Open loops create the next request once the previous one is out
+    void NextOpenLoopRequest(ClientState& s) const {
+        switch (config.arrivals) {
+            case ArrivalProcess::POISSON:
+            case ArrivalProcess::MMPP:
+                NewRequest(s, NextArrival(s, s.currentTime));
+                break;
+            case ArrivalProcess::TRACE:
+                NextTraceRequest(s);
+                break;
+            default:
+                break;
+        }
+    }
+
+    void NextTraceRequest(ClientState& s) const {
+        if (s.traceIndex < config.trace.size()) {
+            NewRequest(s, config.trace[s.traceIndex++]);
+        }
+    }
+
+    // Next open-loop arrival after `from`. Both MMPP states are Poisson, so an arrival that would
+    // fall past a state switch is redrawn from the switch at the new rate.
+    double NextArrival(ClientState& s, double from) const {
+        if (config.arrivals != ArrivalProcess::MMPP) {
+            return config.rate > 0 ? from + RandomNumberGeneratorDEVS::generateExponentialDelay(config.rate) : std::numeric_limits<double>::infinity();
+        }
+        if (config.rate <= 0 && config.burstRate <= 0) {
+            return std::numeric_limits<double>::infinity();
+        }
+        double time = from;
+        while (true) {
+            double rate = s.burst ? config.burstRate : config.rate;
+            double arrival = rate > 0 ? time + RandomNumberGeneratorDEVS::generateExponentialDelay(rate) : std::numeric_limits<double>::infinity();
+            if (arrival <= s.nextSwitch) {
+                return arrival;
+            }
+            time = s.nextSwitch;
+            s.burst = !s.burst;
+            s.nextSwitch = time + RandomNumberGeneratorDEVS::generateExponentialDelay(1.0 / (s.burst ? config.burstTime : config.calmTime));
+        }
+    }
+
+    // Any submission scheduled earlier for this request becomes stale
+    void Schedule(ClientState& s, ClientRecord& record, SubmissionKind kind, double at) const {
+        record.attempt++;
+        s.submissions.push(Submission{record.requestID, record.attempt, kind}, s.currentTime, at);
+    }
+
+    // Where the request is sent: its own server if it has one, else the client's target
+    static std::string& Destination(ClientState& s, ClientRecord& record) {
+        return record.server.empty() ? s.target : record.server;
+    }
+
+    std::string NextServer(const std::string& current) const {
+        if (config.servers.empty()) {
+            return current;
+        }
+        auto it = std::find(config.servers.begin(), config.servers.end(), current);
+        return (it == config.servers.end() || it + 1 == config.servers.end()) ? config.servers.front() : *(it + 1);
+    }
+};
+
+#endif
@@ -0,0 +1,262 @@
+#ifndef DISK_HPP
+#define DISK_HPP
+
+#include <cadmium/core/modeling/atomic.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include "../../messages/raft/raft_messages.hpp"
+#include "../../utils/stochastic/random.hpp"
+#include "../../utils/logging/state_delta.hpp"
+#include "../../utils/logging/log_filter.hpp"
+#include "../../utils/metrics/metrics.hpp"
+#include "../../utils/tracing/message_tracer.hpp"
+#include "../../utils/queueing/delay_line.hpp"
+#include "../../utils/queueing/ring_buffer.hpp"
+
+using namespace cadmium;
+
+enum class FsyncDistribution { CONSTANT, EXPONENTIAL, GAUSSIAN };
+
+// The storage device behind a node's Raft log. A flush writes its bytes sequentially at
+// `bandwidth` and then waits for one fsync.
+struct DiskConfig {
+    double bandwidth = 200e6;  // Sequential write bandwidth, bytes per second
+    double fsyncMean = 2e-3;  // Seconds
+    double fsyncStddev = 5e-4;  // GAUSSIAN only, samples are clamped at 0
+    FsyncDistribution fsyncDistribution = FsyncDistribution::EXPONENTIAL;
+    size_t queueDepth = 1;  // Flushes the device runs at once
+    bool groupCommit = true;  // A flush takes every write waiting for the device, not just one
+    size_t maxGroup = 0;  // Most writes per flush, 0 for no limit
+    bool overlapSend = false;  // Leaders send AppendEntries while their own copy is being written
+    size_t entryOverhead = 16;  // Record header per log entry, bytes
+    size_t entryBytes = 256;  // Assumed size of an entry a follower acknowledges, the ack only carries a count
+    size_t hardStateBytes = 64;  // Term and vote record, bytes
+
+    double sampleFsync() const {
+        switch (fsyncDistribution) {
+            case FsyncDistribution::EXPONENTIAL:
+                return fsyncMean > 0 ? RandomNumberGeneratorDEVS::generateExponentialDelay(1.0 / fsyncMean) : 0;
+            case FsyncDistribution::GAUSSIAN:
+                return std::max(0.0, RandomNumberGeneratorDEVS::generateGaussianDelay(fsyncMean, fsyncStddev));
+            default:
+                return fsyncMean;
+        }
+    }
+};
+
+// A write waiting to be durable, and the message to send once it is (none when already sent)
+struct DiskWrite {
+    std::shared_ptr<RaftMessage> message;
+    size_t bytes = 0;
+    double arrivalTime = 0;
+};
+
+struct DiskState {
+    RingBuffer<DiskWrite> queue;  // Writes waiting for the device
+    DelayLine<std::vector<DiskWrite>> flushes;  // Flushes on the device, due when their fsync returns
+    std::vector<std::shared_ptr<RaftMessage>> ready;  // Messages to send now, nothing of theirs left to persist
+    double currentTime = 0;
+    uint64_t fsyncs = 0;
+    uint64_t bytesWritten = 0;
+
+    template <typename Writer>
+    void describe(Writer& w) const {
+        w.field("queued", queue.size());
+        w.field("flushing", flushes.size());
+        w.field("fsyncs", fsyncs);
+        w.field("bytesWritten", bytesWritten);
+        w.field("currentTime", currentTime);
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const DiskState& s) {
+        StateDelta::full(os, "DiskState", s);
+        return os;
+    }
+};
+
+// Metrics recorded by each disk, scoped "<node>/disk"
+struct DiskMetrics {
+    Counter* fsyncs = nullptr;
+    Counter* bytesWritten = nullptr;
+    Histogram* groupSize = nullptr;  // Writes made durable per fsync
+    Histogram* writeLatency = nullptr;  // From arrival to durable, in seconds
+    Gauge* queued = nullptr;
+
+    DiskMetrics() = default;
+    DiskMetrics(MetricsRegistry& registry, const std::string& scope)
+        : fsyncs(&registry.counter(scope, "fsyncs")),
+          bytesWritten(&registry.counter(scope, "bytes_written")),
+          groupSize(&registry.histogram(scope, "group_size", 1)),
+          writeLatency(&registry.histogram(scope, "write_latency")),
+          queued(&registry.gauge(scope, "queued")) {}
+};
+
+
+// Sits between the Raft controller and the message processor. A message that depends on newly
+// persisted state (log entries, term or vote) leaves only once that state is durable: a leader's
+// AppendEntries, a follower's acknowledgement of new entries, vote messages. Anything else passes
+// straight through. Without a config every message passes straight through.
+class DiskModel : public Atomic<DiskState> {
+public:
+    Port<std::shared_ptr<RaftMessage>> input_raft_message;
+    Port<std::shared_ptr<RaftMessage>> output_raft_message;
+
+    DiskModel(const std::string& id) : Atomic<DiskState>(id, {}), metricsScope(id) {
+        input_raft_message = addInPort<std::shared_ptr<RaftMessage>>("input_raft_message");
+        output_raft_message = addOutPort<std::shared_ptr<RaftMessage>>("output_raft_message");
+    }
+
+    void internalTransition(DiskState& s) const override {
+        // Time only passes when there was nothing ready to send
+        if (s.ready.empty()) {
+            s.currentTime = std::max(s.currentTime, s.flushes.nextDue());
+        }
+        s.ready.clear();
+        // The flushes output just completed
+        std::vector<DelayLine<std::vector<DiskWrite>>::Entry> completed;
+        if (s.flushes.nextDue() <= s.currentTime) {
+            completed = s.flushes.popDue(s.currentTime);
+        }
+        for (const auto& flush : completed) {
+            if (DiskMetrics* m = metrics.get(metricsScope)) {
+                m -> groupSize -> record(flush.item.size());
+                for (const auto& write : flush.item) {
+                    m -> writeLatency -> record(s.currentTime - write.arrivalTime);
+                }
+            }
+            if (MessageTracer* tracer = MessageTracer::Active()) {
+                for (const auto& write : flush.item) {
+                    if (write.message) {
+                        tracer -> span(write.message -> traceId, write.message -> source, getId(), "fsync", write.arrivalTime, s.currentTime);
+                    }
+                }
+            }
+        }
+        StartFlushes(s);
+    }
+
+    void externalTransition(DiskState& s, double e) const override {
+        s.currentTime += e;
+        for (const auto& msg : input_raft_message -> getBag()) {
+            size_t bytes = config ? PersistBytes(*msg) : 0;
+            if (bytes == 0) {
+                s.ready.push_back(msg);
+            } else if (config -> overlapSend && msg -> content -> getType() == Task::APPEND_ENTRIES) {
+                // Only leaders send AppendEntries, replication then proceeds in parallel with their own write
+                s.ready.push_back(msg);
+                s.queue.push_back(DiskWrite{nullptr, bytes, s.currentTime});
+            } else {
+                s.queue.push_back(DiskWrite{msg, bytes, s.currentTime});
+            }
+        }
+        StartFlushes(s);
+    }
+
+    // Output: messages with nothing to wait for, and those whose flush completes now
+    void output(const DiskState& s) const override {
+        for (const auto& msg : s.ready) {
+            output_raft_message -> addMessage(msg);
+        }
+        if (!s.ready.empty() && s.flushes.nextDue() > s.currentTime) {
+            return;
+        }
+        s.flushes.forEachDue([&](const auto& flush) {
+            for (const auto& write : flush.item) {
+                if (write.message) {
+                    output_raft_message -> addMessage(write.message);
+                }
+            }
+        }, s.currentTime);
+    }
+
+    double timeAdvance(const DiskState& s) const override {
+        return s.ready.empty() ? s.flushes.timeUntilNext(s.currentTime) : 0;
+    }
+
+    // Bytes that must be durable before the message may leave, 0 when it carries no new state
+    size_t PersistBytes(const RaftMessage& msg) const {
+        switch (msg.content -> getType()) {
+            case Task::APPEND_ENTRIES: {
+                // A catch-up to one peer resends entries already on disk
+                if (msg.dest != "*") {
+                    return 0;
+                }
+                size_t bytes = 0;
+                for (const auto& entry : std::static_pointer_cast<AppendEntries>(msg.content) -> metadata.entries) {
+                    bytes += config -> entryOverhead + entry -> toString().size();
+                }
+                return bytes;
+            }
+            case Task::APPEND_ENTRIES_RESPONSE: {
+                auto response = std::static_pointer_cast<AppendEntriesResponse>(msg.content);
+                return response -> metadata.appended * (config -> entryOverhead + config -> entryBytes);
+            }
+            case Task::VOTE_REQUEST:
+            case Task::VOTE_RESPONSE:
+                return config -> hardStateBytes;
+            default:
+                return 0;
+        }
+    }
+
+    // Setter function for the storage device, messages wait for their state to be persisted from now on
+    void setConfig(const DiskConfig& _config) {
+        config = std::make_shared<DiskConfig>(_config);
+    }
+
+    std::shared_ptr<const DiskConfig> getConfig() const {
+        return config;
+    }
+
+    // Setter function for the node this disk belongs to, its metrics become "<id>/disk"
+    void setNodeID(const std::string& id) {
+        nodeID = id;
+        metricsScope = id + "/" + getId();
+        metrics.reset();
+    }
+
+    // Log only the fields that changed since the previous transition, nothing if the log filter drops it
+    std::string logState() const override {
+        if (!LogFilter::WantsState(this, getId(), nodeID)) {
+            return "";
+        }
+        return stateDelta.log("DiskState", state);
+    }
+
+private:
+    mutable StateDelta stateDelta;
+    std::shared_ptr<DiskConfig> config;
+    std::string nodeID;
+    std::string metricsScope;
+    mutable MetricsBinding<DiskMetrics> metrics;
+
+    // Hand waiting writes to the device while it has a free slot
+    void StartFlushes(DiskState& s) const {
+        while (!s.queue.empty() && s.flushes.size() < std::max<size_t>(config -> queueDepth, 1)) {
+            size_t limit = config -> groupCommit ? (config -> maxGroup ? config -> maxGroup : s.queue.size()) : 1;
+            std::vector<DiskWrite> group;
+            size_t bytes = 0;
+            while (!s.queue.empty() && group.size() < limit) {
+                bytes += s.queue.front().bytes;
+                group.push_back(std::move(s.queue.front()));
+                s.queue.pop_front();
+            }
+            double duration = bytes / config -> bandwidth + config -> sampleFsync();
+            s.flushes.push(std::move(group), s.currentTime, s.currentTime + duration);
+            s.fsyncs++;
+            s.bytesWritten += bytes;
+            if (DiskMetrics* m = metrics.get(metricsScope)) {
+                m -> fsyncs -> add();
+                m -> bytesWritten -> add(bytes);
+            }
+        }
+        if (DiskMetrics* m = metrics.get(metricsScope)) {
+            m -> queued -> set(s.queue.size());
+        }
+    }
+};
+
+#endif
@@ -5,17 +5,101 @@
 #include <iostream>
 #include <vector>
 #include <memory>
+#include <limits>
+#include <algorithm>
 #include "../../utils/stochastic/random.hpp"
+#include "../../utils/timing/rtt_estimator.hpp"
 #include "../../messages/raft/raft_messages.hpp"
+#include "../../utils/logging/log_filter.hpp"
 
 using namespace cadmium;
 
+// Followers start an election after a silence drawn from [ELECTION_TIMEOUT_MIN, ELECTION_TIMEOUT_MAX],
+// leaders send a heartbeat every HEARTBEAT_INTERVAL. Seconds.
+constexpr double ELECTION_TIMEOUT_MIN = 0.150;
+constexpr double ELECTION_TIMEOUT_MAX = 0.300;
+constexpr double HEARTBEAT_INTERVAL = 0.05;
+
+// How a node's timers follow the round-trip times the leader observes. Fixed timers use the
+// constants above. Adaptive ones send a heartbeat every `heartbeatRtts` smoothed RTTs and start the
+// election window `electionHeartbeats` heartbeats plus one RTO after the last message from the
+// leader, each clamped to its bounds. Until the first sample they behave as fixed timers.
+struct TimeoutConfig {
+    bool adaptive = false;
+    double heartbeatRtts = 0.5;
+    double electionHeartbeats = 3;
+    double minHeartbeat = 0.005;
+    double maxHeartbeat = 0.25;
+    double minElection = 0.020;
+    double maxElection = 2.0;
+};
+
+// The round-trip estimate of one node and the timeouts derived from it. Kept in the Raft
+// controller's state, which passes the timeouts on to the heartbeat controller running the countdowns.
+class ElectionTimers {
+    public:
+        ElectionTimers() : ElectionTimers(TimeoutConfig()) {}
+        explicit ElectionTimers(const TimeoutConfig& config) : config(config) {}
+
+        void observe(double rtt) {
+            estimator.observe(rtt);
+        }
+
+        // Followers take the leader's estimate, so the whole cluster derives the same timeouts
+        void assume(double smoothed, double variation) {
+            estimator.assume(smoothed, variation);
+        }
+
+        bool adapting() const {
+            return config.adaptive && estimator.count() > 0;
+        }
+
+        double heartbeatInterval() const {
+            if (!adapting()) {
+                return HEARTBEAT_INTERVAL;
+            }
+            return std::clamp(config.heartbeatRtts * estimator.smoothed(), config.minHeartbeat, config.maxHeartbeat);
+        }
+
+        // Silence from the leader a follower puts up with before it may start an election
+        double electionTimeoutMin() const {
+            if (!adapting()) {
+                return ELECTION_TIMEOUT_MIN;
+            }
+            return std::clamp(config.electionHeartbeats * heartbeatInterval() + estimator.timeout(),
+                              config.minElection, config.maxElection);
+        }
+
+        // Lower bound on electionTimeoutMin() whatever the estimate, and so on any node's. Leases
+        // rely on it since the nodes' estimates need not agree.
+        double leaseTimeout() const {
+            return config.adaptive ? std::min(config.minElection, ELECTION_TIMEOUT_MIN) : ELECTION_TIMEOUT_MIN;
+        }
+
+        const RttEstimator& getEstimator() const {
+            return estimator;
+        }
+
+        const TimeoutConfig& getConfig() const {
+            return config;
+        }
+
+        void setConfig(const TimeoutConfig& _config) {
+            config = _config;
+        }
+
+    private:
+        TimeoutConfig config;
+        RttEstimator estimator;
+};
 
 
 // HeartbeatController State
 struct HeartbeatControllerState {
     HeartbeatStatus status = HeartbeatStatus::ALIVE;
-    double heartbeatTimeout = RandomNumberGeneratorDEVS::generateUniformDelay(0.150,0.300);   // Time until next timeout
+    double heartbeatInterval = HEARTBEAT_INTERVAL;  // Last passed on by the Raft controller
+    double electionTimeoutMin = ELECTION_TIMEOUT_MIN;  // Likewise, the lower end of the election window
+    double heartbeatTimeout = RandomNumberGeneratorDEVS::generateUniformDelay(ELECTION_TIMEOUT_MIN, ELECTION_TIMEOUT_MAX);   // Time until next timeout
 
     friend std::ostream& operator<<(std::ostream& os, const HeartbeatControllerState& s) {
         os << "HeartbeatControllerState Timeout: " <<  s.heartbeatTimeout;
@@ -27,34 +111,44 @@ struct HeartbeatControllerState {
 class HeartbeatControllerModel : public Atomic<HeartbeatControllerState> {
 public:
     // Ports
-    Port<HeartbeatStatus> input_heartbeat_update;  
+    Port<HeartbeatUpdate> input_heartbeat_update;  
     Port<HeartbeatStatus> output_heartbeat_timeout; 
 
     // Constructor to initialize the HeartbeatController model
     HeartbeatControllerModel(const std::string& id) : Atomic<HeartbeatControllerState>(id, {}) {
-        input_heartbeat_update = cadmium::Component::addInPort<HeartbeatStatus>("input_heartbeat");
+        input_heartbeat_update = cadmium::Component::addInPort<HeartbeatUpdate>("input_heartbeat");
         output_heartbeat_timeout = cadmium::Component::addOutPort<HeartbeatStatus>("output_heartbeat");
     }
 
     // Internal transition: Reset the heartbeat timeout when a timeout event occurs
     void internalTransition(HeartbeatControllerState& s) const override {
         // Heartbeat sent out, now waiting for the next external heartbeat update
-        // Keep looping every 50ms otherwise..
+        // Keep looping every heartbeat interval otherwise..
         if (s.status !=  HeartbeatStatus::UPDATE) {
             s.heartbeatTimeout = std::numeric_limits<double>::infinity();
+        } else {
+            s.heartbeatTimeout = s.heartbeatInterval;
         }
 
     }
 
     // External transition: Start countdown for heartbeat timeout
     void externalTransition(HeartbeatControllerState& s, double e) const override { 
-        s.status = input_heartbeat_update->getBag()[0]; // Assuming the heartbeat update is ALIVE or TIMEOUT
+        const HeartbeatUpdate& update = input_heartbeat_update->getBag()[0];
+        bool beating = s.status == HeartbeatStatus::UPDATE;
+        s.status = update.status;
+        s.heartbeatInterval = update.heartbeatInterval;
+        s.electionTimeoutMin = update.electionTimeoutMin;
         if (s.status == HeartbeatStatus::ALIVE) {
-            // Set heartbeat timeout 
-            s.heartbeatTimeout = RandomNumberGeneratorDEVS::generateUniformDelay(0.150,0.300);  // Example: Set timeout duration to 5 seconds
-        } else if (s.status == HeartbeatStatus::UPDATE) {
-            // Update in 50ms
-            s.heartbeatTimeout = 0.05;
+            // Same spread as the fixed window, up to twice its lower end
+            s.heartbeatTimeout = RandomNumberGeneratorDEVS::generateUniformDelay(
+                s.electionTimeoutMin, s.electionTimeoutMin * ELECTION_TIMEOUT_MAX / ELECTION_TIMEOUT_MIN);
+        } else if (s.status == HeartbeatStatus::UPDATE && !beating) {
+            // Next heartbeat in one interval, an update while the loop runs only changes the later ones
+            s.heartbeatTimeout = s.heartbeatInterval;
+        } else if (s.heartbeatTimeout != std::numeric_limits<double>::infinity()) {
+            // Keep counting down, the timeout was sampled when the countdown started
+            s.heartbeatTimeout -= e;
         }
     }
 
@@ -69,10 +163,18 @@ public:
         
     }
 
-    // Time advance: Wait for the remaining time before next event
+    // Time advance: Wait for the remaining time before next event, no sampling here
     double timeAdvance(const HeartbeatControllerState& s) const override {
         return s.heartbeatTimeout;  // Return the remaining time until the next timeout
     }
+
+    // Skip formatting when the log filter drops this state
+    std::string logState() const override {
+        if (!LogFilter::WantsState(this, getId())) {
+            return "";
+        }
+        return Atomic<HeartbeatControllerState>::logState();
+    }
 };
 
 #endif
@@ -2,45 +2,35 @@
 #define MESSAGE_PROCESSOR_HPP
 
 #include <cadmium/core/modeling/atomic.hpp>
-#include <queue>
 #include <string>
 #include <iostream>
 #include "../../messages/network/network_message.hpp"
 #include "../../utils/stochastic/random.hpp"
+#include "../../utils/logging/state_delta.hpp"
+#include "../../utils/logging/log_filter.hpp"
+#include "../../utils/metrics/metrics.hpp"
+#include "../../utils/tracing/message_tracer.hpp"
 #include "../../messages/raft/raft_messages.hpp"
+#include "../../utils/queueing/cpu_pool.hpp"
+#include "../../utils/queueing/service_times.hpp"
+#include "../../utils/queueing/delay_line.hpp"
 
 using namespace cadmium;
 
 
 
-struct MessageEvent {
-    public:
-        MessageEvent(std::shared_ptr<RaftMessage> _raft, double _delay, double _dispatchTime) : message(std::move(_raft)), delay(_delay),
-        dispatchTime(_dispatchTime) {}
-        std::shared_ptr<RaftMessage> message;
-        double delay;
-        double dispatchTime;
-
-        // Min check
-        bool operator<(const MessageEvent& b) const {
-            return (this->dispatchTime + this->delay) > (b.dispatchTime + b.delay); 
-        }
-
-};
-
-struct CompareMessageEvent {
-    bool operator()(const std::shared_ptr<MessageEvent>& a, const std::shared_ptr<MessageEvent>& b) const {
-        return *a < *b;  // Dereference shared_ptr to compare PacketEvent objects
-    }
-};
-
 struct MessageProcessorState {
-    std::priority_queue<std::shared_ptr<MessageEvent>, std::vector<std::shared_ptr<MessageEvent>>, CompareMessageEvent> messageQueue;  
+    DelayLine<std::shared_ptr<RaftMessage>> messageQueue;  // Messages being encoded, due when they are sent
     double currentTime = 0;
 
+    template <typename Writer>
+    void describe(Writer& w) const {
+        w.field("queueLength", messageQueue.size());
+        w.field("currentTime", currentTime);
+    }
+
      friend std::ostream& operator<<(std::ostream& os, const MessageProcessorState& s) {
-        os << "MessageState Queue Length: " <<  s.messageQueue.size() << "," <<
-        "Current Time: " << s.currentTime;
+        StateDelta::full(os, "MessageProcessorState", s);
         return os;
     }
 
@@ -55,15 +45,23 @@ public:
     Port<std::shared_ptr<Packet>> out_packet;
     
     // Constructor to initialize the Network model
-    MessageProcessorModel(const std::string& id) : Atomic<MessageProcessorState>(id, {}){
+    MessageProcessorModel(const std::string& id) : Atomic<MessageProcessorState>(id, {}), metricsScope(id) {
         in_raft_message = cadmium::Component::addInPort<std::shared_ptr<RaftMessage>>("input_raft_message");
         out_packet = cadmium::Component::addOutPort<std::shared_ptr<Packet>>("output_packet");
     }
     
 
     void internalTransition(MessageProcessorState& s) const override {
-        if ( !s.messageQueue.empty() ) {
-            s.messageQueue.pop();
+        // The messages output just sent
+        for (const auto& event : s.messageQueue.popDue()) {
+            s.currentTime = std::max(s.currentTime, event.due);
+            if (ProcessorMetrics* m = metrics.get(metricsScope)) {
+                m -> queueWait -> record(s.currentTime - event.since);
+            }
+            if (MessageTracer* tracer = MessageTracer::Active()) {
+                tracer -> span(event.item -> traceId, event.item -> source, getId(), taskToString(event.item -> content -> getType()),
+                               event.since, s.currentTime);
+            }
         }
     }
 
@@ -71,32 +69,60 @@ public:
         s.currentTime += e;
         std::vector<std::shared_ptr<RaftMessage>> raftMessagesIn = in_raft_message -> getBag();
         for (auto raftMessage : raftMessagesIn) {
-            std::shared_ptr<MessageEvent> packetEvent = std::make_shared<MessageEvent>(
-                raftMessage,
-                RandomNumberGeneratorDEVS::generateExponentialDelay(1000000), 
-                s.currentTime
-            );
-            s.messageQueue.push(packetEvent);
+            // Without a CPU every message is encoded in parallel
+            double delay = cpu ? cpu -> submit(s.currentTime, serviceTimes.sample(CpuStage::ENCODE, *raftMessage)) - s.currentTime
+                               : RandomNumberGeneratorDEVS::generateExponentialDelay(1000000);
+            s.messageQueue.push(raftMessage, s.currentTime, s.currentTime + delay);
         }
     }
 
 
-    // Output: forward the current message after the delay
+    // Output: forward every message whose processing delay has passed
     void output(const MessageProcessorState& s) const override {
-        if (!s.messageQueue.empty()) {
+        s.messageQueue.forEachDue([&](const auto& event) {
             std::shared_ptr<Packet> packet = std::make_shared<Packet>(
-                s.messageQueue.top()-> message,
-                s.messageQueue.top()->message->dest,
-                s.messageQueue.top()->message->source
+                event.item,
+                event.item -> dest,
+                event.item -> source
             );
-
-                 out_packet -> addMessage(packet); 
-        }
+            packet -> timestamp = event.due;
+            packet -> traceId = event.item -> traceId;
+            out_packet -> addMessage(packet);
+        });
     }
 
     double timeAdvance(const MessageProcessorState& s) const override {
-        return !s.messageQueue.empty() ? s.messageQueue.top() -> delay : std::numeric_limits<double>::infinity();
+        return s.messageQueue.timeUntilNext(s.currentTime);
+    }
+
+    // Setter function for the node's CPU: encoding then queues for its cores, costing `times`
+    void setCpu(std::shared_ptr<CpuPool> _cpu, const ServiceTimes& times) {
+        cpu = std::move(_cpu);
+        serviceTimes = times;
+    }
+
+    // Setter function for the node this processor belongs to, its metrics become "<id>/message-processor"
+    void setNodeID(const std::string& id) {
+        nodeID = id;
+        metricsScope = id + "/" + getId();
+        metrics.reset();
     }
+
+    // Log only the fields that changed since the previous transition, nothing if the log filter drops it
+    std::string logState() const override {
+        if (!LogFilter::WantsState(this, getId(), nodeID)) {
+            return "";
+        }
+        return stateDelta.log("MessageProcessorState", state);
+    }
+
+private:
+    mutable StateDelta stateDelta;
+    std::shared_ptr<CpuPool> cpu;
+    ServiceTimes serviceTimes;
+    std::string nodeID;
+    std::string metricsScope;
+    mutable MetricsBinding<ProcessorMetrics> metrics;
 };
 
 #endif
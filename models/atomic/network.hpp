@@ -2,29 +2,66 @@
 #define NETWORK_HPP
 
 #include <cadmium/core/modeling/atomic.hpp>
-#include <queue>
 #include <unordered_map>
 #include <string>
 #include <iostream>
+#include <limits>
 #include "../../messages/network/network_message.hpp"
 #include "../../utils/stochastic/random.hpp"
+#include "../../utils/logging/state_delta.hpp"
+#include "../../utils/logging/log_filter.hpp"
+#include "../../utils/metrics/metrics.hpp"
+#include "../../utils/tracing/message_tracer.hpp"
+#include "../../utils/queueing/delay_line.hpp"
 
 using namespace cadmium;
 
 
+// A node cut off from every other node and client between `from` and `until`
+struct Partition {
+    std::string node;
+    double from = 0;
+    double until = std::numeric_limits<double>::infinity();
+};
+
 struct NetworkState {
-    std::priority_queue<std::shared_ptr<PacketEvent>, std::vector<std::shared_ptr<PacketEvent>>, ComparePacketEvent> packetQueue;  
+    DelayLine<std::shared_ptr<Packet>> packetQueue;  // Packets in flight, due when they are delivered
     double currentTime = 0;
     std::vector<std::string> activeNodes;
+    std::vector<std::string> clients;  // Reachable by address only, broadcasts go to activeNodes
+    double latency = 0;  // Fixed part of every packet's delay
+    double jitter = 1e-6;  // Mean of the exponential part
+    double lossRate = 0;  // Share of packets lost in transit
+    std::vector<Partition> partitions;
+
+    template <typename Writer>
+    void describe(Writer& w) const {
+        w.field("queueLength", packetQueue.size());
+        w.field("currentTime", currentTime);
+    }
 
      friend std::ostream& operator<<(std::ostream& os, const NetworkState& s) {
-        os << "NetworkState Queue Length: " <<  s.packetQueue.size() << "," <<
-        "Current Time: " << s.currentTime;
+        StateDelta::full(os, "NetworkState", s);
         return os;
     }
 
 };
 
+// Metrics recorded by the network, scoped "network"
+struct NetworkMetrics {
+    Gauge* inFlight = nullptr;
+    Counter* delivered = nullptr;
+    Counter* dropped = nullptr;  // Packets for a destination the network does not know
+    Counter* lost = nullptr;  // Packets lost to the loss rate or a partition
+
+    NetworkMetrics() = default;
+    NetworkMetrics(MetricsRegistry& registry, const std::string& scope)
+        : inFlight(&registry.gauge(scope, "in_flight")),
+          delivered(&registry.counter(scope, "delivered")),
+          dropped(&registry.counter(scope, "dropped")),
+          lost(&registry.counter(scope, "lost")) {}
+};
+
 // Network Atomic Model
 class NetworkModel : public Atomic<NetworkState> {
 public:
@@ -35,73 +72,142 @@ public:
 
 
     // Constructor to initialize the Network model
-    NetworkModel(const std::string& id, const std::vector<std::string> activeNodes) : Atomic<NetworkState>(id, {}) {
+    NetworkModel(const std::string& id, const std::vector<std::string> activeNodes, const std::vector<std::string>& clients = {})
+    : Atomic<NetworkState>(id, {}), metricsScope(id) {
         state.activeNodes = activeNodes;
-        for ( auto nodeID : activeNodes ) { 
-            input_ports[nodeID] = cadmium::Component::addInPort<std::shared_ptr<Packet>>("input_packet_" + nodeID);
-            output_ports[nodeID] = cadmium::Component::addOutPort<std::shared_ptr<Packet>>("output_packet_" + nodeID);
+        state.clients = clients;
+        for (const auto* addresses : {&activeNodes, &clients}) {
+            for ( auto nodeID : *addresses ) { 
+                input_ports[nodeID] = cadmium::Component::addInPort<std::shared_ptr<Packet>>("input_packet_" + nodeID);
+                output_ports[nodeID] = cadmium::Component::addOutPort<std::shared_ptr<Packet>>("output_packet_" + nodeID);
+            }
         }
     }
 
     void internalTransition(NetworkState& s) const override {
-        if ( !s.packetQueue.empty() ) {
-            s.packetQueue.pop();
+        // The packets output just delivered
+        for (const auto& event : s.packetQueue.popDue()) {
+            s.currentTime = std::max(s.currentTime, event.due);
+            if (MessageTracer* tracer = MessageTracer::Active()) {
+                tracer -> span(event.item -> traceId, getId(), event.item -> destination, "packet",
+                               event.since, s.currentTime, event.item -> destination);
+            }
+            if (NetworkMetrics* m = metrics.get(metricsScope)) {
+                m -> delivered -> add();
+            }
+        }
+        if (NetworkMetrics* m = metrics.get(metricsScope)) {
+            m -> inFlight -> set(s.packetQueue.size());
         }
     }
 
     void externalTransition(NetworkState& s, double e) const override {
         s.currentTime += e;
         // Aggregate Bags
-        for (auto node : s.activeNodes ) { 
-            // Get the bag of incoming packets for this node
-            auto bagAtPort = input_ports.at(node)->getBag(); 
-
-            // Deal with external events
-            for (auto packet : bagAtPort) {
-                if (packet->destination == "*") {
-                    for (auto node : s.activeNodes ) { 
-                        if (node != packet -> source) {
-                        std::shared_ptr<Packet>  packetNew = std::make_shared<Packet>(
-                            packet -> payload,
-                            node, 
-                            packet -> source
-                        );
-
-                        std::shared_ptr<PacketEvent> packetEvent = std::make_shared<PacketEvent>(
-                            packetNew,
-                            RandomNumberGeneratorDEVS::generateExponentialDelay(1000000), 
-                            s.currentTime
-                        );
-
-                        s.packetQueue.push(packetEvent);
+        for (const auto* senders : {&s.activeNodes, &s.clients}) {
+            for (auto node : *senders ) { 
+                // Get the bag of incoming packets for this node
+                auto bagAtPort = input_ports.at(node)->getBag(); 
+
+                // Deal with external events
+                for (auto packet : bagAtPort) {
+                    if (packet->destination == "*") {
+                        for (auto node : s.activeNodes ) { 
+                            if (node != packet -> source) {
+                            std::shared_ptr<Packet>  packetNew = std::make_shared<Packet>(
+                                packet -> payload,
+                                node, 
+                                packet -> source
+                            );
+                            packetNew -> timestamp = packet -> timestamp;
+                            packetNew -> traceId = packet -> traceId;
+
+                            if (!Lost(s, *packetNew)) {
+                                s.packetQueue.push(packetNew, s.currentTime, s.currentTime + Delay(s));
+                            }
+                        }
+                    }
+                    } else if (output_ports.find(packet -> destination) == output_ports.end()) {
+                        // Nowhere to deliver it
+                        if (NetworkMetrics* m = metrics.get(metricsScope)) {
+                            m -> dropped -> add();
+                        }
+                    } else if (!Lost(s, *packet)) {
+                        s.packetQueue.push(packet, s.currentTime, s.currentTime + Delay(s));
                     }
-                }
-                } else {
-                    std::shared_ptr<PacketEvent> packetEvent = std::make_shared<PacketEvent>(
-                        packet,
-                        RandomNumberGeneratorDEVS::generateExponentialDelay(1000000), 
-                        s.currentTime
-                    );
-                    s.packetQueue.push(packetEvent);
                 }
             }
         }
+        if (NetworkMetrics* m = metrics.get(metricsScope)) {
+            m -> inFlight -> set(s.packetQueue.size());
+        }
     }
 
-    // Output: forward the current message after the delay
+    // Output: deliver every packet whose delay has passed, each to its destination's port
     void output(const NetworkState& s) const override {
-        if (!s.packetQueue.empty()) {
-            auto packet = s.packetQueue.top() -> packet;
-            // Analyze the packet, check where it goes
-            // Move it to appropriate port
-            output_ports.at(packet -> destination) -> addMessage(s.packetQueue.top() -> packet); 
+        s.packetQueue.forEachDue([&](const auto& event) {
+            output_ports.at(event.item -> destination) -> addMessage(event.item);
+        });
+    }
+
+    double timeAdvance(const NetworkState& s) const override {
+        // Time left until the earliest packet arrives
+        return s.packetQueue.timeUntilNext(s.currentTime);
+    }
 
+    // Setter function for the one-way delay: `latency` plus an exponential jitter of mean `jitter`.
+    // The default is a mean of 1us, with no fixed part.
+    void setLatency(double latency, double jitter) {
+        state.latency = latency;
+        state.jitter = jitter;
+    }
+
+    // Setter function for the share of packets lost in transit, each packet independently
+    void setLossRate(double lossRate) {
+        state.lossRate = lossRate;
+    }
+
+    // Setter function to cut `node` off between `from` and `until`, packets sent to or by it meanwhile are lost
+    void isolate(const std::string& node, double from, double until = std::numeric_limits<double>::infinity()) {
+        state.partitions.push_back(Partition{node, from, until});
+    }
+
+    // Log only the fields that changed since the previous transition, nothing if the log filter drops it
+    std::string logState() const override {
+        if (!LogFilter::WantsState(this, getId())) {
+            return "";
         }
+        return stateDelta.log("NetworkState", state);
     }
 
-    double timeAdvance(const NetworkState& s) const override {
-        // Return the smallest delay in the event queue
-        return !s.packetQueue.empty() ? s.packetQueue.top() -> delay : std::numeric_limits<double>::infinity();
+private:
+    mutable StateDelta stateDelta;
+    std::string metricsScope;
+    mutable MetricsBinding<NetworkMetrics> metrics;
+
+    double Delay(const NetworkState& s) const {
+        return s.latency + (s.jitter > 0 ? RandomNumberGeneratorDEVS::generateExponentialDelay(1 / s.jitter) : 0);
+    }
+
+    // Whether a packet sent now never arrives. The loss draw is skipped at rate 0 so runs without
+    // loss keep their random sequence.
+    bool Lost(const NetworkState& s, const Packet& packet) const {
+        bool lost = false;
+        for (const auto& partition : s.partitions) {
+            if ((packet.source == partition.node || packet.destination == partition.node)
+                && s.currentTime >= partition.from && s.currentTime < partition.until) {
+                lost = true;
+            }
+        }
+        if (!lost && s.lossRate > 0) {
+            lost = RandomNumberGeneratorDEVS::generateUniformDelay(0, 1) < s.lossRate;
+        }
+        if (lost) {
+            if (NetworkMetrics* m = metrics.get(metricsScope)) {
+                m -> lost -> add();
+            }
+        }
+        return lost;
     }
 };
 
@@ -2,23 +2,37 @@
 #define PACKET_PROCESSOR_HPP
 
 #include <cadmium/core/modeling/atomic.hpp>
-#include <queue>
 #include <string>
 #include <iostream>
 #include "../../messages/network/network_message.hpp"
+#include "../../messages/network/flow_control.hpp"
 #include "../../utils/stochastic/random.hpp"
+#include "../../utils/logging/state_delta.hpp"
+#include "../../utils/logging/log_filter.hpp"
+#include "../../utils/metrics/metrics.hpp"
+#include "../../utils/tracing/message_tracer.hpp"
 #include "../../messages/raft/raft_messages.hpp"
+#include "../../utils/queueing/cpu_pool.hpp"
+#include "../../utils/queueing/service_times.hpp"
+#include "../../utils/queueing/delay_line.hpp"
 
 using namespace cadmium;
 
 
 struct PacketProcessorState {
-    std::priority_queue<std::shared_ptr<PacketEvent>, std::vector<std::shared_ptr<PacketEvent>>, ComparePacketEvent> packetQueue;  
+    DelayLine<std::shared_ptr<Packet>> packetQueue;  // Packets being decoded, due when they are forwarded
     double currentTime = 0;
+    bool paused = false;  // The buffer downstream is full, hold packets until it drains
+
+    template <typename Writer>
+    void describe(Writer& w) const {
+        w.field("queueLength", packetQueue.size());
+        w.field("currentTime", currentTime);
+        w.field("paused", paused);
+    }
 
      friend std::ostream& operator<<(std::ostream& os, const PacketProcessorState& s) {
-        os << "NetworkState Queue Length: " <<  s.packetQueue.size() << "," <<
-        "Current Time: " << s.currentTime;
+        StateDelta::full(os, "PacketProcessorState", s);
         return os;
     }
 
@@ -30,17 +44,29 @@ class PacketProcessorModel : public Atomic<PacketProcessorState> {
 public:
 
     Port<std::shared_ptr<Packet>> input_packet;
+    Port<FlowControl> input_backpressure;  // From the buffer downstream, STOP pauses forwarding until RESUME
     Port<std::shared_ptr<RaftMessage>> output_raft_message; 
 
     // Constructor to initialize the Network model
-    PacketProcessorModel(const std::string& id) : Atomic<PacketProcessorState>(id, {}){
+    PacketProcessorModel(const std::string& id) : Atomic<PacketProcessorState>(id, {}), metricsScope(id) {
         input_packet = cadmium::Component::addInPort<std::shared_ptr<Packet>>("input_packet");
+        input_backpressure = cadmium::Component::addInPort<FlowControl>("input_backpressure");
         output_raft_message = cadmium::Component::addOutPort<std::shared_ptr<RaftMessage>>("output_raft_message");
     }
 
     void internalTransition(PacketProcessorState& s) const override {
-        if ( !s.packetQueue.empty() ) {
-            s.packetQueue.pop();
+        // The packets output just forwarded, overdue ones too if a pause just lifted
+        if (!s.packetQueue.empty()) {
+            s.currentTime = std::max(s.currentTime, s.packetQueue.nextDue());
+        }
+        for (const auto& event : s.packetQueue.popDue(s.currentTime)) {
+            if (ProcessorMetrics* m = metrics.get(metricsScope)) {
+                m -> queueWait -> record(s.currentTime - event.since);
+            }
+            if (MessageTracer* tracer = MessageTracer::Active()) {
+                tracer -> span(event.item -> traceId, event.item -> destination, getId(), "packet",
+                               event.since, s.currentTime, event.item -> destination);
+            }
         }
     }
 
@@ -48,20 +74,24 @@ public:
         s.currentTime += e;
         std::vector<std::shared_ptr<Packet>> packetListIn = input_packet -> getBag();
         for (auto packet : packetListIn) {
-            std::shared_ptr<PacketEvent> packetEvent = std::make_shared<PacketEvent>(
-                packet,
-                RandomNumberGeneratorDEVS::generateExponentialDelay(1000000), 
-                s.currentTime
-            );
-            s.packetQueue.push(packetEvent);
+            // Without a CPU every packet is decoded in parallel
+            double delay = RandomNumberGeneratorDEVS::generateExponentialDelay(1000000);
+            if (cpu && packet -> payload -> getType() == PacketPayloadType::RAFT) {
+                const RaftMessage& message = *std::static_pointer_cast<RaftMessage>(packet -> payload);
+                delay = cpu -> submit(s.currentTime, serviceTimes.sample(CpuStage::DECODE, message)) - s.currentTime;
+            }
+            s.packetQueue.push(packet, s.currentTime, s.currentTime + delay);
+        }
+        for (FlowControl signal : input_backpressure -> getBag()) {
+            s.paused = (signal == FlowControl::STOP);
         }
     }
 
 
-    // Output: forward the current message after the delay
+    // Output: forward every message whose delay has passed
     void output(const PacketProcessorState& s) const override {
-        if (!s.packetQueue.empty()) {
-            auto message = s.packetQueue.top() -> packet -> payload;
+        s.packetQueue.forEachDue([&](const auto& event) {
+            auto message = event.item -> payload;
             switch (message -> getType()) {
                 case PacketPayloadType::RAFT:
                     output_raft_message -> addMessage(std::static_pointer_cast<RaftMessage>(message)); 
@@ -69,12 +99,41 @@ public:
                 default:
                     break;
                 }
-        }
+        }, s.currentTime);
     }
 
     double timeAdvance(const PacketProcessorState& s) const override {
-        return !s.packetQueue.empty() ? s.packetQueue.top() -> delay : std::numeric_limits<double>::infinity();
+        return s.paused ? std::numeric_limits<double>::infinity() : s.packetQueue.timeUntilNext(s.currentTime);
     }
+
+    // Setter function for the node's CPU: decoding then queues for its cores, costing `times`
+    void setCpu(std::shared_ptr<CpuPool> _cpu, const ServiceTimes& times) {
+        cpu = std::move(_cpu);
+        serviceTimes = times;
+    }
+
+    // Setter function for the node this processor belongs to, its metrics become "<id>/packet-processor"
+    void setNodeID(const std::string& id) {
+        nodeID = id;
+        metricsScope = id + "/" + getId();
+        metrics.reset();
+    }
+
+    // Log only the fields that changed since the previous transition, nothing if the log filter drops it
+    std::string logState() const override {
+        if (!LogFilter::WantsState(this, getId(), nodeID)) {
+            return "";
+        }
+        return stateDelta.log("PacketProcessorState", state);
+    }
+
+private:
+    mutable StateDelta stateDelta;
+    std::shared_ptr<CpuPool> cpu;
+    ServiceTimes serviceTimes;
+    std::string nodeID;
+    std::string metricsScope;
+    mutable MetricsBinding<ProcessorMetrics> metrics;
 };
 
 #endif
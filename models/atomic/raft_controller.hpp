@@ -7,14 +7,53 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <map>
+#include "heartbeat_controller.hpp"
 #include "../../utils/cryptography/crypto.hpp"
+#include "../../utils/cryptography/merkle_log_index.hpp"
 #include "../../messages/database/database_messages.hpp"
 #include "../../utils/stochastic/random.hpp"
+#include "../../utils/logging/state_delta.hpp"
+#include "../../utils/logging/log_filter.hpp"
+#include "../../utils/logging/diagnostics.hpp"
+#include "../../utils/metrics/metrics.hpp"
+#include "../../utils/tracing/message_tracer.hpp"
 
 using namespace cadmium;
 
 enum class RaftStatus { FOLLOWER, CANDIDATE, LEADER };
 enum class VoteStatus { VOTE_NOT_YET_SUBMITTED, VOTE_SUBMITTED };
+// NONE: placeholder signatures, RSA: every message signed, HMAC: pairwise MACs with RSA kept for votes
+enum class AuthMode { NONE, RSA, HMAC };
+// LOG: reads are replicated and applied like writes. READ_INDEX: the leader records its commit index,
+// confirms it still leads with one round of AppendEntries and answers once applied up to that index.
+// LEASE: as READ_INDEX, but no round is needed while a majority acknowledged the leader recently enough
+// that no other node can have been elected.
+enum class ReadMode { LOG, READ_INDEX, LEASE };
+// OFF: followers redirect reads to the leader. READ_INDEX: a follower asks the leader for a read index,
+// which the leader confirms as it does its own reads, and answers once applied up to it. BOUNDED_STALE:
+// a follower answers from its own state while it trails the leader by little enough, else as READ_INDEX.
+enum class FollowerReadMode { OFF, READ_INDEX, BOUNDED_STALE };
+
+// A read held until leadership is confirmed and the state machine has caught up
+struct PendingRead {
+    std::string client;  // The client, or for a forwarded read the follower that asked
+    uint64_t requestID = 0;  // The client's request, or for a forwarded read the follower's batch
+    int readIndex = 0;  // Served once lastApplied reaches it, -1 while a follower waits for the leader's
+    uint64_t round = 0;  // Broadcast round a majority must acknowledge first, 0 when covered by the lease
+    uint64_t batch = 0;  // Follower only: the read-index request the read waits on, 0 on the leader
+    bool forwarded = false;  // Leader only: a follower's read-index request, answered with the index alone
+};
+
+// The leader's last resend of a lagging peer's missing entries
+struct CatchUp {
+    uint64_t round = 0;  // Round current when it was sent
+    int from = -1;  // Index the peer asked to resend from
+    double sentAt = 0;
+};
 
 
 // Define the output stream operator for RaftStatus
@@ -54,63 +93,137 @@ struct RaftState {
     int commitIndex = 0;  // The index of the highest log entry known to be committed
     int lastApplied = 0;  // The index of the last applied entry (to the state machine)
     double currentTime = 0.0;  // Current time (used for heartbeat and election timeouts)
+    AuthMode authMode = AuthMode::NONE;  // How messages between nodes are authenticated
     std::string privateKey;  // Node's private key for signing messages
-    std::vector<std::string> publicKeys;  // List of public keys of other nodes for signature verification
+    std::vector<std::string> publicKeys;  // List of public keys of other nodes for signature verification, in clusterMembers order
+    std::unordered_map<std::string, std::string> pairwiseKeys;  // Pre-shared HMAC keys, by peer ID
     std::vector<std::shared_ptr<IMessage<LogEntryType>>> messageLog; // Log of responses from other nodes
+    std::vector<std::string> logDigests;  // Running SHA-256 chain digest of messageLog, one per entry
+    MerkleLogIndex merkleIndex;  // Subtree hashes over messageLog segments, used to resync diverged logs
     std::vector<std::shared_ptr<ResponseVote>> tempMessageStorage; 
     std::vector<std::shared_ptr<DatabaseMessage>> databaseOutMessages;  // Outgoing database messages (e.g., queries or inserts)
     std::vector<std::shared_ptr<RaftMessage>> raftOutMessages;  // Outgoing Raft messages (e.g., AppendEntries)
     std::vector<std::string> peers;  // Total number of peers in the cluster (including this node)
+    std::vector<std::string> clusterMembers;  // Sorted peers + this node, a member's position is its voter bit
     int logIndex = 0;  // Current index of the last log entry
     int electionTimeout = 0;  // Timeout for triggering a new election
     double lastHeartbeatUpdate = 0 ;
     std::string nodeID;
     std::string leaderID;
     std::shared_ptr<RequestVote> leaderProof;
+    double electionStartTime = 0;  // When this node last became a candidate
+    double electedAt = 0;  // When this node last won an election
+    double sigma = std::numeric_limits<double>::infinity();  // Time left until raftOutMessages are sent
+    std::unordered_map<std::string, int> matchIndex;  // Leader only: highest log index known to be replicated on each peer
+    ReadMode readMode = ReadMode::LOG;  // How the leader serves client reads
+    double maxClockDrift = 0.01;  // LEASE: bound on how much faster a node's clock may run, as a fraction
+    int termStartIndex = 0;  // Leader only: the entry that began its term, reads wait until it is applied
+    uint64_t round = 0;  // Leader only: last AppendEntries broadcast, numbered
+    uint64_t confirmedRound = 0;  // Leader only: latest round acknowledged by a majority
+    std::map<uint64_t, double> roundSentAt;  // Leader only: send times of the rounds not yet confirmed
+    std::unordered_map<std::string, uint64_t> peerRound;  // Leader only: latest round each peer acknowledged
+    std::unordered_map<std::string, CatchUp> catchUps;  // Leader only: each peer's last catch-up
+    double leaseExpiry = 0;  // Leader only: no other leader can be elected before this time
+    std::vector<PendingRead> pendingReads;  // Held by the leader, or by a follower serving reads itself
+    FollowerReadMode followerReads = FollowerReadMode::OFF;  // How a follower serves client reads
+    int maxReadLag = 0;  // BOUNDED_STALE: entries lastApplied may trail the leader's announced commit index by
+    double maxReadStaleness = 2 * HEARTBEAT_INTERVAL;  // BOUNDED_STALE: longest the leader may have been silent
+    int leaderCommit = 0;  // Follower only: highest commit index a leader has announced
+    uint64_t readBatch = 0;  // Follower only: last read-index request sent
+    double readBatchSentAt = 0;  // Follower only: when it was sent
+    std::string votedFor;  // Candidate voted for in currentTerm, empty if none
+    bool preVote = false;  // Ask a majority whether they would vote before starting an election
+    int preVoteTerm = 0;  // Term the pre-vote in progress proposes, 0 when none is
+    std::vector<std::string> preVotesGranted;  // Nodes that would vote in preVoteTerm
+    double leaderlessSince = 0;  // When leaderID last became empty
+    double leaderlessTime = 0;  // Time spent without a known leader, the current stretch excluded
+    ElectionTimers timers;  // Round-trip estimate, measured while leading or adopted from the leader
+
+    // Time without a known leader up to `now`
+    double leaderlessTimeAt(double now) const {
+        return leaderlessTime + (leaderID.empty() ? now - leaderlessSince : 0);
+    }
     
 
+    // Fields written to the simulation log, keys are summarized and never printed
+    template <typename Writer>
+    void describe(Writer& w) const {
+        w.field("state", state);
+        w.field("currentTerm", currentTerm);
+        w.field("votedStatus", votedStatus);
+        w.field("commitIndex", commitIndex);
+        w.field("lastApplied", lastApplied);
+        w.field("currentTime", currentTime);
+        w.field("leaderID", leaderID);
+        w.field("hasPrivateKey", !privateKey.empty());
+        w.field("publicKeys", publicKeys.size());
+        w.field("numOfPeers", peers.size());
+        w.field("logIndex", logIndex);
+        w.field("pendingReads", pendingReads.size());
+    }
+
     friend std::ostream& operator<<(std::ostream& os, const RaftState& state) {
-        os << "RaftState { "
-           << "state: " << state.state << ", "
-           << "currentTerm: " << state.currentTerm << ", "
-           << "votedStatus: " << state.votedStatus << ", "
-           << "commitIndex: " << state.commitIndex << ", "
-           << "currentTime: " << state.currentTime << ", "
-           << "privateKey: \"" << state.privateKey << "\", "
-           << "publicKeys: [";
-        
-        for (size_t i = 0; i < state.publicKeys.size(); ++i) {
-            os << "\"" << state.publicKeys[i] << "\"";
-            if (i < state.publicKeys.size() - 1) os << ", ";
-        }
-    
-        os << "], "
-           << "numOfPeers: " << state.peers.size() << ", "
-           << "logIndex: " << state.logIndex
-           << " }";
-        
+        StateDelta::full(os, "RaftState", state);
         return os;
     }
 };
 
 
 
+// Metrics recorded by each raft controller, scoped "<node>/raft-controller"
+struct RaftMetrics {
+    Counter* electionsStarted = nullptr;
+    Counter* electionsWon = nullptr;
+    Counter* entriesAppended = nullptr;
+    Counter* entriesCommitted = nullptr;
+    Gauge* term = nullptr;
+    Histogram* electionDuration = nullptr;  // From becoming a candidate to winning, in seconds
+    Counter* readsServed = nullptr;  // Reads answered without a log entry
+    Counter* leaseReads = nullptr;  // Of those, reads that needed no round
+    Counter* staleReads = nullptr;  // Of those, follower reads answered without asking the leader
+    Counter* readIndexesServed = nullptr;  // Read-index requests answered for followers
+    Counter* preVotesStarted = nullptr;
+    Counter* stepDowns = nullptr;  // Leaders and candidates that saw a higher term or another leader
+    Histogram* leaderlessDuration = nullptr;  // From losing a leader to knowing the next, in seconds
+    Gauge* smoothedRtt = nullptr;  // AppendEntries round trips, measured by the leader and passed on, in microseconds
+    Gauge* electionTimeout = nullptr;  // Lower end of the election window in use, in microseconds
+
+    RaftMetrics() = default;
+    RaftMetrics(MetricsRegistry& registry, const std::string& scope)
+        : electionsStarted(&registry.counter(scope, "elections_started")),
+          electionsWon(&registry.counter(scope, "elections_won")),
+          entriesAppended(&registry.counter(scope, "entries_appended")),
+          entriesCommitted(&registry.counter(scope, "entries_committed")),
+          term(&registry.gauge(scope, "term")),
+          electionDuration(&registry.histogram(scope, "election_duration")),
+          readsServed(&registry.counter(scope, "reads_served")),
+          leaseReads(&registry.counter(scope, "lease_reads")),
+          staleReads(&registry.counter(scope, "stale_reads")),
+          readIndexesServed(&registry.counter(scope, "read_indexes_served")),
+          preVotesStarted(&registry.counter(scope, "pre_votes_started")),
+          stepDowns(&registry.counter(scope, "step_downs")),
+          leaderlessDuration(&registry.histogram(scope, "leaderless_duration")),
+          smoothedRtt(&registry.gauge(scope, "smoothed_rtt_us")),
+          electionTimeout(&registry.gauge(scope, "election_timeout_us")) {}
+};
+
+
 class RaftControllerModel : public Atomic<RaftState> {
 public:
     Port<std::shared_ptr<RaftMessage>> input_buffer;
     Port<std::shared_ptr<DatabaseMessage>> output_database;
     Port<std::shared_ptr<RaftMessage>> output_external;
-    Port<HeartbeatStatus> output_heartbeat;
+    Port<HeartbeatUpdate> output_heartbeat;
     Port<HeartbeatStatus> input_heartbeat;
 
 
     RaftControllerModel(const std::string& id)
-    : Atomic<RaftState>(id, {}) {
+    : Atomic<RaftState>(id, {}), metricsScope(id) {
         input_buffer = addInPort<std::shared_ptr<RaftMessage>>("input_buffer");
         input_heartbeat = addInPort<HeartbeatStatus>("input_heartbeat");
         output_database = addOutPort<std::shared_ptr<DatabaseMessage>>("output_database");
         output_external = addOutPort<std::shared_ptr<RaftMessage>>("output_external");
-        output_heartbeat = addOutPort<HeartbeatStatus>("output_heartbeat");
+        output_heartbeat = addOutPort<HeartbeatUpdate>("output_heartbeat");
         // output_heartbeat -> addMessage(HeartbeatStatus::ALIVE);
     }
 
@@ -134,8 +247,32 @@ public:
         return RandomNumberGeneratorDEVS::generateExponentialDelay(lambda);
     }
 
+    // Processing delay of one outgoing message, sampled once when the message is created
+    double serviceTime(const std::shared_ptr<RaftMessage>& msg) const {
+        switch (msg -> content -> getType()) {
+            case Task::APPEND_ENTRIES:
+                return processAppendEntries(msg);
+            case Task::VOTE_REQUEST:
+            case Task::PRE_VOTE_REQUEST:
+                return processVoteRequest();
+            case Task::VOTE_RESPONSE:
+            case Task::PRE_VOTE_RESPONSE:
+            // Acknowledgements, client answers and read indexes cost what a vote response does
+            case Task::APPEND_ENTRIES_RESPONSE:
+            case Task::CLIENT_RESPONSE:
+            case Task::READ_INDEX_REQUEST:
+            case Task::READ_INDEX_RESPONSE:
+                return processResponseVote();
+            default:
+                return 0;
+        }
+    }
+
 
     void internalTransition(RaftState& s) const override { 
+        // Update time
+        s.currentTime += s.sigma;
+        s.sigma = std::numeric_limits<double>::infinity();
         s.heartbeatStatus = HeartbeatStatus::ALIVE;
         // Flush message vectors
         s.databaseOutMessages.clear();
@@ -146,9 +283,21 @@ public:
     void externalTransition(RaftState& s, double e) const override {
         // Update time
         s.currentTime += e;
+        // Work still owed on messages queued earlier, new messages add theirs below
+        double remaining = s.sigma == std::numeric_limits<double>::infinity() ? 0 : s.sigma - e;
+        size_t pending = s.raftOutMessages.size();
 
         std::vector<std::shared_ptr<RaftMessage>> msgs_buffer = input_buffer -> getBag();
+        std::vector<std::shared_ptr<IMessage<LogEntryType>>> clientEntries;  // Commands accepted by this leader, replicated together
         for (auto& msgRaft : msgs_buffer) {
+                // Arrival ends this copy's trace
+                if (MessageTracer* tracer = MessageTracer::Active()) {
+                    tracer -> instant(msgRaft -> traceId, s.nodeID, getId(), "receive " + taskToString(msgRaft -> content -> getType()), s.currentTime, s.nodeID);
+                }
+                // Drop anything that fails channel authentication
+                if (!VerifyAuthenticity(s, msgRaft)) {
+                    continue;
+                }
                 switch (msgRaft -> content -> getType())
                 {
                 case Task::VOTE_REQUEST:
@@ -160,11 +309,33 @@ public:
                 case Task::APPEND_ENTRIES:
                     HandleAppendEntries(s, std::static_pointer_cast<AppendEntries>(msgRaft -> content));
                     break;
+                case Task::APPEND_ENTRIES_RESPONSE:
+                    HandleAppendEntriesResponse(s, std::static_pointer_cast<AppendEntriesResponse>(msgRaft -> content));
+                    break;
+                case Task::CLIENT_REQUEST:
+                    HandleClientRequest(s, std::static_pointer_cast<ClientRequest>(msgRaft -> content), msgRaft -> source, clientEntries);
+                    break;
+                case Task::READ_INDEX_REQUEST:
+                    HandleReadIndexRequest(s, std::static_pointer_cast<ReadIndexRequest>(msgRaft -> content));
+                    break;
+                case Task::READ_INDEX_RESPONSE:
+                    HandleReadIndexResponse(s, std::static_pointer_cast<ReadIndexResponse>(msgRaft -> content));
+                    break;
+                case Task::PRE_VOTE_REQUEST:
+                    HandlePreVoteRequest(s, std::static_pointer_cast<PreVoteRequest>(msgRaft -> content), msgRaft -> source);
+                    break;
+                case Task::PRE_VOTE_RESPONSE:
+                    HandlePreVoteResponse(s, std::static_pointer_cast<PreVoteResponse>(msgRaft -> content));
+                    break;
                 default:
                     break;
                 }
             } 
 
+            if (!clientEntries.empty()) {
+                SendAppendEntries(s, clientEntries);
+            }
+
 
             // Check for HeartbeatEvents 
             HeartbeatStatus heartbeatStatus = input_heartbeat -> getBag().size() > 0 ? input_heartbeat -> getBag()[0] : HeartbeatStatus::ALIVE  ;
@@ -172,6 +343,18 @@ public:
             
             // Check if we should transition to leader
             CheckAndTransitionToLeader(s);
+
+            // Answer the reads that became safe, start a round or a read-index request for the ones waiting on one
+            ServeReads(s);
+
+            // Sample the processing time of the new messages
+            for (size_t i = pending; i < s.raftOutMessages.size(); i++) {
+                remaining += serviceTime(s.raftOutMessages[i]);
+            }
+            // Messages that cost nothing to process, such as an empty round, still have to leave, and so
+            // does a timer restart
+            bool pendingOutput = !s.raftOutMessages.empty() || s.heartbeatStatus != HeartbeatStatus::ALIVE;
+            s.sigma = (remaining > 0 || pendingOutput) ? std::max(remaining, 0.0) : std::numeric_limits<double>::infinity();
     }
     
 
@@ -188,46 +371,44 @@ public:
         }
 
         if (s.heartbeatStatus == HeartbeatStatus::UPDATE) {
-            output_heartbeat -> addMessage(HeartbeatStatus::UPDATE);
+            output_heartbeat -> addMessage(HeartbeatUpdate{HeartbeatStatus::UPDATE, s.timers.heartbeatInterval(), s.timers.electionTimeoutMin()});
         }
 
         if (s.heartbeatStatus == HeartbeatStatus::TIMEOUT) {
-            output_heartbeat -> addMessage(HeartbeatStatus::ALIVE);
+            output_heartbeat -> addMessage(HeartbeatUpdate{HeartbeatStatus::ALIVE, s.timers.heartbeatInterval(), s.timers.electionTimeoutMin()});
         } 
     }
 
 
     double timeAdvance(const RaftState& s) const override {
-        double totalProcessingTime = 0;  // Initialize the total processing time accumulator
-    
-        // Loop through raftOutMessages queue and calculate delays based on message types
-        for (auto& msg : s.raftOutMessages) {
-            switch (msg -> content -> getType()) {
-                case Task::APPEND_ENTRIES:
-                    totalProcessingTime += processAppendEntries(msg);
-                    break;
-                case Task::VOTE_REQUEST:
-                    totalProcessingTime += processVoteRequest();
-                    break;
-                case Task::VOTE_RESPONSE:
-                    totalProcessingTime += processResponseVote();
-                    break;
-                default:
-                    break;
-            }
-        }
-        
-        return totalProcessingTime == 0 ? std::numeric_limits<double>::infinity() : totalProcessingTime ;
+        return s.sigma;
     }
 
 
 
 void HandleRequest(RaftState& s, std::shared_ptr<RequestVote> requestMessage, std::string source) const {
-    bool largerThanCurrentTerm = (requestMessage -> metadata.termNumber > s.currentTerm);
-    bool equalButNotVoted = (requestMessage -> metadata.termNumber == s.currentTerm) && (s.votedStatus == VoteStatus::VOTE_NOT_YET_SUBMITTED);
+    const RequestMetadata& request = requestMessage -> metadata;
+
+    // Lease reads rely on no vote being granted while the current leader is still heard from
+    bool leaderRecentlyHeard = s.readMode == ReadMode::LEASE && !s.leaderID.empty() && s.leaderID != request.candidateID
+                               && s.currentTime - s.lastHeartbeatUpdate < s.timers.leaseTimeout();
+
+    // A higher term ends ours, whoever we were following or leading
+    if (request.termNumber > s.currentTerm && !leaderRecentlyHeard) {
+        AdoptTerm(s, request.termNumber);
+    }
+
+    // One vote per term, and only for a candidate whose log is at least as long as ours. Entries carry no
+    // term, so length stands in for Raft's up-to-date check: an entry on a majority keeps out shorter logs.
+    bool notYetVoted = s.votedStatus == VoteStatus::VOTE_NOT_YET_SUBMITTED || s.votedFor == request.candidateID;
+    bool upToDate = request.lastLogIndex >= static_cast<int>(s.messageLog.size()) - 1;
+    bool voteGranted = request.termNumber == s.currentTerm && notYetVoted && upToDate && !leaderRecentlyHeard;
+    if (voteGranted) {
+        s.votedStatus = VoteStatus::VOTE_SUBMITTED;
+        s.votedFor = request.candidateID;
+    }
 
     ResponseMetadata responseMetadata;
-    bool voteGranted = largerThanCurrentTerm || equalButNotVoted;
 
     responseMetadata = {
         requestMessage -> metadata.termNumber,
@@ -237,93 +418,569 @@ void HandleRequest(RaftState& s, std::shared_ptr<RequestVote> requestMessage, st
         s.nodeID
     };
 
-    // // Hash + Sign it
-    // std::string msgDigestSigned = Crypto::SignData(responseMetadata.toString(), s.privateKey);
+    // Hash + Sign it, votes end up in the quorum certificate so they stay transferable
+    std::string msgDigestSigned = SignMetadata(s, responseMetadata.toString(), true);
     
     // Append to response
-    std::shared_ptr<ResponseVote> response = std::make_shared<ResponseVote>(responseMetadata, "msgDigestSigned");
+    std::shared_ptr<ResponseVote> response = std::make_shared<ResponseVote>(responseMetadata, msgDigestSigned);
 
     // Create Raft Message
     std::shared_ptr<RaftMessage> raftMessage =  std::make_shared<RaftMessage>(response);
     // Return to Requestor
     raftMessage -> dest = source;
     raftMessage -> source = s.nodeID;
+    AttachMacs(s, raftMessage);
+    TraceSend(s, raftMessage);
     // Push to output message queue
     s.raftOutMessages.emplace_back(raftMessage);
 }
 
     void HandleResponse(RaftState& s, std::shared_ptr<ResponseVote> responseMessage) const {
-        // Checks if response is a valid. 
-        if (responseMessage -> metadata.voteGranted == true) {
+        // Checks if response is a valid, votes from an earlier election do not count
+        if (responseMessage -> metadata.voteGranted == true && responseMessage -> metadata.termNumber == s.currentTerm) {
             s.tempMessageStorage.emplace_back(responseMessage);
         } 
     };
 
     void HandleAppendEntries(RaftState& s, std::shared_ptr<AppendEntries> appendEntriesMessage) const {
+        const AppendEntriesMetadata& metadata = appendEntriesMessage -> metadata;
         // Ignore stale terms (leader must have a higher term)
-        if (appendEntriesMessage -> metadata.term < s.currentTerm) {
+        if (metadata.term < s.currentTerm) {
+            return;
+        }
+        // A leader of a later term exists, a stale leader or candidate steps down at once. Followers
+        // take the term from the leader's RAFT entry.
+        if (metadata.term > s.currentTerm && s.state != RaftStatus::FOLLOWER) {
+            AdoptTerm(s, metadata.term);
+        }
+
+        // Log matching: one digest comparison covers the whole prefix up to prevLogIndex
+        if (!MatchesLogPrefix(s, metadata.prevLogIndex, metadata.prevLogDigest)) {
+            // Still hearing from our leader, only the logs disagree
+            if (s.leaderID == metadata.leaderID) {
+                s.lastHeartbeatUpdate = s.currentTime;
+            }
+            // The leader retries from the last index that could still match. Our own suffix, or one
+            // written under another leader, may diverge anywhere past the commit index.
+            int retryFrom = std::min(metadata.prevLogIndex, static_cast<int>(s.messageLog.size())) - 1;
+            if (s.leaderID != metadata.leaderID || metadata.prevLogIndex < static_cast<int>(s.messageLog.size())) {
+                retryFrom = std::min(retryFrom, s.commitIndex);
+            }
+            SendAppendEntriesResponse(s, metadata, false, retryFrom, 0);
             return;
         }
     
+        // Hash the whole batch up front, the digests serve both the duplicate check and the append
+        std::vector<std::string> entryDigests = EntryDigests(metadata.entries);
+
         // Loop through the entries
-        for (auto& logEntry : appendEntriesMessage -> metadata.entries) {
+        int index = metadata.prevLogIndex + 1;
+        int appended = 0;
+        for (size_t i = 0; i < metadata.entries.size(); i++) {
+            const auto& logEntry = metadata.entries[i];
+            const std::string& entryDigest = entryDigests[i];
+            // Entry already in our log (same chain digest), nothing to do
+            if (index < static_cast<int>(s.messageLog.size())) {
+                if (Crypto::LinkDigest(LogDigestAt(s, index - 1), entryDigest) == s.logDigests[index]) {
+                    index++;
+                    continue;
+                }
+                // Conflicting suffix, drop it before appending the leader's entries
+                TruncateLog(s, index);
+            }
+
+            bool accepted = false;
             // Update leader information if the term is valid
             switch (logEntry -> getType()) {
                 case LogEntryType::RAFT:
-                    HandleRAFTEntry(s, std::static_pointer_cast<LogEntryRAFT>(logEntry), appendEntriesMessage -> metadata.leaderID);
+                    accepted = HandleRAFTEntry(s, std::static_pointer_cast<LogEntryRAFT>(logEntry), metadata.leaderID, entryDigest);
                     break;
     
                 case LogEntryType::HEARTBEAT:
                     // Verify leader is valid and update log with heartbeat metadata
-                    HandleHeartbeatEntry(s, std::static_pointer_cast<LogEntryHeartbeat>(logEntry), appendEntriesMessage -> metadata.leaderID);
+                    accepted = HandleHeartbeatEntry(s, std::static_pointer_cast<LogEntryHeartbeat>(logEntry), metadata.leaderID, entryDigest);
                     break;
     
                 case LogEntryType::EXTERNAL:
-                    // Ignore for now, logic added later
+                    // No handling yet, but keep it so the chain matches the leader's
+                    AppendLogEntry(s, logEntry, entryDigest);
+                    accepted = true;
                     break;
     
                 default:
                     // Handle unrecognized log entry types (can log or take further action if needed)
                     break;
             }
+
+            // Later entries would chain onto a gap
+            if (!accepted) {
+                break;
+            }
+            appended++;
+            index++;
+        }
+
+        // Any AppendEntries from our leader holds off an election, leases count on it
+        if (s.leaderID == metadata.leaderID) {
+            s.lastHeartbeatUpdate = s.currentTime;
+            s.leaderCommit = std::max(s.leaderCommit, metadata.leaderCommit);
+            if (metadata.rtt > 0) {
+                s.timers.assume(metadata.rtt, metadata.rttVar);
+                RecordTimers(s);
+            }
+        }
+
+        // Everything up to the last entry handled matches the leader's log
+        int matchIndex = index - 1;
+        SendAppendEntriesResponse(s, metadata, true, matchIndex, appended);
+
+        // Update commit index, a reordered older AppendEntries never moves it back
+        AdvanceCommitIndex(s, std::min(metadata.leaderCommit, matchIndex));
+    }
+
+    // Leader: count the peer's progress towards committing, or resend what it is missing
+    void HandleAppendEntriesResponse(RaftState& s, std::shared_ptr<AppendEntriesResponse> responseMessage) const {
+        const AppendEntriesResponseMetadata& metadata = responseMessage -> metadata;
+        if (s.state != RaftStatus::LEADER || metadata.term != s.currentTerm) {
+            return;
+        }
+        if (metadata.sentAt > 0) {
+            s.timers.observe(s.currentTime - metadata.sentAt);
+            RecordTimers(s);
+            // Pass the new interval on to the heartbeat loop
+            if (s.timers.adapting()) {
+                s.heartbeatStatus = HeartbeatStatus::UPDATE;
+            }
+        }
+        // Success or not, the peer still follows us as of that round
+        if (metadata.round > 0) {
+            uint64_t& acknowledged = s.peerRound[metadata.nodeId];
+            acknowledged = std::max(acknowledged, metadata.round);
+            ConfirmRounds(s);
+        }
+        if (!metadata.success) {
+            // Reordered AppendEntries each fail on their own, the first catch-up already covers them. A
+            // peer that does not follow us yet leaves the round out, its failures are covered while the
+            // last catch-up resent at least what they ask for and cannot have been lost yet.
+            auto caughtUp = s.catchUps.find(metadata.nodeId);
+            if (caughtUp != s.catchUps.end()) {
+                const CatchUp& last = caughtUp -> second;
+                bool covered = metadata.round != 0
+                    ? metadata.round <= last.round
+                    : metadata.matchIndex >= last.from && s.currentTime - last.sentAt < s.timers.electionTimeoutMin();
+                if (covered) {
+                    return;
+                }
+            }
+            s.catchUps[metadata.nodeId] = CatchUp{s.round, metadata.matchIndex, s.currentTime};
+            SendCatchUp(s, metadata.nodeId, metadata.matchIndex);
+            return;
         }
+        auto match = s.matchIndex.find(metadata.nodeId);
+        if (match == s.matchIndex.end() || match -> second < metadata.matchIndex) {
+            s.matchIndex[metadata.nodeId] = metadata.matchIndex;
+        }
+
+        // Highest index held by a majority, the leader's own log included. As in Raft, only an entry of
+        // the leader's own term is committed by counting, earlier ones follow once the entry that began
+        // the term is on a majority. A later leader could still overwrite them before that.
+        std::vector<int> matched = {static_cast<int>(s.messageLog.size()) - 1};
+        for (const auto& peer : s.peers) {
+            auto peerMatch = s.matchIndex.find(peer);
+            matched.push_back(peerMatch == s.matchIndex.end() ? -1 : peerMatch -> second);
+        }
+        size_t majority = matched.size() / 2 + 1;
+        std::nth_element(matched.begin(), matched.begin() + (majority - 1), matched.end(), std::greater<int>());
+        if (matched[majority - 1] >= s.termStartIndex) {
+            AdvanceCommitIndex(s, matched[majority - 1]);
+        }
+    }
+
+    // Leader: append the command to the log, other nodes point the client at the leader unless they
+    // serve the read themselves
+    void HandleClientRequest(RaftState& s, std::shared_ptr<ClientRequest> requestMessage, const std::string& source,
+                             std::vector<std::shared_ptr<IMessage<LogEntryType>>>& clientEntries) const {
+        const ClientCommand& command = requestMessage -> command;
+        if (s.state == RaftStatus::LEADER) {
+            if (command.operation == ClientOperation::READ && s.readMode != ReadMode::LOG) {
+                // The next round is sent after the read arrived, its acknowledgement proves we still lead
+                PendingRead read{source, command.requestID, std::max(s.commitIndex, s.termStartIndex), s.round + 1};
+                if (s.readMode == ReadMode::LEASE && s.currentTime < s.leaseExpiry) {
+                    read.round = 0;
+                }
+                s.pendingReads.push_back(read);
+                return;
+            }
+            clientEntries.emplace_back(std::make_shared<LogEntryExternal>(command));
+            return;
+        }
+        if (command.operation == ClientOperation::READ && s.followerReads != FollowerReadMode::OFF
+            && s.state == RaftStatus::FOLLOWER && !s.leaderID.empty() && s.leaderID != s.nodeID) {
+            HandleFollowerRead(s, command, source);
+            return;
+        }
+        ClientResponseMetadata responseMetadata;
+        responseMetadata.requestID = command.requestID;
+        responseMetadata.status = ClientStatus::REDIRECT;
+        responseMetadata.leaderHint = s.leaderID;
+        SendClientResponse(s, source, responseMetadata);
+    }
+
+    // Follower: answer from our own state when it is recent enough, otherwise wait for a read index.
+    // Reads arriving together share one read-index request, sent by ServeReads.
+    void HandleFollowerRead(RaftState& s, const ClientCommand& command, const std::string& source) const {
+        if (s.followerReads == FollowerReadMode::BOUNDED_STALE && s.leaderCommit - s.lastApplied <= s.maxReadLag
+            && s.currentTime - s.lastHeartbeatUpdate <= s.maxReadStaleness) {
+            if (RaftMetrics* m = Metrics()) {
+                m -> staleReads -> add();
+            }
+            AnswerRead(s, source, command.requestID, s.lastApplied);
+            return;
+        }
+        PendingRead read{source, command.requestID, -1, 0};
+        read.batch = s.readBatch + 1;
+        s.pendingReads.push_back(read);
+    }
+
+    // Leader: confirm leadership as for our own reads, then hand the follower the index to wait for
+    void HandleReadIndexRequest(RaftState& s, std::shared_ptr<ReadIndexRequest> requestMessage) const {
+        PendingRead read{requestMessage -> metadata.nodeId, requestMessage -> metadata.batch, std::max(s.commitIndex, s.termStartIndex), s.round + 1};
+        read.forwarded = true;
+        if (s.state != RaftStatus::LEADER) {
+            SendReadIndexResponse(s, read, false);
+            return;
+        }
+        if (s.readMode == ReadMode::LEASE && s.currentTime < s.leaseExpiry) {
+            read.round = 0;
+        }
+        s.pendingReads.push_back(read);
+    }
+
+    // Follower: the reads of the batch wait for the index, or go to the client's next node if the leader refused
+    void HandleReadIndexResponse(RaftState& s, std::shared_ptr<ReadIndexResponse> responseMessage) const {
+        const ReadIndexResponseMetadata& metadata = responseMessage -> metadata;
+        std::vector<PendingRead> waiting;
+        for (auto& read : s.pendingReads) {
+            if (read.batch != metadata.batch || read.readIndex >= 0) {
+                waiting.push_back(read);
+            } else if (metadata.success) {
+                read.readIndex = metadata.readIndex;
+                waiting.push_back(read);
+            } else {
+                ClientResponseMetadata responseMetadata;
+                responseMetadata.requestID = read.requestID;
+                responseMetadata.status = ClientStatus::REDIRECT;
+                SendClientResponse(s, read.client, responseMetadata);
+            }
+        }
+        s.pendingReads = std::move(waiting);
+    }
+
+    // Raise the commit index and apply the newly committed entries
+    void AdvanceCommitIndex(RaftState& s, int commitIndex) const {
+        commitIndex = std::min(commitIndex, static_cast<int>(s.messageLog.size()) - 1);
+        if (commitIndex <= s.commitIndex) {
+            return;
+        }
+        if (RaftMetrics* m = Metrics()) {
+            m -> entriesCommitted -> add(commitIndex - s.commitIndex);
+        }
+        s.commitIndex = commitIndex;
+        ApplyCommitted(s);
+    }
+
+    // Apply entries up to the commit index, the leader answers the clients whose commands they hold
+    void ApplyCommitted(RaftState& s) const {
+        while (s.lastApplied < s.commitIndex) {
+            s.lastApplied++;
+            const auto& entry = s.messageLog[s.lastApplied];
+            if (s.state != RaftStatus::LEADER || entry -> getType() != LogEntryType::EXTERNAL) {
+                continue;
+            }
+            const ClientCommand& command = std::static_pointer_cast<LogEntryExternal>(entry) -> command;
+            if (command.clientID.empty()) {
+                continue;
+            }
+            ClientResponseMetadata responseMetadata;
+            responseMetadata.requestID = command.requestID;
+            responseMetadata.logIndex = s.lastApplied;
+            responseMetadata.commitTime = s.currentTime;
+            responseMetadata.applyTime = s.currentTime;
+            SendClientResponse(s, command.clientID, responseMetadata);
+        }
+    }
+
+    // Leader: send `peer` every entry after `matchIndex`, the last index it may share with us
+    void SendCatchUp(RaftState& s, const std::string& peer, int matchIndex) const {
+        int prevLogIndex = std::max(-1, std::min(matchIndex, static_cast<int>(s.messageLog.size()) - 1));
+        std::vector<std::shared_ptr<IMessage<LogEntryType>>> entries(s.messageLog.begin() + (prevLogIndex + 1), s.messageLog.end());
+        if (entries.empty()) {
+            return;
+        }
+        QueueAppendEntries(s, prevLogIndex, entries, peer);
+    }
+
+    void SendAppendEntriesResponse(RaftState& s, const AppendEntriesMetadata& request, bool success, int matchIndex, int appended) const {
+        AppendEntriesResponseMetadata responseMetadata = {
+            request.term,  // The term answered, followers do not track the leader's term
+            s.nodeID,
+            success,
+            matchIndex,
+            appended,
+            s.leaderID == request.leaderID ? request.round : 0,  // Only vouch for the leader we follow
+            request.sentAt
+        };
+        std::string msgDigestSigned = SignMetadata(s, responseMetadata.toString(), false);
+        std::shared_ptr<RaftMessage> raftMessage = std::make_shared<RaftMessage>(std::make_shared<AppendEntriesResponse>(responseMetadata, msgDigestSigned));
+        raftMessage -> dest = request.leaderID;
+        raftMessage -> source = s.nodeID;
+        AttachMacs(s, raftMessage);
+        TraceSend(s, raftMessage);
+        s.raftOutMessages.emplace_back(raftMessage);
+    }
+
+    // Leader: the latest round a majority, ourselves included, has acknowledged. Its send time bounds
+    // the lease: no follower that acknowledged it grants a vote within the lease timeout of it.
+    void ConfirmRounds(RaftState& s) const {
+        std::vector<uint64_t> acknowledged = {s.round};
+        for (const auto& peer : s.peers) {
+            auto peerRound = s.peerRound.find(peer);
+            acknowledged.push_back(peerRound == s.peerRound.end() ? 0 : peerRound -> second);
+        }
+        size_t majority = acknowledged.size() / 2 + 1;
+        std::nth_element(acknowledged.begin(), acknowledged.begin() + (majority - 1), acknowledged.end(), std::greater<uint64_t>());
+        uint64_t confirmed = acknowledged[majority - 1];
+        if (confirmed <= s.confirmedRound) {
+            return;
+        }
+        s.confirmedRound = confirmed;
+        auto sent = s.roundSentAt.find(confirmed);
+        if (sent != s.roundSentAt.end()) {
+            s.leaseExpiry = std::max(s.leaseExpiry, sent -> second + s.timers.leaseTimeout() * (1 - s.maxClockDrift));
+        }
+        s.roundSentAt.erase(s.roundSentAt.begin(), s.roundSentAt.upper_bound(confirmed));
+    }
+
+    // Answer reads that are confirmed and applied, forwarded ones only need confirming. Reads held in
+    // a role the node no longer has are redirected, or refused to the follower that forwarded them.
+    void ServeReads(RaftState& s) const {
+        if (s.pendingReads.empty()) {
+            return;
+        }
+        bool needsRound = false;
+        bool needsBatch = false;
+        bool batchInFlight = false;
+        std::vector<PendingRead> waiting;
+        for (auto read : s.pendingReads) {
+            RaftStatus holder = read.batch == 0 ? RaftStatus::LEADER : RaftStatus::FOLLOWER;
+            if (s.state != holder) {
+                if (read.forwarded) {
+                    SendReadIndexResponse(s, read, false);
+                    continue;
+                }
+                ClientResponseMetadata responseMetadata;
+                responseMetadata.requestID = read.requestID;
+                responseMetadata.status = ClientStatus::REDIRECT;
+                responseMetadata.leaderHint = s.leaderID == s.nodeID ? "" : s.leaderID;
+                SendClientResponse(s, read.client, responseMetadata);
+            } else if (read.round > s.confirmedRound || read.readIndex < 0 || (!read.forwarded && s.lastApplied < read.readIndex)) {
+                // The leader never answered, the read joins the next request
+                if (read.readIndex < 0 && read.batch <= s.readBatch && s.currentTime - s.readBatchSentAt >= s.timers.electionTimeoutMin()) {
+                    read.batch = s.readBatch + 1;
+                }
+                needsRound = needsRound || read.round > s.round;
+                needsBatch = needsBatch || read.batch > s.readBatch;
+                batchInFlight = batchInFlight || (read.readIndex < 0 && read.batch == s.readBatch);
+                waiting.push_back(read);
+            } else if (read.forwarded) {
+                if (RaftMetrics* m = Metrics()) {
+                    m -> readIndexesServed -> add();
+                }
+                SendReadIndexResponse(s, read, true);
+            } else {
+                if (RaftMetrics* m = Metrics()) {
+                    if (read.round == 0 && read.batch == 0) {
+                        m -> leaseReads -> add();
+                    }
+                }
+                AnswerRead(s, read.client, read.requestID, read.readIndex);
+            }
+        }
+        s.pendingReads = std::move(waiting);
+
+        // Nothing broadcast since these reads arrived, confirm the leadership with an empty round. While
+        // one is unconfirmed the reads wait for the next, so a burst of reads shares a round.
+        if (needsRound && s.confirmedRound == s.round) {
+            QueueAppendEntries(s, static_cast<int>(s.messageLog.size()) - 1, {}, "*");
+        }
+        // Follower: one read-index request in flight at a time, it covers every read that arrived
+        // since the previous one was sent
+        if (needsBatch && !batchInFlight) {
+            s.readBatch++;
+            s.readBatchSentAt = s.currentTime;
+            SendReadIndexRequest(s);
+        }
+    }
+
+    // A read served without a log entry, as of `logIndex`
+    void AnswerRead(RaftState& s, const std::string& client, uint64_t requestID, int logIndex) const {
+        if (RaftMetrics* m = Metrics()) {
+            m -> readsServed -> add();
+        }
+        ClientResponseMetadata responseMetadata;
+        responseMetadata.requestID = requestID;
+        responseMetadata.logIndex = logIndex;
+        responseMetadata.commitTime = s.currentTime;
+        responseMetadata.applyTime = s.currentTime;
+        SendClientResponse(s, client, responseMetadata);
+    }
+
+    void SendReadIndexRequest(RaftState& s) const {
+        ReadIndexRequestMetadata requestMetadata = {s.nodeID, s.readBatch};
+        std::string msgDigestSigned = SignMetadata(s, requestMetadata.toString(), false);
+        std::shared_ptr<RaftMessage> raftMessage = std::make_shared<RaftMessage>(std::make_shared<ReadIndexRequest>(requestMetadata, msgDigestSigned));
+        raftMessage -> dest = s.leaderID;
+        raftMessage -> source = s.nodeID;
+        AttachMacs(s, raftMessage);
+        TraceSend(s, raftMessage);
+        s.raftOutMessages.emplace_back(raftMessage);
+    }
+
+    void SendReadIndexResponse(RaftState& s, const PendingRead& read, bool success) const {
+        ReadIndexResponseMetadata responseMetadata = {s.nodeID, read.requestID, success, read.readIndex};
+        std::string msgDigestSigned = SignMetadata(s, responseMetadata.toString(), false);
+        std::shared_ptr<RaftMessage> raftMessage = std::make_shared<RaftMessage>(std::make_shared<ReadIndexResponse>(responseMetadata, msgDigestSigned));
+        raftMessage -> dest = read.client;
+        raftMessage -> source = s.nodeID;
+        AttachMacs(s, raftMessage);
+        TraceSend(s, raftMessage);
+        s.raftOutMessages.emplace_back(raftMessage);
+    }
 
-        // Update commit index
-        s.commitIndex = std::min(appendEntriesMessage -> metadata.leaderCommit, static_cast<int>(s.messageLog.size()) - 1);
+    void SendClientResponse(RaftState& s, const std::string& client, const ClientResponseMetadata& responseMetadata) const {
+        std::shared_ptr<RaftMessage> raftMessage = std::make_shared<RaftMessage>(std::make_shared<ClientResponse>(responseMetadata));
+        raftMessage -> dest = client;
+        raftMessage -> source = s.nodeID;
+        TraceSend(s, raftMessage);
+        s.raftOutMessages.emplace_back(raftMessage);
     }
     
-    void HandleRAFTEntry(RaftState& s, const std::shared_ptr<LogEntryRAFT> logEntryRaft, const std::string& leaderID) const {
+    bool HandleRAFTEntry(RaftState& s, const std::shared_ptr<LogEntryRAFT> logEntryRaft, const std::string& leaderID, const std::string& entryDigest = "") const {
         // Verify the RAFT entry before committing it
         if (ValidateRAFTEntry(s, logEntryRaft)) {
             // If the entry is valid, commit to the log
-            s.messageLog.emplace_back(logEntryRaft);  // Or handle it according to your log structure
-            std::cout << "Node #" << s.nodeID
-            << " | Message Log Entry #" << s.messageLog.size()
-            << " | Log Entry: " << logEntryRaft->toString()
-            << std::endl;  
+            AppendLogEntry(s, logEntryRaft, entryDigest);
+            RAFT_DIAG(DiagLevel::DEBUG, s.currentTime, s.nodeID,
+                "Message Log Entry #" << s.messageLog.size() << " | Log Entry: " << logEntryRaft->toString());
+            // A leader elected in our term or a later one ends our own candidacy or leadership
+            int term = logEntryRaft -> metadata.certificate.termNumber;
+            if (term > s.currentTerm) {
+                AdoptTerm(s, term);
+            } else if (term == s.currentTerm && s.state != RaftStatus::FOLLOWER && leaderID != s.nodeID) {
+                StepDown(s);
+            }
             // Update the leader if the entry is valid and the leader has changed
-            s.leaderID = leaderID;
+            SetLeader(s, leaderID);
             s.lastHeartbeatUpdate = s.currentTime;
+            return true;
         } else {
             // Handle invalid RAFT entry, e.g., log an error or take action
-            std::cerr << "Invalid RAFT entry detected. Skipping commit." << std::endl;
+            RAFT_DIAG(DiagLevel::WARN, s.currentTime, s.nodeID, "Invalid RAFT entry detected. Skipping commit.");
+            return false;
         }
     }
     
-    void HandleHeartbeatEntry(RaftState& s, const std::shared_ptr<LogEntryHeartbeat> logEntryHeartbeat, const std::string& leaderID) const {
+    bool HandleHeartbeatEntry(RaftState& s, const std::shared_ptr<LogEntryHeartbeat> logEntryHeartbeat, const std::string& leaderID, const std::string& entryDigest = "") const {
         // Verify that the leader is valid
         if (s.leaderID != leaderID) {
-            // std::cerr << "Heartbeat received from an invalid leader: " << leaderID << std::endl;
-            return;
+            RAFT_DIAG(DiagLevel::TRACE, s.currentTime, s.nodeID, "Heartbeat received from an invalid leader: " << leaderID);
+            return false;
         }
         // Commit message
         s.lastHeartbeatUpdate = s.currentTime;
-        s.messageLog.emplace_back(logEntryHeartbeat);
-        std::cout << "Node #" << s.nodeID 
-          << " | Message Log Entry #" << s.messageLog.size() 
-          << " | Log Entry: " << logEntryHeartbeat->toString() 
-          << std::endl;
+        AppendLogEntry(s, logEntryHeartbeat, entryDigest);
+        RAFT_DIAG(DiagLevel::DEBUG, s.currentTime, s.nodeID,
+            "Message Log Entry #" << s.messageLog.size() << " | Log Entry: " << logEntryHeartbeat->toString());
+        return true;
+    }
+
+    // Append to the log and extend the chain digest incrementally. The entry digest is
+    // computed here unless the caller already hashed it as part of a batch.
+    void AppendLogEntry(RaftState& s, const std::shared_ptr<IMessage<LogEntryType>>& logEntry, const std::string& precomputedDigest = "") const {
+        // The entry is hashed once, for both the chain and the Merkle index
+        std::string entryDigest = precomputedDigest.empty() ? Crypto::EntryDigest(logEntry -> toString()) : precomputedDigest;
+        s.logDigests.push_back(Crypto::LinkDigest(LogDigestAt(s, static_cast<int>(s.messageLog.size()) - 1), entryDigest));
+        s.merkleIndex.append(entryDigest);
+        s.messageLog.emplace_back(logEntry);
+        s.logIndex = static_cast<int>(s.messageLog.size()) - 1;
+        if (RaftMetrics* m = Metrics()) {
+            m -> entriesAppended -> add();
+        }
+    }
+
+    // Append a batch of entries, hashing them together
+    void AppendLogEntries(RaftState& s, const std::vector<std::shared_ptr<IMessage<LogEntryType>>>& entries) const {
+        std::vector<std::string> entryDigests = EntryDigests(entries);
+        for (size_t i = 0; i < entries.size(); i++) {
+            AppendLogEntry(s, entries[i], entryDigests[i]);
+        }
+    }
+
+    // SHA-256 of every entry in the batch, multi-buffer when the CPU allows it
+    static std::vector<std::string> EntryDigests(const std::vector<std::shared_ptr<IMessage<LogEntryType>>>& entries) {
+        std::vector<std::string> serialized;
+        serialized.reserve(entries.size());
+        for (const auto& entry : entries) {
+            serialized.push_back(entry -> toString());
+        }
+        return Crypto::EntryDigests(serialized);
+    }
+
+    // Drop every entry from index onwards
+    void TruncateLog(RaftState& s, size_t index) const {
+        if (index < s.messageLog.size()) {
+            s.messageLog.resize(index);
+            s.logDigests.resize(index);
+            s.merkleIndex.truncate(index);
+            s.logIndex = static_cast<int>(s.messageLog.size()) - 1;
+        }
+    }
 
+    // Chain digest covering entries [0, index], the empty prefix has an empty digest
+    std::string LogDigestAt(const RaftState& s, int index) const {
+        if (index < 0 || index >= static_cast<int>(s.logDigests.size())) {
+            return "";
+        }
+        return s.logDigests[index];
+    }
+
+    // True when our log holds the same prefix [0, prevLogIndex] as the leader's
+    bool MatchesLogPrefix(const RaftState& s, int prevLogIndex, const std::string& prevLogDigest) const {
+        if (prevLogIndex < 0) {
+            return true;
+        }
+        if (prevLogIndex >= static_cast<int>(s.logDigests.size())) {
+            return false;
+        }
+        return s.logDigests[prevLogIndex] == prevLogDigest;
+    }
+
+    // Length of the prefix shared with a remote log, given a way to fetch its digest at an index.
+    // Chain digests agree at i exactly when both prefixes [0, i] agree, so the answer is found
+    // with O(log n) remote lookups.
+    static int FindDivergenceIndex(const std::vector<std::string>& localDigests, int remoteLength,
+                                   const std::function<std::string(int)>& remoteDigestAt) {
+        int low = 0;
+        int high = std::min(static_cast<int>(localDigests.size()), remoteLength);
+        while (low < high) {
+            int mid = low + (high - low) / 2;
+            if (localDigests[mid] == remoteDigestAt(mid)) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return low;
     }
     
     bool ValidateRAFTEntry(const RaftState& s, const std::shared_ptr<LogEntryRAFT> logEntryRaft) const {
@@ -331,15 +988,105 @@ void HandleRequest(RaftState& s, std::shared_ptr<RequestVote> requestMessage, st
         // Assume is valid for this experimental frame
         int voteCountRequirement = std::ceil((s.peers.size() + 1) / 2.0);
 
-        // Validate signatures, from peers -- implement in later project
-        // Validate request from leader
-        int acc = 0;
-        for (const auto& message : logEntryRaft -> metadata.messageList) {
-            if (message.metadata.voteGranted == true){
-                acc++;
+        const QuorumCertificate& certificate = logEntryRaft -> metadata.certificate;
+
+        // Certificate must vouch for the candidate that issued the request, in the term it asked for,
+        // a certificate from an earlier election cannot be replayed
+        const RequestMetadata& requested = logEntryRaft -> metadata.requestMessage.metadata;
+        if (certificate.candidateID != requested.candidateID || certificate.termNumber != requested.termNumber) {
+            return false;
+        }
+
+        // Every voter bit must name a cluster member, a stray one would count as a vote nobody signed
+        size_t members = s.clusterMembers.size();
+        int memberVotes = 0;
+        for (size_t index = 0; index < members; index++) {
+            memberVotes += certificate.hasVoter(index);
+        }
+        if (certificate.voterBitmap.size() > (members + 63) / 64 || memberVotes != certificate.voteCount()) {
+            return false;
+        }
+
+        // One signature per voter bit, votes are counted straight from the bitmap
+        int acc = certificate.voteCount();
+        if (static_cast<int>(certificate.signatures.size()) != acc) {
+            return false;
+        }
+        if (acc < voteCountRequirement) {
+            return false;
+        }
+
+        // Validate signatures from peers, the certificate is the one proof that stays RSA signed
+        if (s.authMode != AuthMode::NONE) {
+            const RequestMetadata& request = logEntryRaft -> metadata.requestMessage.metadata;
+            size_t signatureIndex = 0;
+            for (size_t index = 0; index < s.clusterMembers.size() && signatureIndex < certificate.signatures.size(); index++) {
+                if (!certificate.hasVoter(index)) {
+                    continue;
+                }
+                // Rebuild the metadata the voter signed in HandleRequest
+                ResponseMetadata signedVote = {
+                    request.termNumber,
+                    request.candidateID,
+                    request.lastLogIndex,
+                    true,
+                    s.clusterMembers[index]
+                };
+                if (index >= s.publicKeys.size() ||
+                    !Crypto::VerifySignature(signedVote.toString(), s.publicKeys[index], certificate.signatures[signatureIndex])) {
+                    return false;
+                }
+                signatureIndex++;
+            }
+            if (signatureIndex != certificate.signatures.size()) {
+                return false;
             }
         }
-        return acc >= voteCountRequirement;
+        return true;
+    }
+
+    // Build the leader proof from the granted votes held in temp storage
+    QuorumCertificate BuildQuorumCertificate(const RaftState& s) const {
+        QuorumCertificate certificate;
+        certificate.termNumber = s.currentTerm;
+        certificate.candidateID = s.nodeID;
+
+        // Resolve voters to their interned index, sorted so signatures follow bitmap order
+        std::vector<std::pair<int, const ResponseVote*>> voters;
+        for (const auto& response : s.tempMessageStorage) {
+            int index = ClusterIndex(s, response -> metadata.nodeId);
+            if (index >= 0 && response -> metadata.voteGranted) {
+                voters.emplace_back(index, response.get());
+            }
+        }
+        std::sort(voters.begin(), voters.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        for (const auto& [index, response] : voters) {
+            // Duplicate responses from the same voter only count once
+            if (!certificate.hasVoter(index)) {
+                certificate.addVoter(index, response -> msgDigestSigned);
+            }
+        }
+        return certificate;
+    }
+
+    // Position of a node in the interned membership list, -1 if unknown
+    int ClusterIndex(const RaftState& s, const std::string& id) const {
+        auto it = std::lower_bound(s.clusterMembers.begin(), s.clusterMembers.end(), id);
+        if (it == s.clusterMembers.end() || *it != id) {
+            return -1;
+        }
+        return static_cast<int>(it - s.clusterMembers.begin());
+    }
+
+    // Rebuild the sorted membership list (peers + self) used to index voters
+    static void InternClusterMembers(RaftState& s) {
+        s.clusterMembers = s.peers;
+        if (!s.nodeID.empty()) {
+            s.clusterMembers.push_back(s.nodeID);
+        }
+        std::sort(s.clusterMembers.begin(), s.clusterMembers.end());
+        s.clusterMembers.erase(std::unique(s.clusterMembers.begin(), s.clusterMembers.end()), s.clusterMembers.end());
     }
     
     
@@ -349,12 +1096,26 @@ void HandleRequest(RaftState& s, std::shared_ptr<RequestVote> requestMessage, st
             // Calculate the required number of votes (2f+1)
             int voteCountRequirement = std::ceil((s.peers.size() + 1) / 2.0);
 
-            int votesReceived = s.tempMessageStorage.size();
+            // Distinct granted votes, counted from the certificate bitmap
+            QuorumCertificate certificate = BuildQuorumCertificate(s);
+            int votesReceived = certificate.voteCount();
     
             // If enough votes have been received, transition to leader
             if (votesReceived >= voteCountRequirement) {
                 s.state = RaftStatus::LEADER;
-                s.leaderID = s.nodeID;
+                SetLeader(s, s.nodeID);
+                s.electedAt = s.currentTime;
+                s.matchIndex.clear();
+                s.peerRound.clear();
+                s.catchUps.clear();
+                s.roundSentAt.clear();
+                s.confirmedRound = s.round;
+                s.leaseExpiry = 0;
+                s.termStartIndex = static_cast<int>(s.messageLog.size());  // The entry appended below
+                if (RaftMetrics* m = Metrics()) {
+                    m -> electionsWon -> add();
+                    m -> electionDuration -> record(s.currentTime - s.electionStartTime);
+                }
 
                 s.heartbeatStatus = HeartbeatStatus::UPDATE;
     
@@ -369,27 +1130,18 @@ void HandleRequest(RaftState& s, std::shared_ptr<RequestVote> requestMessage, st
                     HEARTBEAT_STATUS::PING
                 };
     
-                // Create log entries
-                entriesVector.emplace_back(std::make_shared<LogEntryHeartbeat>(metadataHeartbeat));
-
-
-                // Copy proof
-                std::vector<ResponseVote> messageList;
-                for (const auto& ptr : s.tempMessageStorage) {
-                    messageList.push_back(*ptr);  // Dereference shared_ptr to copy the object
-                }
-                
-                
                 // Make a copy of Request
                 RequestVote request = *s.leaderProof;
 
-                // Create Log Entry
+                // Create Log Entry, the votes are carried as a compact certificate
                 logEntryMetadata LEM = {
                     request,
-                    messageList
+                    certificate
                 };
 
-                entriesVector.emplace_back(std::make_shared<LogEntryRAFT>(LEM));                              
+                // Proof goes first so followers know the new leader before its heartbeat
+                entriesVector.emplace_back(std::make_shared<LogEntryRAFT>(LEM));
+                entriesVector.emplace_back(std::make_shared<LogEntryHeartbeat>(metadataHeartbeat));
     
                 // Send the AppendEntries message
                 SendAppendEntries(s, entriesVector);  
@@ -398,27 +1150,50 @@ void HandleRequest(RaftState& s, std::shared_ptr<RequestVote> requestMessage, st
     }
     
     void SendAppendEntries(RaftState& s, std::vector<std::shared_ptr<IMessage<LogEntryType>>> entries) const {
+        // New entries follow the current end of our log
+        int prevLogIndex = static_cast<int>(s.messageLog.size()) - 1;
+
+        // The leader's own log holds everything it replicates
+        AppendLogEntries(s, entries);
+        QueueAppendEntries(s, prevLogIndex, entries, "*");
+    }
+
+    // Send entries that follow prevLogIndex in our log to `dest`, "*" for every peer
+    void QueueAppendEntries(RaftState& s, int prevLogIndex, const std::vector<std::shared_ptr<IMessage<LogEntryType>>>& entries, const std::string& dest) const {
         // Prepare append entries metadata
         AppendEntriesMetadata appendEntriesMetadata = {
             s.currentTerm,   // Leader's term
             s.nodeID,              // Leader's ID
-            s.logIndex,      // Index for the log entry at PrevLogIndex
+            prevLogIndex,      // Index for the log entry at PrevLogIndex
             s.currentTerm,   // Term of the log entry at PrevLogIndex
             entries,         // Entries to replicate (including heartbeat)
-            s.commitIndex    // The highest log entry index known to be committed
+            s.commitIndex,    // The highest log entry index known to be committed
+            LogDigestAt(s, prevLogIndex)  // Chain digest of our log up to PrevLogIndex
         };
-    
-        // // Hash and sign the message
-        // std::string msgDigestSigned = Crypto::SignData(appendEntriesMetadata.toString(), s.privateKey);
+        // Every broadcast starts a round, a catch-up to one peer repeats the current one
+        if (dest == "*") {
+            s.round++;
+            s.roundSentAt[s.round] = s.currentTime;
+        }
+        appendEntriesMetadata.round = s.round;
+        // Followers echo the send time back, and take the estimate it feeds
+        appendEntriesMetadata.sentAt = s.currentTime;
+        appendEntriesMetadata.rtt = s.timers.getEstimator().smoothed();
+        appendEntriesMetadata.rttVar = s.timers.getEstimator().variation();
+
+        // Hash and sign the message
+        std::string msgDigestSigned = SignMetadata(s, appendEntriesMetadata.toString(), false);
     
         // Create append entries message with signature
-        std::shared_ptr<AppendEntries> appendEntriesMsg = std::make_shared<AppendEntries>(appendEntriesMetadata, "msgDigestSigned");
+        std::shared_ptr<AppendEntries> appendEntriesMsg = std::make_shared<AppendEntries>(appendEntriesMetadata, msgDigestSigned);
 
     
         // Create Raft message and add it to the output message queue
         std::shared_ptr<RaftMessage> raftMessage =  std::make_shared<RaftMessage>(appendEntriesMsg);
-        raftMessage -> dest = "*";
+        raftMessage -> dest = dest;
         raftMessage -> source = s.nodeID;
+        AttachMacs(s, raftMessage);
+        TraceSend(s, raftMessage);
         s.raftOutMessages.emplace_back(raftMessage);
     }
 
@@ -456,44 +1231,314 @@ void HandleRequest(RaftState& s, std::shared_ptr<RequestVote> requestMessage, st
         }
         
         // Check if we had a TIMEOUT by not receiving a HeartBEAT message
-        if (s.state != RaftStatus::LEADER &&  heartbeatStatus == HeartbeatStatus::TIMEOUT && (s.currentTime - s.lastHeartbeatUpdate) > 0.150 ) {
-                // Set ourselves as a candidate
-                s.state = RaftStatus::CANDIDATE;
-                s.currentTerm = state.currentTerm + 1;
-                s.heartbeatStatus = HeartbeatStatus::TIMEOUT;
-
-                s.votedStatus = VoteStatus::VOTE_SUBMITTED; // Self vote
-                // Clear the temp message store 
-                s.tempMessageStorage.clear();
-                // Make a requestVote
-                RequestMetadata requestMetadata = {
-                    s.currentTerm,
-                    s.nodeID,
-                    s.commitIndex
-                };
-                // // Hash + Sign it
-                // std::string msgDigestSigned = Crypto::SignData(requestMetadata.toString(), s.privateKey);
-                // Append to response
-                std::shared_ptr<RequestVote> requestMessage = std::make_shared<RequestVote>(requestMetadata, "msgDigestSigned");
-                s.leaderProof = requestMessage;
-                // Make RaftMessage
-                std::shared_ptr<RaftMessage> raftMessage = std::make_shared<RaftMessage>(requestMessage);
-                raftMessage -> dest = "*"; // broadcast
-                raftMessage -> source = s.nodeID;
-                // Push it to the ouput port
-                s.raftOutMessages.emplace_back(raftMessage);
+        if (s.state != RaftStatus::LEADER && heartbeatStatus == HeartbeatStatus::TIMEOUT) {
+            // The timer fires once per countdown, restart it either way
+            s.heartbeatStatus = HeartbeatStatus::TIMEOUT;
+            if ((s.currentTime - s.lastHeartbeatUpdate) <= s.timers.electionTimeoutMin()) {
+                return;
+            }
+            if (s.preVote) {
+                StartPreVote(s);
+            } else {
+                StartElection(s);
+            }
         }
     } 
+
+    void StartElection(RaftState& s) const {
+        // Set ourselves as a candidate
+        s.state = RaftStatus::CANDIDATE;
+        s.currentTerm = s.currentTerm + 1;
+        s.heartbeatStatus = HeartbeatStatus::TIMEOUT;
+        s.preVoteTerm = 0;
+        SetLeader(s, "");
+
+        s.votedStatus = VoteStatus::VOTE_SUBMITTED; // Self vote
+        s.votedFor = s.nodeID;
+        s.electionStartTime = s.currentTime;
+        if (RaftMetrics* m = Metrics()) {
+            m -> electionsStarted -> add();
+            m -> term -> set(s.currentTerm);
+        }
+        // Clear the temp message store, our own vote counts towards the quorum and is signed like any other
+        s.tempMessageStorage.clear();
+        int lastLogIndex = static_cast<int>(s.messageLog.size()) - 1;
+        ResponseMetadata selfVote = {s.currentTerm, s.nodeID, lastLogIndex, true, s.nodeID};
+        s.tempMessageStorage.emplace_back(std::make_shared<ResponseVote>(selfVote, SignMetadata(s, selfVote.toString(), true)));
+        // Make a requestVote
+        RequestMetadata requestMetadata = {
+            s.currentTerm,
+            s.nodeID,
+            lastLogIndex      // Voters compare it against their own log
+        };
+        // Hash + Sign it
+        std::string msgDigestSigned = SignMetadata(s, requestMetadata.toString(), false);
+        // Append to response
+        std::shared_ptr<RequestVote> requestMessage = std::make_shared<RequestVote>(requestMetadata, msgDigestSigned);
+        s.leaderProof = requestMessage;
+        // Make RaftMessage
+        std::shared_ptr<RaftMessage> raftMessage = std::make_shared<RaftMessage>(requestMessage);
+        raftMessage -> dest = "*"; // broadcast
+        raftMessage -> source = s.nodeID;
+        AttachMacs(s, raftMessage);
+        TraceSend(s, raftMessage);
+        // Push it to the ouput port
+        s.raftOutMessages.emplace_back(raftMessage);
+    }
+
+    // Ask whether a majority would vote for us in the next term. Nothing changes until they agree, so a
+    // node that was cut off cannot push the cluster into a new term by itself.
+    void StartPreVote(RaftState& s) const {
+        s.preVoteTerm = s.currentTerm + 1;
+        s.preVotesGranted.clear();
+        if (RaftMetrics* m = Metrics()) {
+            m -> preVotesStarted -> add();
+        }
+        PreVoteMetadata preVoteMetadata = {s.preVoteTerm, s.nodeID, static_cast<int>(s.messageLog.size()) - 1};
+        std::string msgDigestSigned = SignMetadata(s, preVoteMetadata.toString(), false);
+        std::shared_ptr<RaftMessage> raftMessage = std::make_shared<RaftMessage>(std::make_shared<PreVoteRequest>(preVoteMetadata, msgDigestSigned));
+        raftMessage -> dest = "*";
+        raftMessage -> source = s.nodeID;
+        AttachMacs(s, raftMessage);
+        TraceSend(s, raftMessage);
+        s.raftOutMessages.emplace_back(raftMessage);
+    }
+
+    // Would we vote for the sender in the term it proposes? Unlike a vote, the answer changes nothing here.
+    void HandlePreVoteRequest(RaftState& s, std::shared_ptr<PreVoteRequest> requestMessage, const std::string& source) const {
+        const PreVoteMetadata& request = requestMessage -> metadata;
+        // A leader counts as hearing from itself
+        bool leaderHeard = !s.leaderID.empty() && s.currentTime - s.lastHeartbeatUpdate < s.timers.electionTimeoutMin();
+        bool upToDate = request.lastLogIndex >= static_cast<int>(s.messageLog.size()) - 1;  // As for a vote
+        bool granted = request.termNumber > s.currentTerm && upToDate && !leaderHeard;
+
+        PreVoteResponseMetadata responseMetadata = {request.termNumber, request.candidateID, granted, s.nodeID};
+        std::string msgDigestSigned = SignMetadata(s, responseMetadata.toString(), false);
+        std::shared_ptr<RaftMessage> raftMessage = std::make_shared<RaftMessage>(std::make_shared<PreVoteResponse>(responseMetadata, msgDigestSigned));
+        raftMessage -> dest = source;
+        raftMessage -> source = s.nodeID;
+        AttachMacs(s, raftMessage);
+        TraceSend(s, raftMessage);
+        s.raftOutMessages.emplace_back(raftMessage);
+    }
+
+    // Start the real election once a majority, ourselves included, would vote for us
+    void HandlePreVoteResponse(RaftState& s, std::shared_ptr<PreVoteResponse> responseMessage) const {
+        const PreVoteResponseMetadata& metadata = responseMessage -> metadata;
+        if (!metadata.granted || s.state == RaftStatus::LEADER || s.preVoteTerm == 0
+            || metadata.termNumber != s.preVoteTerm || s.preVoteTerm != s.currentTerm + 1) {
+            return;
+        }
+        if (std::find(s.preVotesGranted.begin(), s.preVotesGranted.end(), metadata.nodeId) == s.preVotesGranted.end()) {
+            s.preVotesGranted.push_back(metadata.nodeId);
+        }
+        size_t majority = (s.peers.size() + 1) / 2 + 1;
+        if (s.preVotesGranted.size() + 1 >= majority) {
+            StartElection(s);
+        }
+    }
+
+    // Move to a higher term: no vote cast in it yet and no leader known
+    void AdoptTerm(RaftState& s, int term) const {
+        s.currentTerm = term;
+        s.votedStatus = VoteStatus::VOTE_NOT_YET_SUBMITTED;
+        s.votedFor.clear();
+        s.preVoteTerm = 0;
+        if (RaftMetrics* m = Metrics()) {
+            m -> term -> set(s.currentTerm);
+        }
+        if (s.state != RaftStatus::FOLLOWER) {
+            StepDown(s);
+        }
+        SetLeader(s, "");
+    }
+
+    // Back to follower, the election timer runs again
+    void StepDown(RaftState& s) const {
+        s.state = RaftStatus::FOLLOWER;
+        s.heartbeatStatus = HeartbeatStatus::TIMEOUT;
+        if (RaftMetrics* m = Metrics()) {
+            m -> stepDowns -> add();
+        }
+    }
+
+    // Change the known leader, timing the stretches without one
+    void SetLeader(RaftState& s, const std::string& leaderID) const {
+        if (s.leaderID.empty() && !leaderID.empty()) {
+            s.leaderlessTime += s.currentTime - s.leaderlessSince;
+            if (RaftMetrics* m = Metrics()) {
+                m -> leaderlessDuration -> record(s.currentTime - s.leaderlessSince);
+            }
+        } else if (!s.leaderID.empty() && leaderID.empty()) {
+            s.leaderlessSince = s.currentTime;
+        }
+        s.leaderID = leaderID;
+    }
     
 
+    // Sign metadata with RSA when the mode requires it. Transferable proofs (votes that end up
+    // in a quorum certificate) keep their RSA signature in HMAC mode too.
+    std::string SignMetadata(const RaftState& s, const std::string& metadata, bool transferable) const {
+        bool useRSA = (s.authMode == AuthMode::RSA) || (s.authMode == AuthMode::HMAC && transferable);
+        if (!useRSA || s.privateKey.empty()) {
+            return "msgDigestSigned";
+        }
+        return Crypto::SignData(metadata, s.privateKey);
+    }
+
+    // In HMAC mode tag the message for each recipient, broadcasts carry one tag per peer
+    void AttachMacs(const RaftState& s, std::shared_ptr<RaftMessage> raftMessage) const {
+        if (s.authMode != AuthMode::HMAC) {
+            return;
+        }
+        std::string data = raftMessage -> source + raftMessage -> content -> toString();
+        if (raftMessage -> dest == "*") {
+            for (const auto& peer : s.peers) {
+                auto key = s.pairwiseKeys.find(peer);
+                if (key != s.pairwiseKeys.end()) {
+                    raftMessage -> macVector[peer] = Crypto::ComputeHMAC(data, key -> second);
+                }
+            }
+        } else {
+            auto key = s.pairwiseKeys.find(raftMessage -> dest);
+            if (key != s.pairwiseKeys.end()) {
+                raftMessage -> macVector[raftMessage -> dest] = Crypto::ComputeHMAC(data, key -> second);
+            }
+        }
+    }
+
+    // Give an outgoing message a trace id and mark when it was sent
+    void TraceSend(const RaftState& s, const std::shared_ptr<RaftMessage>& raftMessage) const {
+        if (MessageTracer* tracer = MessageTracer::Active()) {
+            raftMessage -> traceId = MessageTracer::NextTraceId();
+            tracer -> instant(raftMessage -> traceId, s.nodeID, getId(), "send " + taskToString(raftMessage -> content -> getType()), s.currentTime);
+        }
+    }
+
+    // Metadata covered by the sender's RSA signature
+    std::string SignedMetadata(const std::shared_ptr<IMessage<Task>>& content, std::string& signature) const {
+        switch (content -> getType()) {
+            case Task::VOTE_REQUEST: {
+                auto request = std::static_pointer_cast<RequestVote>(content);
+                signature = request -> msgDigestSigned;
+                return request -> metadata.toString();
+            }
+            case Task::VOTE_RESPONSE: {
+                auto response = std::static_pointer_cast<ResponseVote>(content);
+                signature = response -> msgDigestSigned;
+                return response -> metadata.toString();
+            }
+            case Task::APPEND_ENTRIES: {
+                auto appendEntries = std::static_pointer_cast<AppendEntries>(content);
+                signature = appendEntries -> msgDigestSigned;
+                return appendEntries -> metadata.toString();
+            }
+            case Task::APPEND_ENTRIES_RESPONSE: {
+                auto response = std::static_pointer_cast<AppendEntriesResponse>(content);
+                signature = response -> msgDigestSigned;
+                return response -> metadata.toString();
+            }
+            case Task::READ_INDEX_REQUEST: {
+                auto request = std::static_pointer_cast<ReadIndexRequest>(content);
+                signature = request -> msgDigestSigned;
+                return request -> metadata.toString();
+            }
+            case Task::READ_INDEX_RESPONSE: {
+                auto response = std::static_pointer_cast<ReadIndexResponse>(content);
+                signature = response -> msgDigestSigned;
+                return response -> metadata.toString();
+            }
+            case Task::PRE_VOTE_REQUEST: {
+                auto request = std::static_pointer_cast<PreVoteRequest>(content);
+                signature = request -> msgDigestSigned;
+                return request -> metadata.toString();
+            }
+            case Task::PRE_VOTE_RESPONSE: {
+                auto response = std::static_pointer_cast<PreVoteResponse>(content);
+                signature = response -> msgDigestSigned;
+                return response -> metadata.toString();
+            }
+            default:
+                return "";
+        }
+    }
+
+    // Check a received message against the channel authentication mode
+    bool VerifyAuthenticity(const RaftState& s, const std::shared_ptr<RaftMessage>& raftMessage) const {
+        // Clients hold no cluster keys
+        if (raftMessage -> content -> getType() == Task::CLIENT_REQUEST) {
+            return true;
+        }
+        switch (s.authMode) {
+            case AuthMode::HMAC: {
+                auto mac = raftMessage -> macVector.find(s.nodeID);
+                auto key = s.pairwiseKeys.find(raftMessage -> source);
+                if (mac == raftMessage -> macVector.end() || key == s.pairwiseKeys.end()) {
+                    return false;
+                }
+                return Crypto::VerifyHMAC(raftMessage -> source + raftMessage -> content -> toString(), key -> second, mac -> second);
+            }
+            case AuthMode::RSA: {
+                int index = ClusterIndex(s, raftMessage -> source);
+                if (index < 0 || index >= static_cast<int>(s.publicKeys.size())) {
+                    return false;
+                }
+                std::string signature;
+                std::string metadata = SignedMetadata(raftMessage -> content, signature);
+                return Crypto::VerifySignature(metadata, s.publicKeys[index], signature);
+            }
+            default:
+                return true;
+        }
+    }
+
+    // Setter function to install the keys distributed at cluster setup
+    void setAuthentication(AuthMode mode, const std::string& privateKey, const std::vector<std::string>& publicKeys,
+                           const std::unordered_map<std::string, std::string>& pairwiseKeys) {
+        state.authMode = mode;
+        state.privateKey = privateKey;
+        state.publicKeys = publicKeys;
+        state.pairwiseKeys = pairwiseKeys;
+    }
+
+    // Setter function for how client reads are served, `maxClockDrift` shortens LEASE leases
+    void setReadMode(ReadMode mode, double maxClockDrift = 0.01) {
+        state.readMode = mode;
+        state.maxClockDrift = maxClockDrift;
+    }
+
+    // Setter function for the PreVote phase: a node whose election timer fires first asks a majority
+    // whether they would vote for it, and only then moves to the next term
+    void setPreVote(bool enabled) {
+        state.preVote = enabled;
+    }
+
+    // Setter function for how the node's election and heartbeat timers follow observed round trips.
+    // Adaptive timers learn from the round trips of this node's AppendEntries while it leads.
+    void setTimeouts(const TimeoutConfig& config) {
+        state.timers.setConfig(config);
+    }
+
+    // Setter function for whether followers serve client reads, BOUNDED_STALE bounds how far behind
+    // the leader they may answer from: `maxLag` entries and `maxStaleness` seconds of silence
+    void setFollowerReads(FollowerReadMode mode, int maxLag = 0, double maxStaleness = 2 * HEARTBEAT_INTERVAL) {
+        state.followerReads = mode;
+        state.maxReadLag = maxLag;
+        state.maxReadStaleness = maxStaleness;
+    }
+
     // Setter function to update nodeID inside RaftControllerModel..
     void setNodeID(const std::string& id) {
         state.nodeID = id;
+        InternClusterMembers(state);
+        metricsScope = id + "/" + getId();
+        metrics.reset();
     }
 
     // Setter function to update nodeID inside RaftControllerModel..
     void setPeers(const std::vector<std::string>& peers) {
             state.peers = peers;
+            InternClusterMembers(state);
     }
 
 
@@ -502,6 +1547,31 @@ void HandleRequest(RaftState& s, std::shared_ptr<RequestVote> requestMessage, st
         return state;
     }
 
+    // Log only the fields that changed since the previous transition, nothing if the log filter drops it
+    std::string logState() const override {
+        if (!LogFilter::WantsState(this, getId(), state.nodeID)) {
+            return "";
+        }
+        return stateDelta.log("RaftState", state);
+    }
+
+private:
+    mutable StateDelta stateDelta;
+    std::string metricsScope;
+    mutable MetricsBinding<RaftMetrics> metrics;
+
+    // This controller's metrics in the active registry, nullptr when metrics are off
+    RaftMetrics* Metrics() const {
+        return metrics.get(metricsScope);
+    }
+
+    void RecordTimers(const RaftState& s) const {
+        if (RaftMetrics* m = Metrics()) {
+            m -> smoothedRtt -> set(static_cast<int64_t>(s.timers.getEstimator().smoothed() * 1e6));
+            m -> electionTimeout -> set(static_cast<int64_t>(s.timers.electionTimeoutMin() * 1e6));
+        }
+    }
+
 
 
 };
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "../buffer.hpp"
+#include "../raft_controller.hpp"
 
 
 TEST(TestBuffer, TestBufferInit) {
@@ -11,6 +12,246 @@ TEST(TestBuffer, TestBufferInit) {
     ASSERT_TRUE(1);
 }
 
+TEST(TestBuffer, TestBatchModeForwardsUpToBatchSize) {
+    Buffer<std::string> bufferModel("nodeBuffer");
+    bufferModel.setBatching(2, 0.001);
+    BufferState<std::string> bufferState;
+    for (const std::string text : {"a", "b", "c", "d", "e"}) {
+        bufferModel.input_port -> addMessage(std::make_shared<std::string>(text));
+    }
+    bufferModel.externalTransition(bufferState, 0);
+    ASSERT_EQ(bufferModel.timeAdvance(bufferState), 0.001);
+
+    // Batches of two, then the remainder
+    std::vector<size_t> batches;
+    std::string order;
+    while (bufferModel.timeAdvance(bufferState) != std::numeric_limits<double>::infinity()) {
+        bufferModel.output_port -> clear();
+        bufferModel.output(bufferState);
+        batches.push_back(bufferModel.output_port -> getBag().size());
+        for (const auto& msg : bufferModel.output_port -> getBag()) {
+            order += *msg;
+        }
+        bufferModel.internalTransition(bufferState);
+    }
+    ASSERT_EQ(batches, std::vector<size_t>({2, 2, 1}));
+    ASSERT_EQ(order, "abcde");
+    ASSERT_DOUBLE_EQ(bufferState.currentTime, 0.003);
+}
+
+// Messages forwarded by the buffer until it goes idle, the backpressure signals it sent on the side
+template <typename MessageType>
+std::vector<std::shared_ptr<MessageType>> Drain(Buffer<MessageType>& bufferModel, BufferState<MessageType>& bufferState,
+                                                std::vector<FlowControl>* signals = nullptr) {
+    std::vector<std::shared_ptr<MessageType>> sent;
+    while (bufferModel.timeAdvance(bufferState) != std::numeric_limits<double>::infinity()) {
+        bufferModel.output_port -> clear();
+        bufferModel.output_backpressure -> clear();
+        bufferModel.output(bufferState);
+        for (const auto& msg : bufferModel.output_port -> getBag()) {
+            sent.push_back(msg);
+        }
+        if (signals) {
+            for (FlowControl signal : bufferModel.output_backpressure -> getBag()) {
+                signals -> push_back(signal);
+            }
+        }
+        bufferModel.internalTransition(bufferState);
+    }
+    return sent;
+}
+
+std::string Join(const std::vector<std::shared_ptr<std::string>>& messages) {
+    std::string text;
+    for (const auto& msg : messages) {
+        text += *msg;
+    }
+    return text;
+}
+
+// AppendEntries as the leader of a three-node cluster emits them
+class LeaderMessages {
+    public:
+        LeaderMessages() : controller("node0") {
+            state.nodeID = "node0";
+            state.peers = {"node1", "node2"};
+            RaftControllerModel::InternClusterMembers(state);
+            state.state = RaftStatus::LEADER;
+            state.currentTerm = 1;
+            state.readMode = ReadMode::READ_INDEX;
+        }
+
+        // The heartbeat loop's broadcast
+        std::shared_ptr<RaftMessage> heartbeat() {
+            controller.CheckAndTransitionHeartbeat(state, HeartbeatStatus::UPDATE);
+            return take();
+        }
+
+        // Client commands replicated in one broadcast
+        std::shared_ptr<RaftMessage> replication(int commands) {
+            std::vector<std::shared_ptr<IMessage<LogEntryType>>> entries;
+            for (int i = 0; i < commands; i++) {
+                entries.push_back(std::make_shared<LogEntryExternal>(ClientCommand{"client", static_cast<uint64_t>(i), "key", "value"}));
+            }
+            controller.SendAppendEntries(state, entries);
+            return take();
+        }
+
+        // The empty round a ReadIndex read waits on
+        std::shared_ptr<RaftMessage> readConfirmation() {
+            state.confirmedRound = state.round;
+            std::vector<std::shared_ptr<IMessage<LogEntryType>>> accepted;
+            ClientCommand read{"client", ++reads, "key", "", ClientOperation::READ};
+            controller.HandleClientRequest(state, std::make_shared<ClientRequest>(read), "client", accepted);
+            controller.ServeReads(state);
+            return take();
+        }
+
+    private:
+        RaftControllerModel controller;
+        RaftState state;
+        uint64_t reads = 100;
+
+        std::shared_ptr<RaftMessage> take() {
+            std::shared_ptr<RaftMessage> message = state.raftOutMessages.back();
+            state.raftOutMessages.clear();
+            return message;
+        }
+};
+
+TEST(TestBuffer, TestRingWrapsAndGrows) {
+    RingBuffer<int> bounded(3);
+    for (int i = 0; i < 10; i++) {
+        ASSERT_TRUE(bounded.push_back(i));
+        if (bounded.size() == 3) {
+            ASSERT_FALSE(bounded.push_back(-1));
+            ASSERT_EQ(bounded.front(), i - 2);
+            bounded.pop_front();
+        }
+    }
+    ASSERT_EQ(bounded[0], 8);
+    ASSERT_EQ(bounded[1], 9);
+
+    RingBuffer<int> unbounded;
+    unbounded.push_back(-1);
+    unbounded.pop_front();
+    for (int i = 0; i < 20; i++) {
+        ASSERT_TRUE(unbounded.push_back(i));
+    }
+    unbounded.erase(5);
+    ASSERT_EQ(unbounded.size(), 19);
+    ASSERT_EQ(unbounded[4], 4);
+    ASSERT_EQ(unbounded[5], 6);
+    ASSERT_EQ(unbounded[18], 19);
+}
+
+TEST(TestBuffer, TestDropTailAndDropOldest) {
+    for (OverflowPolicy policy : {OverflowPolicy::DROP_TAIL, OverflowPolicy::DROP_OLDEST}) {
+        Buffer<std::string> bufferModel("nodeBuffer");
+        bufferModel.setCapacity(3, policy);
+        BufferState<std::string> bufferState = bufferModel.getState();
+        for (const std::string text : {"a", "b", "c", "d", "e"}) {
+            bufferModel.input_port -> addMessage(std::make_shared<std::string>(text));
+        }
+        bufferModel.externalTransition(bufferState, 0);
+        ASSERT_EQ(bufferState.dropped, 2);
+        ASSERT_EQ(bufferState.highWater, 3);
+        ASSERT_EQ(Join(Drain(bufferModel, bufferState)), policy == OverflowPolicy::DROP_TAIL ? "abc" : "cde");
+    }
+}
+
+TEST(TestBuffer, TestDropHeartbeatsFirst) {
+    LeaderMessages leader;
+    auto heartbeat = leader.heartbeat();
+    auto entries = leader.replication(1);
+    auto confirmation = leader.readConfirmation();
+    auto vote = std::make_shared<RaftMessage>(std::make_shared<RequestVote>());
+    ASSERT_TRUE(std::static_pointer_cast<AppendEntries>(confirmation -> content) -> metadata.entries.empty());
+    ASSERT_TRUE(heartbeat -> isHeartbeat());
+    ASSERT_FALSE(entries -> isHeartbeat());
+    ASSERT_FALSE(confirmation -> isHeartbeat());
+    ASSERT_FALSE(vote -> isHeartbeat());
+
+    Buffer<RaftMessage> bufferModel("nodeBuffer");
+    bufferModel.setCapacity(3, OverflowPolicy::DROP_HEARTBEATS);
+    BufferState<RaftMessage> bufferState = bufferModel.getState();
+    // The queued heartbeat makes room for the vote, then the arriving heartbeat is the one dropped
+    for (const auto& msg : {heartbeat, entries, confirmation, vote, leader.heartbeat()}) {
+        bufferModel.input_port -> addMessage(msg);
+    }
+    bufferModel.externalTransition(bufferState, 0);
+    ASSERT_EQ(bufferState.dropped, 2);
+    ASSERT_EQ(Drain(bufferModel, bufferState), std::vector<std::shared_ptr<RaftMessage>>({entries, confirmation, vote}));
+}
+
+TEST(TestBuffer, TestBackpressureStopsAndResumesUpstream) {
+    Buffer<std::string> bufferModel("nodeBuffer");
+    bufferModel.setCapacity(4, OverflowPolicy::BACKPRESSURE);
+    BufferState<std::string> bufferState = bufferModel.getState();
+    for (const std::string text : {"a", "b", "c", "d", "e"}) {
+        bufferModel.input_port -> addMessage(std::make_shared<std::string>(text));
+    }
+    bufferModel.externalTransition(bufferState, 0);
+    ASSERT_TRUE(bufferState.backpressure);
+    ASSERT_EQ(bufferState.dropped, 1);
+
+    // Stop goes out with the first message, resume once two are left
+    std::vector<FlowControl> signals;
+    ASSERT_EQ(Join(Drain(bufferModel, bufferState, &signals)), "abcd");
+    ASSERT_EQ(signals, std::vector<FlowControl>({FlowControl::STOP, FlowControl::RESUME}));
+    ASSERT_FALSE(bufferState.backpressure);
+}
+
+TEST(TestBuffer, TestStrictPriorityServesVotesFirst) {
+    LeaderMessages leader;
+    auto vote = std::make_shared<RaftMessage>(std::make_shared<RequestVote>());
+    auto heartbeat = leader.heartbeat();
+    std::vector<std::shared_ptr<RaftMessage>> batches = {leader.replication(1), leader.replication(2), leader.replication(3)};
+    auto confirmation = leader.readConfirmation();
+    ASSERT_EQ(vote -> priorityClass(), 0);
+    ASSERT_EQ(heartbeat -> priorityClass(), 1);
+    ASSERT_EQ(batches[0] -> priorityClass(), 2);
+    ASSERT_EQ(confirmation -> priorityClass(), 2);
+
+    Buffer<RaftMessage> bufferModel("nodeBuffer");
+    bufferModel.setScheduling(SchedulingPolicy::STRICT_PRIORITY);
+    BufferState<RaftMessage> bufferState = bufferModel.getState();
+    for (const auto& msg : {batches[0], confirmation, batches[1], heartbeat, batches[2], vote}) {
+        bufferModel.input_port -> addMessage(msg);
+    }
+    bufferModel.externalTransition(bufferState, 0);
+    // The heartbeat overtakes the bulk replication queued before it
+    std::vector<std::shared_ptr<RaftMessage>> expected = {vote, heartbeat, batches[0], confirmation, batches[1], batches[2]};
+    ASSERT_EQ(Drain(bufferModel, bufferState), expected);
+}
+
+TEST(TestBuffer, TestWeightedFairSharesService) {
+    // Class of each message in a string, the digit is the class
+    struct Classed {
+        std::string text;
+        size_t priorityClass() const {
+            return text[0] - '0';
+        }
+    };
+    Buffer<Classed> bufferModel("nodeBuffer");
+    bufferModel.setScheduling(SchedulingPolicy::WEIGHTED_FAIR, {3, 1, 0, 0});
+    bufferModel.setBatching(4);
+    BufferState<Classed> bufferState = bufferModel.getState();
+    for (int i = 0; i < 30; i++) {
+        bufferModel.input_port -> addMessage(std::make_shared<Classed>(Classed{std::to_string(i % 2)}));
+    }
+    bufferModel.externalTransition(bufferState, 0);
+
+    // 3:1 while both classes are backlogged, then class 1 drains alone
+    std::string order;
+    for (const auto& msg : Drain(bufferModel, bufferState)) {
+        order += msg -> text;
+    }
+    ASSERT_EQ(order.size(), 30);
+    ASSERT_EQ(std::count(order.begin(), order.begin() + 20, '0'), 15);
+    ASSERT_EQ(order.substr(20), std::string(10, '1'));
+}
+
 // Main function for Google Test
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv); 
@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+#include <set>
+#include "../client.hpp"
+
+
+class ClientAtomicFixture: public ::testing::Test
+{
+protected:
+    std::unique_ptr<ClientModel> model;
+    ClientState state{};
+
+    void InitModel(const ClientConfig& config)
+    {
+        model = std::make_unique<ClientModel>("client", config);
+        state = model -> getState();
+    }
+
+    static ClientConfig ClosedLoop(size_t outstanding) {
+        ClientConfig config;
+        config.arrivals = ArrivalProcess::CLOSED_LOOP;
+        config.outstanding = outstanding;
+        config.servers = {"node0", "node1", "node2"};
+        return config;
+    }
+
+    // Output then internal transition, returns the requests sent
+    std::vector<std::shared_ptr<Packet>> Step() {
+        model -> output(state);
+        std::vector<std::shared_ptr<Packet>> sent = model -> output_packet -> getBag();
+        model -> output_packet -> clear();
+        model -> internalTransition(state);
+        return sent;
+    }
+
+    static ClientCommand Command(const std::shared_ptr<Packet>& packet) {
+        auto message = std::static_pointer_cast<RaftMessage>(packet -> payload);
+        return std::static_pointer_cast<ClientRequest>(message -> content) -> command;
+    }
+
+    void Respond(const std::string& node, const ClientResponseMetadata& metadata, double e) {
+        auto message = std::make_shared<RaftMessage>(std::make_shared<ClientResponse>(metadata));
+        message -> source = node;
+        message -> dest = "client";
+        model -> input_packet -> addMessage(std::make_shared<Packet>(message, "client", node));
+        model -> externalTransition(state, e);
+        model -> input_packet -> clear();
+    }
+
+    static ClientResponseMetadata Redirect(uint64_t requestID, const std::string& hint) {
+        ClientResponseMetadata metadata;
+        metadata.requestID = requestID;
+        metadata.status = ClientStatus::REDIRECT;
+        metadata.leaderHint = hint;
+        return metadata;
+    }
+};
+
+
+// Open-loop requests go to the first server, the next one is scheduled once a request is out
+TEST_F(ClientAtomicFixture, testPoissonSendsToFirstServer) {
+    ClientConfig config;
+    config.rate = 1000;
+    config.requests = 2;
+    config.servers = {"node0", "node1"};
+    InitModel(config);
+
+    auto sent = Step();
+    ASSERT_EQ(sent.size(), 1);
+    ASSERT_EQ(sent.front() -> destination, "node0");
+    auto message = std::static_pointer_cast<RaftMessage>(sent.front() -> payload);
+    ASSERT_EQ(message -> content -> getType(), Task::CLIENT_REQUEST);
+    ASSERT_EQ(Command(sent.front()).value.size(), config.valueSize);
+    ASSERT_EQ(state.issued, 2);
+
+    // The budget is spent, only the second request and the two timeouts remain
+    ASSERT_EQ(Step().size(), 1);
+    ASSERT_EQ(state.issued, 2);
+}
+
+// Reads carry no value
+TEST_F(ClientAtomicFixture, testReadFraction) {
+    ClientConfig config = ClosedLoop(4);
+    config.readFraction = 1;
+    InitModel(config);
+    for (const auto& packet : Step()) {
+        ASSERT_EQ(Command(packet).operation, ClientOperation::READ);
+        ASSERT_TRUE(Command(packet).value.empty());
+    }
+}
+
+// Spread reads pick their own server and keep it, writes follow the client's target
+TEST_F(ClientAtomicFixture, testSpreadReads) {
+    RandomNumberGeneratorDEVS::seed(1);
+    ClientConfig config = ClosedLoop(32);
+    config.readFraction = 0.5;
+    config.spreadReads = true;
+    InitModel(config);
+    std::set<std::string> readServers;
+    for (const auto& packet : Step()) {
+        if (Command(packet).operation == ClientOperation::READ) {
+            readServers.insert(packet -> destination);
+            ASSERT_EQ(packet -> destination, state.inFlight.at(Command(packet).requestID).server);
+        } else {
+            ASSERT_EQ(packet -> destination, "node0");
+        }
+    }
+    ASSERT_EQ(readServers.size(), 3);
+}
+
+// A hinted redirect is retried at once, one without a hint waits and tries the next node
+TEST_F(ClientAtomicFixture, testRedirects) {
+    InitModel(ClosedLoop(1));
+    ASSERT_EQ(Step().size(), 1);
+
+    Respond("node0", Redirect(1, "node2"), 0.001);
+    ASSERT_EQ(model -> timeAdvance(state), 0);
+    auto sent = Step();
+    ASSERT_EQ(sent.front() -> destination, "node2");
+
+    Respond("node2", Redirect(1, ""), 0.001);
+    ASSERT_DOUBLE_EQ(model -> timeAdvance(state), model -> getConfig().redirectBackoff);
+    sent = Step();
+    ASSERT_EQ(sent.front() -> destination, "node0");
+    ASSERT_EQ(state.inFlight.at(1).redirects, 2);
+    ASSERT_EQ(state.inFlight.at(1).sends, 3);
+}
+
+// Closed loop keeps `outstanding` requests in flight and records their timestamps
+TEST_F(ClientAtomicFixture, testClosedLoopRecordsTimes) {
+    InitModel(ClosedLoop(2));
+    ASSERT_EQ(Step().size(), 2);
+
+    ClientResponseMetadata ok;
+    ok.requestID = 2;
+    ok.logIndex = 5;
+    ok.commitTime = 0.003;
+    ok.applyTime = 0.003;
+    Respond("node0", ok, 0.004);
+
+    ASSERT_EQ(state.completed.size(), 1);
+    const ClientRecord& record = state.completed.front();
+    ASSERT_EQ(record.requestID, 2);
+    ASSERT_EQ(record.logIndex, 5);
+    ASSERT_DOUBLE_EQ(record.submitTime, 0);
+    ASSERT_DOUBLE_EQ(record.commitTime, 0.003);
+    ASSERT_DOUBLE_EQ(record.responseTime, 0.004);
+    ASSERT_DOUBLE_EQ(state.latencyPercentile(0.5), 0.004);
+
+    // The response frees a slot, a third request is sent straight away
+    ASSERT_EQ(state.inFlight.size(), 2);
+    ASSERT_EQ(model -> timeAdvance(state), 0);
+    auto sent = Step();
+    ASSERT_EQ(sent.size(), 1);
+    ASSERT_EQ(Command(sent.front()).requestID, 3);
+}
+
+// Reads count towards read latency, only writes towards commit latency
+TEST_F(ClientAtomicFixture, testCommitLatencyCountsWritesOnly) {
+    RandomNumberGeneratorDEVS::seed(3);
+    MetricsRegistry registry;
+    MetricsRegistry::Activate(&registry);
+    ClientConfig config = ClosedLoop(8);
+    config.readFraction = 0.5;
+    config.requests = 8;
+    InitModel(config);
+    ASSERT_EQ(Step().size(), 8);
+
+    uint64_t reads = 0;
+    std::vector<uint64_t> requestIDs;
+    for (const auto& [requestID, request] : state.inFlight) {
+        requestIDs.push_back(requestID);
+        reads += request.operation == ClientOperation::READ;
+    }
+    for (uint64_t requestID : requestIDs) {
+        ClientResponseMetadata ok;
+        ok.requestID = requestID;
+        ok.commitTime = 0.002;
+        Respond("node0", ok, 0.001);
+    }
+    MetricsRegistry::Activate(nullptr);
+
+    ASSERT_GT(reads, 0);
+    ASSERT_LT(reads, 8);
+    ASSERT_EQ(registry.findHistogram("client/latency") -> count(), 8);
+    ASSERT_EQ(registry.findHistogram("client/read_latency") -> count(), reads);
+    ASSERT_EQ(registry.findHistogram("client/commit_latency") -> count(), 8 - reads);
+}
+
+// Silence moves the request to the next node
+TEST_F(ClientAtomicFixture, testTimeoutTriesNextServer) {
+    InitModel(ClosedLoop(1));
+    ASSERT_EQ(Step().size(), 1);
+    ASSERT_DOUBLE_EQ(model -> timeAdvance(state), model -> getConfig().timeout);
+    ASSERT_EQ(Step().size(), 0);
+    auto sent = Step();
+    ASSERT_EQ(sent.size(), 1);
+    ASSERT_EQ(sent.front() -> destination, "node1");
+    ASSERT_DOUBLE_EQ(state.inFlight.at(1).submitTime, 0);
+}
+
+// Low ranks dominate a skewed Zipf distribution
+TEST_F(ClientAtomicFixture, testZipfIsSkewed) {
+    RandomNumberGeneratorDEVS::seed(1);
+    ZipfDistribution zipf(1000, 0.99);
+    size_t hot = 0;
+    for (int i = 0; i < 10000; i++) {
+        hot += zipf.sample() < 10;
+    }
+    // About 39% of draws for theta 0.99, uniform keys would give 1%
+    ASSERT_GT(hot, 3000);
+    ASSERT_LT(hot, 5000);
+}
+
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include "../disk.hpp"
+
+
+class DiskAtomicFixture: public ::testing::Test
+{
+protected:
+    std::unique_ptr<DiskModel> model;
+    DiskState state{};
+
+    void SetUp() override
+    {
+        InitModel();
+    }
+
+    void InitModel()
+    {
+        model.reset();
+        model = std::make_unique<DiskModel>("disk");
+    }
+
+    // 1ms fsyncs, writes themselves take no time
+    static DiskConfig ConstantFsync() {
+        DiskConfig config;
+        config.bandwidth = std::numeric_limits<double>::infinity();
+        config.fsyncMean = 1e-3;
+        config.fsyncDistribution = FsyncDistribution::CONSTANT;
+        return config;
+    }
+
+    static std::shared_ptr<RaftMessage> Vote() {
+        return std::make_shared<RaftMessage>(std::make_shared<RequestVote>());
+    }
+
+    static std::shared_ptr<RaftMessage> Append(size_t entries) {
+        AppendEntriesMetadata metadata;
+        for (size_t i = 0; i < entries; i++) {
+            metadata.entries.push_back(std::make_shared<LogEntryHeartbeat>());
+        }
+        auto message = std::make_shared<RaftMessage>(std::make_shared<AppendEntries>(metadata, ""));
+        message -> dest = "*";
+        return message;
+    }
+
+    void Receive(std::shared_ptr<RaftMessage> msg, double e) {
+        model -> input_raft_message -> addMessage(msg);
+        model -> externalTransition(state, e);
+        model -> input_raft_message -> clear();
+    }
+
+    // Output then internal transition, returns the number of messages sent
+    size_t Step() {
+        model -> output(state);
+        size_t sent = model -> output_raft_message -> getBag().size();
+        model -> output_raft_message -> clear();
+        model -> internalTransition(state);
+        return sent;
+    }
+};
+
+
+// Without a config every message passes straight through
+TEST_F(DiskAtomicFixture, testPassThroughWithoutConfig) {
+    Receive(Append(3), 0);
+    ASSERT_EQ(model -> timeAdvance(state), 0);
+    ASSERT_EQ(Step(), 1);
+    ASSERT_EQ(model -> timeAdvance(state), std::numeric_limits<double>::infinity());
+    ASSERT_EQ(state.fsyncs, 0);
+}
+
+// Writes arriving while the device is busy share the next fsync
+TEST_F(DiskAtomicFixture, testGroupCommit) {
+    for (bool groupCommit : {true, false}) {
+        InitModel();
+        state = DiskState{};
+        DiskConfig config = ConstantFsync();
+        config.groupCommit = groupCommit;
+        model -> setConfig(config);
+
+        Receive(Vote(), 0);
+        ASSERT_DOUBLE_EQ(model -> timeAdvance(state), 1e-3);
+        Receive(Vote(), 2e-4);
+        Receive(Vote(), 2e-4);
+        ASSERT_DOUBLE_EQ(model -> timeAdvance(state), 6e-4);
+        ASSERT_EQ(Step(), 1);
+
+        if (groupCommit) {
+            // Both waiting votes are durable after one more fsync and leave together
+            ASSERT_DOUBLE_EQ(model -> timeAdvance(state), 1e-3);
+            ASSERT_EQ(Step(), 2);
+            ASSERT_EQ(state.fsyncs, 2);
+        } else {
+            ASSERT_EQ(Step(), 1);
+            ASSERT_EQ(Step(), 1);
+            ASSERT_EQ(state.fsyncs, 3);
+        }
+        ASSERT_DOUBLE_EQ(state.currentTime, groupCommit ? 2e-3 : 3e-3);
+        ASSERT_EQ(model -> timeAdvance(state), std::numeric_limits<double>::infinity());
+    }
+}
+
+// A deeper queue runs independent fsyncs side by side
+TEST_F(DiskAtomicFixture, testQueueDepth) {
+    DiskConfig config = ConstantFsync();
+    config.groupCommit = false;
+    config.queueDepth = 2;
+    model -> setConfig(config);
+
+    model -> input_raft_message -> addMessage(Vote());
+    model -> input_raft_message -> addMessage(Vote());
+    model -> externalTransition(state, 0);
+    ASSERT_DOUBLE_EQ(model -> timeAdvance(state), 1e-3);
+    ASSERT_EQ(Step(), 2);
+    ASSERT_DOUBLE_EQ(state.currentTime, 1e-3);
+}
+
+// Write time grows with the entries persisted
+TEST_F(DiskAtomicFixture, testBandwidth) {
+    DiskConfig config = ConstantFsync();
+    config.bandwidth = 1e6;
+    model -> setConfig(config);
+
+    auto message = Append(4);
+    size_t bytes = model -> PersistBytes(*message);
+    ASSERT_GT(bytes, 4 * config.entryOverhead);
+    Receive(message, 0);
+    ASSERT_DOUBLE_EQ(model -> timeAdvance(state), bytes / 1e6 + 1e-3);
+    ASSERT_EQ(state.bytesWritten, bytes);
+}
+
+// With overlap the leader's AppendEntries leaves at once, a vote still waits for its fsync
+TEST_F(DiskAtomicFixture, testOverlapSend) {
+    DiskConfig config = ConstantFsync();
+    config.overlapSend = true;
+    model -> setConfig(config);
+
+    model -> input_raft_message -> addMessage(Append(2));
+    model -> input_raft_message -> addMessage(Vote());
+    model -> externalTransition(state, 0);
+    ASSERT_EQ(model -> timeAdvance(state), 0);
+    ASSERT_EQ(Step(), 1);
+
+    // Both writes are still made durable by the one fsync
+    ASSERT_DOUBLE_EQ(model -> timeAdvance(state), 1e-3);
+    ASSERT_EQ(Step(), 1);
+    ASSERT_EQ(state.fsyncs, 1);
+}
+
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
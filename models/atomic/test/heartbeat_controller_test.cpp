@@ -16,6 +16,11 @@ protected:
         model.reset();
         model = std::make_unique<HeartbeatControllerModel>("heartbeatController");
     }
+
+    // Queue an update from the Raft controller, with the fixed timeouts unless given
+    void Send(HeartbeatStatus status, double interval = HEARTBEAT_INTERVAL, double electionMin = ELECTION_TIMEOUT_MIN) {
+        model->input_heartbeat_update->addMessage(HeartbeatUpdate{status, interval, electionMin});
+    }
 };
 
 // Test initialization of the model
@@ -27,7 +32,7 @@ TEST_F(HeartbeatControllerAtomicFixture, testBuildNetworkAtomicModel) {
 // Test external transition for ALIVE heartbeat update
 TEST_F(HeartbeatControllerAtomicFixture, testExternalTransitionAlive) {
     // Simulate an ALIVE heartbeat update
-    model->input_heartbeat_update->addMessage(HeartbeatStatus::ALIVE);
+    Send(HeartbeatStatus::ALIVE);
     model->externalTransition(state, 0.350); // Assume 350ms for time
     
     // Check that the heartbeatTimeout was set to a random value between 0.150 and 0.300
@@ -35,6 +40,15 @@ TEST_F(HeartbeatControllerAtomicFixture, testExternalTransitionAlive) {
     ASSERT_LT(state.heartbeatTimeout, 0.300);
 }
 
+// Test that an event which does not restart the countdown leaves the remaining time
+TEST_F(HeartbeatControllerAtomicFixture, testExternalTransitionKeepsCountdown) {
+    state.heartbeatTimeout = 0.25;
+    Send(HeartbeatStatus::TIMEOUT);
+    model->externalTransition(state, 0.1);
+    ASSERT_DOUBLE_EQ(model->timeAdvance(state), 0.15);
+    ASSERT_DOUBLE_EQ(model->timeAdvance(state), 0.15);
+}
+
 // Test internal transition
 TEST_F(HeartbeatControllerAtomicFixture, testInternalTransition) {
     // Simulate an internal transition
@@ -67,6 +81,74 @@ TEST_F(HeartbeatControllerAtomicFixture, testTimeAdvance) {
     ASSERT_EQ(model->timeAdvance(state), 0.25);
 }
 
+// Test the estimator against hand-computed RFC 6298 updates
+TEST(RttEstimatorTest, testSmoothing) {
+    RttEstimator estimator;
+    estimator.observe(0.010);
+    ASSERT_DOUBLE_EQ(estimator.smoothed(), 0.010);
+    ASSERT_DOUBLE_EQ(estimator.variation(), 0.005);
+    ASSERT_DOUBLE_EQ(estimator.timeout(), 0.030);
+
+    estimator.observe(0.018);
+    ASSERT_DOUBLE_EQ(estimator.variation(), 0.75 * 0.005 + 0.25 * 0.008);
+    ASSERT_DOUBLE_EQ(estimator.smoothed(), 0.875 * 0.010 + 0.125 * 0.018);
+    ASSERT_EQ(estimator.count(), 2);
+}
+
+// Test that adaptive timers keep the fixed values until the first sample, then follow it within bounds
+TEST(ElectionTimersTest, testAdaptiveTimers) {
+    TimeoutConfig config;
+    config.adaptive = true;
+    ElectionTimers timers(config);
+    ASSERT_DOUBLE_EQ(timers.heartbeatInterval(), HEARTBEAT_INTERVAL);
+    ASSERT_DOUBLE_EQ(timers.electionTimeoutMin(), ELECTION_TIMEOUT_MIN);
+
+    // 3 heartbeats of 5ms plus an RTO of 10 + 4 * 5ms
+    timers.observe(0.010);
+    ASSERT_DOUBLE_EQ(timers.heartbeatInterval(), 0.005);
+    ASSERT_DOUBLE_EQ(timers.electionTimeoutMin(), 0.045);
+
+    // Slow links hit the upper bounds, fast ones the lower bound of the heartbeat
+    timers.assume(5.0, 1.0);
+    ASSERT_DOUBLE_EQ(timers.heartbeatInterval(), config.maxHeartbeat);
+    ASSERT_DOUBLE_EQ(timers.electionTimeoutMin(), config.maxElection);
+    timers.assume(0.0001, 0.00001);
+    ASSERT_DOUBLE_EQ(timers.heartbeatInterval(), config.minHeartbeat);
+    ASSERT_LE(timers.leaseTimeout(), timers.electionTimeoutMin());
+}
+
+// Test that fixed timers ignore the samples
+TEST(ElectionTimersTest, testFixedTimersIgnoreSamples) {
+    ElectionTimers timers;
+    timers.observe(1.0);
+    ASSERT_DOUBLE_EQ(timers.heartbeatInterval(), HEARTBEAT_INTERVAL);
+    ASSERT_DOUBLE_EQ(timers.electionTimeoutMin(), ELECTION_TIMEOUT_MIN);
+    ASSERT_DOUBLE_EQ(timers.leaseTimeout(), ELECTION_TIMEOUT_MIN);
+}
+
+// Test that the countdowns follow the timeouts the Raft controller passes on
+TEST_F(HeartbeatControllerAtomicFixture, testUpdatesCarryTimeouts) {
+    for (int i = 0; i < 10; i++) {
+        Send(HeartbeatStatus::ALIVE, 0.005, 0.045);
+        model->externalTransition(state, 0.001);
+        model->input_heartbeat_update->clear();
+        ASSERT_GE(state.heartbeatTimeout, 0.045);
+        ASSERT_LE(state.heartbeatTimeout, 0.090);
+    }
+
+    Send(HeartbeatStatus::UPDATE, 0.010, 0.045);
+    model->externalTransition(state, 0.001);
+    model->input_heartbeat_update->clear();
+    ASSERT_DOUBLE_EQ(model->timeAdvance(state), 0.010);
+
+    // A new interval while the loop runs leaves the heartbeat already due
+    Send(HeartbeatStatus::UPDATE, 0.020, 0.070);
+    model->externalTransition(state, 0.004);
+    ASSERT_DOUBLE_EQ(model->timeAdvance(state), 0.006);
+    model->internalTransition(state);
+    ASSERT_DOUBLE_EQ(model->timeAdvance(state), 0.020);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv); 
     return RUN_ALL_TESTS();
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "../message_processor.hpp"
+#include "../packet_processor.hpp"
 
 
 class MessageProcessorAtomicFixture: public ::testing::Test
@@ -27,6 +28,65 @@ TEST_F(MessageProcessorAtomicFixture, testBuildNetworkAtomicModel) {
     ASSERT_TRUE(model != nullptr);
 }
 
+// Test that the processors of a node queue for the same cores
+TEST_F(MessageProcessorAtomicFixture, testSharedCpuQueuesBothProcessors) {
+    ServiceTimes times;
+    times.exponential = false;
+    times.decode[Task::VOTE_REQUEST] = 3e-6;
+
+    for (size_t cores : {1, 2}) {
+        auto cpu = std::make_shared<CpuPool>(cores);
+        MessageProcessorModel messageProcessor("message-processor");
+        PacketProcessorModel packetProcessor("packet-processor");
+        messageProcessor.setCpu(cpu, times);
+        packetProcessor.setCpu(cpu, times);
+        MessageProcessorState encoding;
+        PacketProcessorState decoding;
+
+        for (int i = 0; i < 2; i++) {
+            messageProcessor.in_raft_message -> addMessage(std::make_shared<RaftMessage>(std::make_shared<RequestVote>()));
+        }
+        packetProcessor.input_packet -> addMessage(std::make_shared<Packet>(std::make_shared<RaftMessage>(std::make_shared<RequestVote>()), "node1", "node0"));
+        messageProcessor.externalTransition(encoding, 0);
+        packetProcessor.externalTransition(decoding, 0);
+
+        if (cores == 1) {
+            // 1us, 1us, then the 3us decode, one after another
+            ASSERT_DOUBLE_EQ(messageProcessor.timeAdvance(encoding), 1e-6);
+            messageProcessor.internalTransition(encoding);
+            ASSERT_DOUBLE_EQ(messageProcessor.timeAdvance(encoding), 1e-6);
+            ASSERT_DOUBLE_EQ(packetProcessor.timeAdvance(decoding), 5e-6);
+        } else {
+            // Both encodes finish together and leave in one bag
+            ASSERT_DOUBLE_EQ(messageProcessor.timeAdvance(encoding), 1e-6);
+            messageProcessor.output(encoding);
+            ASSERT_EQ(messageProcessor.out_packet -> getBag().size(), 2);
+            messageProcessor.internalTransition(encoding);
+            ASSERT_EQ(messageProcessor.timeAdvance(encoding), std::numeric_limits<double>::infinity());
+            ASSERT_DOUBLE_EQ(packetProcessor.timeAdvance(decoding), 4e-6);
+        }
+        ASSERT_EQ(cpu -> getJobs(), 3);
+        ASSERT_DOUBLE_EQ(cpu -> getBusyTime(), 5e-6);
+    }
+}
+
+// Test that service time grows with entries and authentication
+TEST_F(MessageProcessorAtomicFixture, testServiceTimeBySizeAndCrypto) {
+    ServiceTimes times;
+    AppendEntriesMetadata metadata;
+    metadata.entries.resize(10);
+    RaftMessage batch(std::make_shared<AppendEntries>(metadata, "msgDigestSigned"));
+    ASSERT_DOUBLE_EQ(times.mean(CpuStage::ENCODE, batch), times.base + 10 * times.perEntry);
+
+    batch.macVector = {{"node1", "tag"}, {"node2", "tag"}};
+    ASSERT_DOUBLE_EQ(times.mean(CpuStage::ENCODE, batch), times.base + 10 * times.perEntry + 2 * times.mac);
+    ASSERT_DOUBLE_EQ(times.mean(CpuStage::DECODE, batch), times.base + 10 * times.perEntry + times.mac);
+
+    RaftMessage vote(std::make_shared<RequestVote>(RequestMetadata{}, "signature"));
+    ASSERT_DOUBLE_EQ(times.mean(CpuStage::ENCODE, vote), times.base + times.sign);
+    ASSERT_DOUBLE_EQ(times.mean(CpuStage::DECODE, vote), times.base + times.verify);
+}
+
 
 // Main function for Google Test
 int main(int argc, char **argv) {
@@ -113,6 +113,89 @@ TEST_F(NetworkAtomicFixture, testtimeAdvanceWithEvents) {
     EXPECT_TRUE(next_time > 0 && next_time != std::numeric_limits<double>::infinity());
 }
 
+// Test 7: Delay line ordering - due order, ties in push order, overdue entries taken with the current time
+TEST(DelayLineTest, testDueOrder) {
+    DelayLine<int> line;
+    line.push(1, 0, 3.0);
+    line.push(2, 0, 1.0);
+    line.push(3, 0, 2.0);
+    line.push(4, 0, 1.0);
+    line.push(5, 0, 1.0);
+    EXPECT_EQ(line.nextDue(), 1.0);
+    EXPECT_EQ(line.timeUntilNext(0.25), 0.75);
+    EXPECT_EQ(line.timeUntilNext(5), 0);
+
+    std::vector<int> visited;
+    line.forEachDue([&](const DelayLine<int>::Entry& entry) { visited.push_back(entry.item); });
+    std::vector<int> popped;
+    for (const auto& entry : line.popDue()) {
+        popped.push_back(entry.item);
+    }
+    EXPECT_EQ(visited, std::vector<int>({2, 4, 5}));
+    EXPECT_EQ(popped, visited);
+
+    // Both remaining entries are overdue at 3.5
+    popped.clear();
+    for (const auto& entry : line.popDue(3.5)) {
+        popped.push_back(entry.item);
+    }
+    EXPECT_EQ(popped, std::vector<int>({3, 1}));
+    EXPECT_TRUE(line.empty());
+    EXPECT_EQ(line.timeUntilNext(0), std::numeric_limits<double>::infinity());
+}
+
+// Test 8: Packets due at the same instant leave in one output, time advance is the time left
+TEST_F(NetworkAtomicFixture, testCoDuePacketsLeaveTogether) {
+    std::shared_ptr<RaftMessage> raftMessage = std::make_shared<RaftMessage>();
+    state.packetQueue.push(std::make_shared<Packet>(raftMessage, "node1", "node0"), 0, 2.0);
+    state.packetQueue.push(std::make_shared<Packet>(raftMessage, "node0", "node1"), 0, 2.0);
+    state.packetQueue.push(std::make_shared<Packet>(raftMessage, "node1", "node0"), 0, 3.0);
+    state.currentTime = 0.5;
+    EXPECT_DOUBLE_EQ(model->timeAdvance(state), 1.5);
+
+    model->output(state);
+    EXPECT_EQ(model->output_ports["node0"]->getBag().size(), 1);
+    EXPECT_EQ(model->output_ports["node1"]->getBag().size(), 1);
+    model->internalTransition(state);
+    EXPECT_EQ(state.currentTime, 2.0);
+    EXPECT_EQ(state.packetQueue.size(), 1);
+    EXPECT_DOUBLE_EQ(model->timeAdvance(state), 1.0);
+
+    // An arrival part way through does not restart the wait
+    model->externalTransition(state, 0.25);
+    EXPECT_DOUBLE_EQ(model->timeAdvance(state), 0.75);
+}
+
+// Test 9: Packets to or from a cut off node are lost while the partition lasts, broadcasts still reach the rest
+TEST_F(NetworkAtomicFixture, testPartitionLosesPackets) {
+    NetworkModel network("TestNetwork", {"node0", "node1", "node2"});
+    state.activeNodes = {"node0", "node1", "node2"};
+    state.partitions.push_back(Partition{"node1", 1.0, 2.0});
+    std::shared_ptr<RaftMessage> raftMessage = std::make_shared<RaftMessage>();
+
+    network.input_ports["node0"]->addMessage(std::make_shared<Packet>(raftMessage, "node1", "node0"));
+    network.input_ports["node0"]->addMessage(std::make_shared<Packet>(raftMessage, "*", "node0"));
+    network.externalTransition(state, 1.5);
+    EXPECT_EQ(state.packetQueue.size(), 1);
+    EXPECT_EQ(state.packetQueue.top().item->destination, "node2");
+    network.input_ports["node0"]->clear();
+
+    // Healed
+    network.input_ports["node1"]->addMessage(std::make_shared<Packet>(raftMessage, "node0", "node1"));
+    network.externalTransition(state, 0.5);
+    EXPECT_EQ(state.packetQueue.size(), 2);
+}
+
+// Test 10: Every packet is lost at loss rate 1
+TEST_F(NetworkAtomicFixture, testLossRate) {
+    state.lossRate = 1;
+    std::shared_ptr<RaftMessage> raftMessage = std::make_shared<RaftMessage>();
+    model->input_ports["node0"]->addMessage(std::make_shared<Packet>(raftMessage, "*", "node0"));
+    model->input_ports["node1"]->addMessage(std::make_shared<Packet>(raftMessage, "node0", "node1"));
+    model->externalTransition(state, 1.0);
+    EXPECT_TRUE(state.packetQueue.empty());
+}
+
 
 // Main function for Google Test
 int main(int argc, char **argv) {
@@ -47,6 +47,24 @@ TEST_F(PacketProcessorAtomicFixture, testBuildNetworkAtomicModel) {
     ASSERT_TRUE(model != nullptr);
 }
 
+// Test that backpressure from the buffer holds packets until it is lifted
+TEST_F(PacketProcessorAtomicFixture, testBackpressurePausesForwarding) {
+    mockInputEvent();
+    model -> externalTransition(state, 0);
+    ASSERT_LT(model -> timeAdvance(state), std::numeric_limits<double>::infinity());
+    model -> input_packet -> clear();
+
+    model -> input_backpressure -> addMessage(FlowControl::STOP);
+    model -> externalTransition(state, 0);
+    ASSERT_EQ(model -> timeAdvance(state), std::numeric_limits<double>::infinity());
+    ASSERT_EQ(state.packetQueue.size(), 2);
+    model -> input_backpressure -> clear();
+
+    model -> input_backpressure -> addMessage(FlowControl::RESUME);
+    model -> externalTransition(state, 0);
+    ASSERT_LT(model -> timeAdvance(state), std::numeric_limits<double>::infinity());
+}
+
 
 // Main function for Google Test
 int main(int argc, char **argv) {
@@ -21,6 +21,8 @@ protected:
         model = std::make_unique<RaftControllerModel>("node0");
         state.privateKey = Crypto::PrivateKeyToBase64(Crypto::GeneratePrivateKey()); 
         state.peers = { "node1", "node2" }; // Adding two "peers" to test logic
+        state.nodeID = "node0";
+        RaftControllerModel::InternClusterMembers(state);
     }
 
     // Mock Raft Message
@@ -29,15 +31,14 @@ protected:
         RequestMetadata requestMetadata{1, "node0", 0};
         RequestVote requestVote(requestMetadata, "");
 
-        ResponseMetadata responseMetadata1{1, "node0", 0, true, "node1"};
-        ResponseMetadata responseMetadata2{1, "node0", 0, true, "node2"};
+        // node1 and node2 voted, they sit at index 1 and 2 of the sorted membership
+        QuorumCertificate certificate;
+        certificate.termNumber = 1;
+        certificate.candidateID = "node0";
+        certificate.addVoter(1, "");
+        certificate.addVoter(2, "");
 
-        std::vector<ResponseVote> responseVotes{
-            ResponseVote(responseMetadata1, ""),
-            ResponseVote(responseMetadata2, "")
-        };
-
-        logEntryMetadata entryMetadata{requestVote, responseVotes};
+        logEntryMetadata entryMetadata{requestVote, certificate};
         std::shared_ptr<LogEntryRAFT> logEntry = std::make_shared<LogEntryRAFT>(entryMetadata);
         std::vector<std::shared_ptr<IMessage<LogEntryType>>> logEntries{logEntry};
 
@@ -73,6 +74,8 @@ TEST_F(RaftAtomicFixture, TestHandleResponse) {
     // Init the model
 
     // We are a candidate, we receive a response that's valid. We should expect to store it in our temp storage.
+    state.state = RaftStatus::CANDIDATE;
+    state.currentTerm = 1;
     struct ResponseMetadata metadata { 1, "node0", 0, true, "node1" };
     // Create the expected message 
     std::shared_ptr<ResponseVote> responseVoteMessage =  std::make_shared<ResponseVote>(metadata, "");
@@ -110,8 +113,8 @@ TEST_F(RaftAtomicFixture, TestHandleRAFTEntry) {
     // Set the state 
     auto appendEntries = std::static_pointer_cast<AppendEntries>(newLeaderMessage-> content);
     auto raftEntry = std::static_pointer_cast<LogEntryRAFT>(appendEntries-> metadata.entries[0]);
-    // Verify that our messageList has two entries
-    ASSERT_EQ(raftEntry-> metadata.messageList.size(), 2);
+    // Verify that our certificate carries two votes
+    ASSERT_EQ(raftEntry-> metadata.certificate.voteCount(), 2);
     // Test RAFT Entry
     // Set node 0 as leader
     state.leaderID = "node0";
@@ -120,6 +123,51 @@ TEST_F(RaftAtomicFixture, TestHandleRAFTEntry) {
     ASSERT_EQ(state.messageLog.size(), 1);
 }
 
+TEST_F(RaftAtomicFixture, TestValidateRAFTEntryRejectsMissingQuorum) {
+    // Certificate with a single voter, quorum for three nodes is two
+    QuorumCertificate certificate;
+    certificate.termNumber = 1;
+    certificate.candidateID = "node0";
+    certificate.addVoter(1, "");
+    RequestVote requestVote(RequestMetadata{1, "node0", 0}, "");
+    auto raftEntry = std::make_shared<LogEntryRAFT>(logEntryMetadata{requestVote, certificate});
+
+    ASSERT_FALSE(model->ValidateRAFTEntry(state, raftEntry));
+}
+
+TEST_F(RaftAtomicFixture, TestValidateRAFTEntryRejectsCertificateFromOtherTerm) {
+    auto appendEntries = std::static_pointer_cast<AppendEntries>(MockRaftMessageAppendEntriesNewLeader() -> content);
+    auto raftEntry = std::static_pointer_cast<LogEntryRAFT>(appendEntries -> metadata.entries[0]);
+    ASSERT_TRUE(model->ValidateRAFTEntry(state, raftEntry));
+
+    // The term 1 quorum replayed with a request for term 3
+    RequestVote replayed(RequestMetadata{3, "node0", 0}, "");
+    auto replay = std::make_shared<LogEntryRAFT>(logEntryMetadata{replayed, raftEntry -> metadata.certificate});
+    ASSERT_FALSE(model->ValidateRAFTEntry(state, replay));
+}
+
+TEST_F(RaftAtomicFixture, TestTransitionToLeaderBuildsCertificate) {
+    state.state = RaftStatus::CANDIDATE;
+    state.currentTerm = 1;
+    state.leaderProof = std::make_shared<RequestVote>(RequestMetadata{1, "node0", 0}, "");
+    // node2 answers twice, duplicates must not be counted twice
+    state.tempMessageStorage.emplace_back(std::make_shared<ResponseVote>(ResponseMetadata{1, "node0", 0, true, "node2"}, "sig2"));
+    state.tempMessageStorage.emplace_back(std::make_shared<ResponseVote>(ResponseMetadata{1, "node0", 0, true, "node2"}, "sig2"));
+    state.tempMessageStorage.emplace_back(std::make_shared<ResponseVote>(ResponseMetadata{1, "node0", 0, true, "node1"}, "sig1"));
+
+    model->CheckAndTransitionToLeader(state);
+
+    ASSERT_EQ(state.state, RaftStatus::LEADER);
+    auto appendEntries = std::static_pointer_cast<AppendEntries>(state.raftOutMessages.back()-> content);
+    auto raftEntry = std::static_pointer_cast<LogEntryRAFT>(appendEntries-> metadata.entries.front());
+    const QuorumCertificate& certificate = raftEntry-> metadata.certificate;
+    ASSERT_EQ(certificate.voteCount(), 2);
+    ASSERT_TRUE(certificate.hasVoter(1));
+    ASSERT_TRUE(certificate.hasVoter(2));
+    // Signatures follow bitmap order
+    ASSERT_EQ(certificate.signatures, (std::vector<std::string>{"sig1", "sig2"}));
+}
+
 TEST_F(RaftAtomicFixture, TestHandleHeartbeatEntry) {
     // Init the model
 
@@ -133,6 +181,160 @@ TEST_F(RaftAtomicFixture, TestHandleHeartbeatEntry) {
     ASSERT_EQ(state.messageLog.size(), 1);
 }
 
+/* Test Hash-chained log */
+
+TEST_F(RaftAtomicFixture, TestLogDigestsChainIncrementally) {
+    auto first = std::make_shared<LogEntryHeartbeat>(HeartbeatMetadata{"node1", 0, 0.05, HEARTBEAT_STATUS::PING});
+    auto second = std::make_shared<LogEntryHeartbeat>(HeartbeatMetadata{"node1", 1, 0.10, HEARTBEAT_STATUS::PING});
+    model->AppendLogEntry(state, first);
+    model->AppendLogEntry(state, second);
+
+    ASSERT_EQ(state.logDigests.size(), 2);
+    ASSERT_EQ(state.logDigests[0], Crypto::ChainDigest("", first->toString()));
+    ASSERT_EQ(state.logDigests[1], Crypto::ChainDigest(state.logDigests[0], second->toString()));
+    ASSERT_EQ(state.logIndex, 1);
+}
+
+TEST_F(RaftAtomicFixture, TestAppendEntriesChecksPrefixDigest) {
+    // Follower of node1 with one entry in its log
+    state.leaderID = "node1";
+    model->AppendLogEntry(state, std::make_shared<LogEntryHeartbeat>(HeartbeatMetadata{"node1", 0, 0.05, HEARTBEAT_STATUS::PING}));
+    std::vector<std::shared_ptr<IMessage<LogEntryType>>> entries{
+        std::make_shared<LogEntryHeartbeat>(HeartbeatMetadata{"node1", 1, 0.10, HEARTBEAT_STATUS::PING})
+    };
+
+    // Leader claims a different prefix, nothing is appended
+    AppendEntriesMetadata mismatched{0, "node1", 0, 0, entries, 0, "not-our-digest"};
+    model->HandleAppendEntries(state, std::make_shared<AppendEntries>(mismatched, ""));
+    ASSERT_EQ(state.messageLog.size(), 1);
+
+    // Matching prefix digest, the entry is appended
+    AppendEntriesMetadata matching{0, "node1", 0, 0, entries, 0, state.logDigests[0]};
+    model->HandleAppendEntries(state, std::make_shared<AppendEntries>(matching, ""));
+    ASSERT_EQ(state.messageLog.size(), 2);
+}
+
+TEST_F(RaftAtomicFixture, TestFindDivergenceIndex) {
+    // Two logs sharing their first 37 entries
+    RaftState leader{};
+    for (int i = 0; i < 100; i++) {
+        model->AppendLogEntry(leader, std::make_shared<LogEntryHeartbeat>(HeartbeatMetadata{"node1", i, 0.0, HEARTBEAT_STATUS::PING}));
+        bool diverged = i >= 37;
+        model->AppendLogEntry(state, std::make_shared<LogEntryHeartbeat>(HeartbeatMetadata{diverged ? "node2" : "node1", i, 0.0, HEARTBEAT_STATUS::PING}));
+    }
+
+    int lookups = 0;
+    int divergence = RaftControllerModel::FindDivergenceIndex(state.logDigests, leader.logDigests.size(), [&](int index) {
+        lookups++;
+        return leader.logDigests[index];
+    });
+    ASSERT_EQ(divergence, 37);
+    ASSERT_LE(lookups, 7);  // ceil(log2(100))
+}
+
+TEST_F(RaftAtomicFixture, TestMerkleResyncFindsDivergentTail) {
+    // Leader and follower share 1000 entries, then each has its own 100-entry tail
+    RaftState leader{};
+    for (int i = 0; i < 1100; i++) {
+        bool diverged = i >= 1000;
+        model->AppendLogEntry(leader, std::make_shared<LogEntryHeartbeat>(HeartbeatMetadata{"node1", i, 0.0, HEARTBEAT_STATUS::PING}));
+        model->AppendLogEntry(state, std::make_shared<LogEntryHeartbeat>(HeartbeatMetadata{diverged ? "node2" : "node1", i, 0.0, HEARTBEAT_STATUS::PING}));
+    }
+
+    ResyncReport report = MerkleLogIndex::Reconcile(state.merkleIndex, leader.merkleIndex, [](size_t) { return size_t(1); });
+
+    // Only the segments holding the tail are transferred (segment size 64: 960..1100)
+    ASSERT_EQ(report.divergentRanges.size(), 1);
+    ASSERT_EQ(report.divergentRanges[0].first, 960);
+    ASSERT_EQ(report.divergentRanges[0].second, 1100);
+    ASSERT_EQ(report.entryBytes, 140);
+    // One exchange per tree level (18 leaves -> 5 levels + root) plus the transfer
+    ASSERT_EQ(report.roundTrips, 7);
+
+    // Identical logs are confirmed with the root hash alone
+    model->TruncateLog(state, 1000);
+    model->TruncateLog(leader, 1000);
+    ASSERT_EQ(state.merkleIndex.rootHash(), leader.merkleIndex.rootHash());
+    ASSERT_EQ(MerkleLogIndex::Reconcile(state.merkleIndex, leader.merkleIndex, [](size_t) { return size_t(1); }).roundTrips, 1);
+}
+
+/* Test Authentication */
+
+TEST_F(RaftAtomicFixture, TestHMACModeAcceptsTaggedAndRejectsTampered) {
+    std::string key = Crypto::GenerateSymmetricKey();
+    // Sender node1 shares a key with node0
+    RaftState sender{};
+    sender.nodeID = "node1";
+    sender.peers = { "node0", "node2" };
+    sender.authMode = AuthMode::HMAC;
+    sender.pairwiseKeys = { {"node0", key} };
+    state.authMode = AuthMode::HMAC;
+    state.pairwiseKeys = { {"node1", key} };
+
+    auto raftMessage = std::make_shared<RaftMessage>(std::make_shared<RequestVote>(RequestMetadata{1, "node1", 0}, ""));
+    raftMessage -> source = "node1";
+    raftMessage -> dest = "*";
+    model->AttachMacs(sender, raftMessage);
+
+    // Broadcast carries a tag only for the peers a key is shared with
+    ASSERT_EQ(raftMessage -> macVector.size(), 1);
+    ASSERT_TRUE(model->VerifyAuthenticity(state, raftMessage));
+
+    // Tampering with the content breaks the tag
+    std::static_pointer_cast<RequestVote>(raftMessage -> content) -> metadata.termNumber = 5;
+    ASSERT_FALSE(model->VerifyAuthenticity(state, raftMessage));
+}
+
+TEST_F(RaftAtomicFixture, TestValidateRAFTEntryRejectsStrayVoterBits) {
+    // RSA keys for the three members, node0 (the candidate) and node1 vote
+    state.authMode = AuthMode::RSA;
+    std::vector<std::string> privateKeys;
+    state.publicKeys.clear();
+    for (size_t i = 0; i < state.clusterMembers.size(); i++) {
+        RSA::PrivateKey privateKey = Crypto::GeneratePrivateKey();
+        privateKeys.push_back(Crypto::PrivateKeyToBase64(privateKey));
+        state.publicKeys.push_back(Crypto::PublicKeyToBase64(Crypto::GeneratePublicKey(privateKey)));
+    }
+    RequestVote requestVote(RequestMetadata{1, "node0", 0}, "");
+    auto vote = [&](size_t index) {
+        return Crypto::SignData(ResponseMetadata{1, "node0", 0, true, state.clusterMembers[index]}.toString(), privateKeys[index]);
+    };
+
+    QuorumCertificate certificate;
+    certificate.termNumber = 1;
+    certificate.candidateID = "node0";
+    certificate.addVoter(0, vote(0));
+    certificate.addVoter(1, vote(1));
+    ASSERT_TRUE(model->ValidateRAFTEntry(state, std::make_shared<LogEntryRAFT>(logEntryMetadata{requestVote, certificate})));
+
+    // The candidate's own vote plus a bit past the membership and a junk signature
+    QuorumCertificate forged;
+    forged.termNumber = 1;
+    forged.candidateID = "node0";
+    forged.addVoter(0, vote(0));
+    forged.addVoter(63, "junk");
+    ASSERT_EQ(forged.voteCount(), 2);
+    ASSERT_FALSE(model->ValidateRAFTEntry(state, std::make_shared<LogEntryRAFT>(logEntryMetadata{requestVote, forged})));
+
+    // Likewise in a word no member reaches
+    forged.voterBitmap = {1ULL, 1ULL};
+    ASSERT_FALSE(model->ValidateRAFTEntry(state, std::make_shared<LogEntryRAFT>(logEntryMetadata{requestVote, forged})));
+}
+
+TEST_F(RaftAtomicFixture, TestHMACModeKeepsRSAVoteSignatures) {
+    state.authMode = AuthMode::HMAC;
+    state.pairwiseKeys = { {"node1", Crypto::GenerateSymmetricKey()} };
+    RSA::PrivateKey privateKey = Crypto::LoadPrivateKeyFromBase64(state.privateKey);
+    std::string publicKey = Crypto::PublicKeyToBase64(Crypto::GeneratePublicKey(privateKey));
+
+    model->HandleRequest(state, std::make_shared<RequestVote>(RequestMetadata{1, "node1", 0}, ""), "node1");
+
+    auto response = std::static_pointer_cast<ResponseVote>(state.raftOutMessages.front() -> content);
+    // Point-to-point tag for the requester, RSA signature for the quorum certificate
+    ASSERT_EQ(state.raftOutMessages.front() -> macVector.count("node1"), 1);
+    ASSERT_TRUE(Crypto::VerifySignature(response -> metadata.toString(), publicKey, response -> msgDigestSigned));
+}
+
 /* Test Time advance */
 
 TEST_F(RaftAtomicFixture, TestTimeAdvance) {
@@ -215,6 +417,449 @@ TEST_F(RaftAtomicFixture, OutputMethodProcessesMessagesCorrectly) {
     ASSERT_EQ(model->output_external->size(), 3);
 }
 
+TEST_F(RaftAtomicFixture, TestBatchedEntryDigestsMatchSingle) {
+    // Lengths around the one and two padding block boundaries, more messages than SIMD lanes
+    std::vector<std::string> batch;
+    for (size_t length : {0, 1, 3, 55, 56, 63, 64, 65, 119, 120, 128, 200, 1000, 4096}) {
+        batch.push_back(std::string(length, static_cast<char>('a' + length % 26)));
+    }
+    batch.push_back("abc");
+
+    std::vector<std::string> digests = Crypto::EntryDigests(batch, BatchHashing::MULTI_BUFFER);
+    ASSERT_EQ(digests.size(), batch.size());
+    for (size_t i = 0; i < batch.size(); i++) {
+        EXPECT_EQ(digests[i], Crypto::EntryDigest(batch[i])) << "message of " << batch[i].size() << " bytes";
+    }
+
+    // FIPS 180-2 test vector
+    std::string expected("\xba\x78\x16\xbf\x8f\x01\xcf\xea\x41\x41\x40\xde\x5d\xae\x22\x23"
+                           "\xb0\x03\x61\xa3\x96\x17\x7a\x9c\xb4\x10\xff\x61\xf2\x00\x15\xad", SHA256::DIGESTSIZE);
+    EXPECT_EQ(digests.back(), expected);
+    EXPECT_EQ(Crypto::EntryDigests(batch, BatchHashing::SEQUENTIAL), digests);
+    EXPECT_EQ(Crypto::EntryDigests(batch), digests);
+}
+
+TEST_F(RaftAtomicFixture, TestLogStateWritesDeltasAndKeyframes) {
+    model->getState().privateKey = "c2VjcmV0LXByaXZhdGUta2V5";
+    std::string keyframe = model->logState();
+    EXPECT_EQ(keyframe.rfind("RaftState { state: FOLLOWER, currentTerm: 0", 0), 0u);
+    EXPECT_NE(keyframe.find("logIndex: "), std::string::npos);
+    EXPECT_EQ(keyframe.find("c2VjcmV0"), std::string::npos);
+
+    // Only the changed fields, then nothing at all
+    model->getState().currentTerm = 3;
+    model->getState().leaderID = "node2";
+    EXPECT_EQ(model->logState(), "RaftState ~ { currentTerm: 3, leaderID: node2 }");
+    EXPECT_EQ(model->logState(), "RaftState ~ {  }");
+
+    // The next keyframe carries everything again
+    for (size_t i = 3; i < StateDelta::defaultKeyframeInterval; i++) {
+        model->logState();
+    }
+    std::string next = model->logState();
+    EXPECT_EQ(next.rfind("RaftState { state: FOLLOWER, currentTerm: 3", 0), 0u);
+    std::stringstream full;
+    full << model->getState();
+    EXPECT_EQ(next, full.str());
+}
+
+/* Replication acknowledgements and client commands */
+
+TEST_F(RaftAtomicFixture, TestAppendEntriesIsAcknowledged) {
+    state.leaderID = "node1";
+    std::vector<std::shared_ptr<IMessage<LogEntryType>>> entries{
+        std::make_shared<LogEntryHeartbeat>(HeartbeatMetadata{"node1", 0, 0.05, HEARTBEAT_STATUS::PING})
+    };
+    AppendEntriesMetadata first{2, "node1", -1, 0, entries, -1, ""};
+    model->HandleAppendEntries(state, std::make_shared<AppendEntries>(first, ""));
+
+    auto ack = std::static_pointer_cast<AppendEntriesResponse>(state.raftOutMessages.back() -> content);
+    ASSERT_EQ(state.raftOutMessages.back() -> dest, "node1");
+    ASSERT_TRUE(ack -> metadata.success);
+    ASSERT_EQ(ack -> metadata.term, 2);
+    ASSERT_EQ(ack -> metadata.matchIndex, 0);
+    ASSERT_EQ(ack -> metadata.appended, 1);
+
+    // Entries past the end of our log, the leader is told to resend from index 1
+    AppendEntriesMetadata ahead{2, "node1", 4, 0, entries, 0, "digest"};
+    model->HandleAppendEntries(state, std::make_shared<AppendEntries>(ahead, ""));
+    auto nack = std::static_pointer_cast<AppendEntriesResponse>(state.raftOutMessages.back() -> content);
+    ASSERT_FALSE(nack -> metadata.success);
+    ASSERT_EQ(nack -> metadata.matchIndex, 0);
+}
+
+TEST_F(RaftAtomicFixture, TestLeaderCommitsOnMajorityAndAnswersClient) {
+    state.state = RaftStatus::LEADER;
+    state.currentTerm = 1;
+    state.currentTime = 0.5;
+    model->AppendLogEntry(state, std::make_shared<LogEntryHeartbeat>());
+    model->SendAppendEntries(state, {std::make_shared<LogEntryExternal>(ClientCommand{"client", 7, "key1", "value"})});
+    state.raftOutMessages.clear();
+
+    // One follower is a majority of three with the leader
+    AppendEntriesResponseMetadata ack{1, "node2", true, 1, 1};
+    model->HandleAppendEntriesResponse(state, std::make_shared<AppendEntriesResponse>(ack, ""));
+    ASSERT_EQ(state.commitIndex, 1);
+    ASSERT_EQ(state.lastApplied, 1);
+    ASSERT_EQ(state.raftOutMessages.size(), 1);
+    ASSERT_EQ(state.raftOutMessages.front() -> dest, "client");
+    auto response = std::static_pointer_cast<ClientResponse>(state.raftOutMessages.front() -> content);
+    ASSERT_EQ(response -> metadata.status, ClientStatus::OK);
+    ASSERT_EQ(response -> metadata.requestID, 7);
+    ASSERT_EQ(response -> metadata.logIndex, 1);
+    ASSERT_DOUBLE_EQ(response -> metadata.commitTime, 0.5);
+
+    // A follower that fell behind gets the entries it misses
+    state.raftOutMessages.clear();
+    AppendEntriesResponseMetadata nack{1, "node1", false, -1, 0};
+    model->HandleAppendEntriesResponse(state, std::make_shared<AppendEntriesResponse>(nack, ""));
+    ASSERT_EQ(state.raftOutMessages.size(), 1);
+    ASSERT_EQ(state.raftOutMessages.front() -> dest, "node1");
+    auto catchUp = std::static_pointer_cast<AppendEntries>(state.raftOutMessages.front() -> content);
+    ASSERT_EQ(catchUp -> metadata.prevLogIndex, -1);
+    ASSERT_EQ(catchUp -> metadata.entries.size(), 2);
+}
+
+TEST_F(RaftAtomicFixture, TestLeaderCommitsEarlierTermsOnlyWithItsOwn) {
+    // Elected in term 2 over a write left from term 1, the term began at index 2
+    state.currentTerm = 1;
+    model->AppendLogEntry(state, std::make_shared<LogEntryHeartbeat>());
+    model->AppendLogEntry(state, std::make_shared<LogEntryExternal>(ClientCommand{"client", 7, "key1", "value"}));
+    state.state = RaftStatus::LEADER;
+    state.currentTerm = 2;
+    state.termStartIndex = 2;
+    model->AppendLogEntry(state, std::make_shared<LogEntryHeartbeat>());
+
+    // A majority holds the term 1 write, but a later leader could still overwrite it
+    AppendEntriesResponseMetadata earlier{2, "node1", true, 1, 0};
+    model->HandleAppendEntriesResponse(state, std::make_shared<AppendEntriesResponse>(earlier, ""));
+    ASSERT_EQ(state.commitIndex, 0);
+
+    // Once the entry that began the term is on a majority, both commit
+    AppendEntriesResponseMetadata own{2, "node2", true, 2, 1};
+    model->HandleAppendEntriesResponse(state, std::make_shared<AppendEntriesResponse>(own, ""));
+    ASSERT_EQ(state.commitIndex, 2);
+}
+
+TEST_F(RaftAtomicFixture, TestFollowerRedirectsClient) {
+    state.leaderID = "node2";
+    std::vector<std::shared_ptr<IMessage<LogEntryType>>> accepted;
+    model->HandleClientRequest(state, std::make_shared<ClientRequest>(ClientCommand{"client", 3, "key", "v"}), "client", accepted);
+    ASSERT_TRUE(accepted.empty());
+    auto response = std::static_pointer_cast<ClientResponse>(state.raftOutMessages.back() -> content);
+    ASSERT_EQ(response -> metadata.status, ClientStatus::REDIRECT);
+    ASSERT_EQ(response -> metadata.leaderHint, "node2");
+}
+
+/* Reads served without the log */
+
+TEST_F(RaftAtomicFixture, TestReadIndexWaitsForRound) {
+    state.state = RaftStatus::LEADER;
+    state.currentTerm = 1;
+    state.readMode = ReadMode::READ_INDEX;
+    model->AppendLogEntry(state, std::make_shared<LogEntryHeartbeat>());
+
+    std::vector<std::shared_ptr<IMessage<LogEntryType>>> accepted;
+    ClientCommand read{"client", 4, "key", "", ClientOperation::READ};
+    model->HandleClientRequest(state, std::make_shared<ClientRequest>(read), "client", accepted);
+    ASSERT_TRUE(accepted.empty());
+    ASSERT_EQ(state.pendingReads.size(), 1);
+
+    // Nothing else was broadcast, an empty round confirms the leadership
+    model->ServeReads(state);
+    ASSERT_EQ(state.raftOutMessages.size(), 1);
+    auto round = std::static_pointer_cast<AppendEntries>(state.raftOutMessages.front() -> content);
+    ASSERT_TRUE(round -> metadata.entries.empty());
+    ASSERT_EQ(round -> metadata.round, state.round);
+    ASSERT_EQ(state.messageLog.size(), 1);
+    state.raftOutMessages.clear();
+
+    // One peer is a majority with the leader
+    AppendEntriesResponseMetadata ack{1, "node1", true, 0, 0, round -> metadata.round};
+    model->HandleAppendEntriesResponse(state, std::make_shared<AppendEntriesResponse>(ack, ""));
+    model->ServeReads(state);
+    ASSERT_TRUE(state.pendingReads.empty());
+    ASSERT_EQ(state.raftOutMessages.size(), 1);
+    auto response = std::static_pointer_cast<ClientResponse>(state.raftOutMessages.front() -> content);
+    ASSERT_EQ(response -> metadata.status, ClientStatus::OK);
+    ASSERT_EQ(response -> metadata.requestID, 4);
+}
+
+TEST_F(RaftAtomicFixture, TestLeaseReadsSkipRound) {
+    state.state = RaftStatus::LEADER;
+    state.currentTerm = 1;
+    state.readMode = ReadMode::LEASE;
+    state.currentTime = 1.0;
+    model->SendAppendEntries(state, {std::make_shared<LogEntryHeartbeat>()});
+    AppendEntriesResponseMetadata ack{1, "node2", true, 0, 1, state.round};
+    model->HandleAppendEntriesResponse(state, std::make_shared<AppendEntriesResponse>(ack, ""));
+    ASSERT_DOUBLE_EQ(state.leaseExpiry, 1.0 + ELECTION_TIMEOUT_MIN * (1 - state.maxClockDrift));
+    state.raftOutMessages.clear();
+
+    // Inside the lease the read is answered at once
+    std::vector<std::shared_ptr<IMessage<LogEntryType>>> accepted;
+    state.currentTime = 1.1;
+    model->HandleClientRequest(state, std::make_shared<ClientRequest>(ClientCommand{"client", 1, "key", "", ClientOperation::READ}), "client", accepted);
+    model->ServeReads(state);
+    ASSERT_TRUE(state.pendingReads.empty());
+    ASSERT_EQ(state.raftOutMessages.back() -> content -> getType(), Task::CLIENT_RESPONSE);
+
+    // Once it ran out the read needs a round again
+    state.raftOutMessages.clear();
+    state.currentTime = 1.2;
+    model->HandleClientRequest(state, std::make_shared<ClientRequest>(ClientCommand{"client", 2, "key", "", ClientOperation::READ}), "client", accepted);
+    model->ServeReads(state);
+    ASSERT_EQ(state.pendingReads.size(), 1);
+    ASSERT_EQ(state.raftOutMessages.back() -> content -> getType(), Task::APPEND_ENTRIES);
+}
+
+TEST_F(RaftAtomicFixture, TestLeaseModeKeepsVoteWhileLeaderHeard) {
+    state.readMode = ReadMode::LEASE;
+    state.leaderID = "node1";
+    state.currentTime = 1.0;
+    state.lastHeartbeatUpdate = 0.95;
+    RequestMetadata requestMetadata{1, "node2", 0};
+    model->HandleRequest(state, std::make_shared<RequestVote>(requestMetadata, ""), "node2");
+    auto vote = std::static_pointer_cast<ResponseVote>(state.raftOutMessages.back() -> content);
+    ASSERT_FALSE(vote -> metadata.voteGranted);
+
+    // The leader went quiet for an election timeout
+    state.currentTime = 0.96 + ELECTION_TIMEOUT_MIN;
+    model->HandleRequest(state, std::make_shared<RequestVote>(requestMetadata, ""), "node2");
+    vote = std::static_pointer_cast<ResponseVote>(state.raftOutMessages.back() -> content);
+    ASSERT_TRUE(vote -> metadata.voteGranted);
+}
+
+TEST_F(RaftAtomicFixture, TestPreVoteRefusedWhileLeaderHeard) {
+    state.leaderID = "node1";
+    state.currentTerm = 1;
+    state.currentTime = 1.0;
+    state.lastHeartbeatUpdate = 0.95;
+    PreVoteMetadata request{2, "node2", 0};
+    model->HandlePreVoteRequest(state, std::make_shared<PreVoteRequest>(request, ""), "node2");
+    auto answer = std::static_pointer_cast<PreVoteResponse>(state.raftOutMessages.back() -> content);
+    ASSERT_EQ(state.raftOutMessages.back() -> dest, "node2");
+    ASSERT_FALSE(answer -> metadata.granted);
+
+    // Granted once the leader went quiet, our term and vote stay as they were
+    state.currentTime = 0.96 + ELECTION_TIMEOUT_MIN;
+    model->HandlePreVoteRequest(state, std::make_shared<PreVoteRequest>(request, ""), "node2");
+    answer = std::static_pointer_cast<PreVoteResponse>(state.raftOutMessages.back() -> content);
+    ASSERT_TRUE(answer -> metadata.granted);
+    ASSERT_EQ(state.currentTerm, 1);
+    ASSERT_TRUE(state.votedFor.empty());
+}
+
+TEST_F(RaftAtomicFixture, TestPreVoteMajorityStartsElection) {
+    state.currentTerm = 1;
+    model->StartPreVote(state);
+    ASSERT_EQ(state.currentTerm, 1);
+    ASSERT_EQ(state.state, RaftStatus::FOLLOWER);
+    ASSERT_EQ(state.raftOutMessages.back() -> content -> getType(), Task::PRE_VOTE_REQUEST);
+
+    // A refusal and an answer for another term change nothing, one grant and our own make a majority
+    model->HandlePreVoteResponse(state, std::make_shared<PreVoteResponse>(PreVoteResponseMetadata{2, "node0", false, "node1"}, ""));
+    model->HandlePreVoteResponse(state, std::make_shared<PreVoteResponse>(PreVoteResponseMetadata{3, "node0", true, "node1"}, ""));
+    ASSERT_EQ(state.state, RaftStatus::FOLLOWER);
+    model->HandlePreVoteResponse(state, std::make_shared<PreVoteResponse>(PreVoteResponseMetadata{2, "node0", true, "node2"}, ""));
+    ASSERT_EQ(state.state, RaftStatus::CANDIDATE);
+    ASSERT_EQ(state.currentTerm, 2);
+    ASSERT_EQ(state.raftOutMessages.back() -> content -> getType(), Task::VOTE_REQUEST);
+    // Our own vote is already in hand
+    ASSERT_EQ(state.tempMessageStorage.size(), 1);
+}
+
+TEST_F(RaftAtomicFixture, TestCandidateMissingCommittedEntryLosesVote) {
+    // node0 leads term 1, all three nodes hold its first entry
+    auto node = [](const std::string& id, const std::vector<std::string>& peers) {
+        RaftState s;
+        s.nodeID = id;
+        s.peers = peers;
+        s.currentTerm = 1;
+        s.leaderID = "node0";
+        RaftControllerModel::InternClusterMembers(s);
+        return s;
+    };
+    RaftState leader = node("node0", {"node1", "node2"});
+    RaftState follower = node("node1", {"node0", "node2"});
+    RaftState candidate = node("node2", {"node0", "node1"});
+    leader.state = RaftStatus::LEADER;
+    auto first = std::make_shared<LogEntryHeartbeat>();
+    for (RaftState* s : {&leader, &follower, &candidate}) {
+        model->AppendLogEntry(*s, first);
+    }
+
+    // A write reaches node1 only, its acknowledgement makes a majority and the client is answered
+    model->SendAppendEntries(leader, {std::make_shared<LogEntryExternal>(ClientCommand{"client", 7, "key1", "value"})});
+    auto write = std::static_pointer_cast<AppendEntries>(leader.raftOutMessages.back() -> content);
+    leader.raftOutMessages.clear();
+    model->HandleAppendEntries(follower, write);
+    auto ack = std::static_pointer_cast<AppendEntriesResponse>(follower.raftOutMessages.back() -> content);
+    model->HandleAppendEntriesResponse(leader, ack);
+    ASSERT_EQ(leader.commitIndex, 1);
+    ASSERT_EQ(leader.raftOutMessages.front() -> dest, "client");
+
+    // node0 fails before node1 hears the new commit index, so both survivors have committed only the first entry
+    ASSERT_EQ(follower.commitIndex, 0);
+    ASSERT_EQ(candidate.commitIndex, 0);
+    follower.currentTime = 1.0;
+
+    // node2 lacks the write, node1 turns it down in the PreVote and in the election
+    model->StartPreVote(candidate);
+    auto preVote = std::static_pointer_cast<PreVoteRequest>(candidate.raftOutMessages.back() -> content);
+    model->HandlePreVoteRequest(follower, preVote, "node2");
+    ASSERT_FALSE(std::static_pointer_cast<PreVoteResponse>(follower.raftOutMessages.back() -> content) -> metadata.granted);
+    model->StartElection(candidate);
+    auto request = std::static_pointer_cast<RequestVote>(candidate.raftOutMessages.back() -> content);
+    ASSERT_EQ(request -> metadata.lastLogIndex, 0);
+    model->HandleRequest(follower, request, "node2");
+    ASSERT_FALSE(std::static_pointer_cast<ResponseVote>(follower.raftOutMessages.back() -> content) -> metadata.voteGranted);
+
+    // node1 holds it and gets node2's vote
+    model->StartElection(follower);
+    request = std::static_pointer_cast<RequestVote>(follower.raftOutMessages.back() -> content);
+    ASSERT_EQ(request -> metadata.lastLogIndex, 1);
+    model->HandleRequest(candidate, request, "node1");
+    ASSERT_TRUE(std::static_pointer_cast<ResponseVote>(candidate.raftOutMessages.back() -> content) -> metadata.voteGranted);
+}
+
+TEST_F(RaftAtomicFixture, TestStaleLeaderStepsDown) {
+    state.state = RaftStatus::LEADER;
+    state.leaderID = "node0";
+    state.currentTerm = 1;
+    AppendEntriesMetadata later{2, "node1", -1, 0, {}, -1, ""};
+    model->HandleAppendEntries(state, std::make_shared<AppendEntries>(later, ""));
+    ASSERT_EQ(state.state, RaftStatus::FOLLOWER);
+    ASSERT_EQ(state.currentTerm, 2);
+    ASSERT_TRUE(state.leaderID.empty());
+}
+
+TEST_F(RaftAtomicFixture, TestRoundTripsFeedAdaptiveTimers) {
+    TimeoutConfig config;
+    config.adaptive = true;
+    state.timers.setConfig(config);
+
+    // A follower echoes the send time and takes over its leader's estimate
+    state.leaderID = "node1";
+    state.currentTime = 0.2;
+    AppendEntriesMetadata heartbeat{2, "node1", -1, 0, {}, -1, ""};
+    heartbeat.sentAt = 0.199;
+    heartbeat.rtt = 0.010;
+    heartbeat.rttVar = 0.002;
+    model->HandleAppendEntries(state, std::make_shared<AppendEntries>(heartbeat, ""));
+    auto ack = std::static_pointer_cast<AppendEntriesResponse>(state.raftOutMessages.back() -> content);
+    ASSERT_DOUBLE_EQ(ack -> metadata.sentAt, 0.199);
+    ASSERT_DOUBLE_EQ(state.timers.getEstimator().smoothed(), 0.010);
+    ASSERT_DOUBLE_EQ(state.timers.heartbeatInterval(), 0.005);
+
+    // A leader measures the round trip from the echo
+    state = RaftState{};
+    InitModel();
+    state.timers.setConfig(config);
+    state.state = RaftStatus::LEADER;
+    state.currentTerm = 1;
+    state.currentTime = 0.52;
+    AppendEntriesResponseMetadata echo{1, "node2", true, -1, 0};
+    echo.sentAt = 0.5;
+    model->HandleAppendEntriesResponse(state, std::make_shared<AppendEntriesResponse>(echo, ""));
+    ASSERT_EQ(state.timers.getEstimator().count(), 1);
+    ASSERT_NEAR(state.timers.getEstimator().smoothed(), 0.020, 1e-12);
+
+    // and passes the new interval on to its heartbeat loop
+    ASSERT_EQ(state.heartbeatStatus, HeartbeatStatus::UPDATE);
+    model->output(state);
+    auto updates = model->output_heartbeat->getBag();
+    ASSERT_EQ(updates.size(), 1);
+    ASSERT_EQ(updates[0].status, HeartbeatStatus::UPDATE);
+    ASSERT_DOUBLE_EQ(updates[0].heartbeatInterval, state.timers.heartbeatInterval());
+    ASSERT_DOUBLE_EQ(updates[0].electionTimeoutMin, state.timers.electionTimeoutMin());
+}
+
+TEST_F(RaftAtomicFixture, TestFollowerReadWaitsForReadIndex) {
+    state.followerReads = FollowerReadMode::READ_INDEX;
+    state.leaderID = "node1";
+    std::vector<std::shared_ptr<IMessage<LogEntryType>>> accepted;
+    model->HandleClientRequest(state, std::make_shared<ClientRequest>(ClientCommand{"client", 1, "key", "", ClientOperation::READ}), "client", accepted);
+    model->HandleClientRequest(state, std::make_shared<ClientRequest>(ClientCommand{"client", 2, "key", "", ClientOperation::READ}), "client", accepted);
+
+    // Both reads share one request to the leader
+    model->ServeReads(state);
+    ASSERT_EQ(state.pendingReads.size(), 2);
+    ASSERT_EQ(state.raftOutMessages.size(), 1);
+    ASSERT_EQ(state.raftOutMessages.front() -> dest, "node1");
+    auto request = std::static_pointer_cast<ReadIndexRequest>(state.raftOutMessages.front() -> content);
+    ASSERT_EQ(request -> metadata.batch, 1);
+    state.raftOutMessages.clear();
+
+    // The index is known but not applied yet
+    ReadIndexResponseMetadata index{"node1", 1, true, 1};
+    model->HandleReadIndexResponse(state, std::make_shared<ReadIndexResponse>(index, ""));
+    model->ServeReads(state);
+    ASSERT_EQ(state.pendingReads.size(), 2);
+    ASSERT_TRUE(state.raftOutMessages.empty());
+
+    model->AppendLogEntry(state, std::make_shared<LogEntryHeartbeat>());
+    model->AppendLogEntry(state, std::make_shared<LogEntryHeartbeat>());
+    model->AdvanceCommitIndex(state, 1);
+    model->ServeReads(state);
+    ASSERT_TRUE(state.pendingReads.empty());
+    ASSERT_EQ(state.raftOutMessages.size(), 2);
+    auto response = std::static_pointer_cast<ClientResponse>(state.raftOutMessages.front() -> content);
+    ASSERT_EQ(response -> metadata.status, ClientStatus::OK);
+    ASSERT_EQ(response -> metadata.logIndex, 1);
+}
+
+TEST_F(RaftAtomicFixture, TestLeaderAnswersReadIndexOnceConfirmed) {
+    state.state = RaftStatus::LEADER;
+    state.currentTerm = 1;
+    model->SendAppendEntries(state, {std::make_shared<LogEntryHeartbeat>()});
+    AppendEntriesResponseMetadata first{1, "node1", true, -1, 0, state.round};
+    model->HandleAppendEntriesResponse(state, std::make_shared<AppendEntriesResponse>(first, ""));
+    state.raftOutMessages.clear();
+
+    ReadIndexRequestMetadata request{"node2", 7};
+    model->HandleReadIndexRequest(state, std::make_shared<ReadIndexRequest>(request, ""));
+    model->ServeReads(state);
+    ASSERT_EQ(state.raftOutMessages.size(), 1);
+    ASSERT_EQ(state.raftOutMessages.back() -> content -> getType(), Task::APPEND_ENTRIES);
+    state.raftOutMessages.clear();
+
+    // Confirmed before the entry is committed, the follower does the waiting
+    AppendEntriesResponseMetadata ack{1, "node1", true, -1, 0, state.round};
+    model->HandleAppendEntriesResponse(state, std::make_shared<AppendEntriesResponse>(ack, ""));
+    model->ServeReads(state);
+    ASSERT_EQ(state.raftOutMessages.size(), 1);
+    ASSERT_EQ(state.raftOutMessages.front() -> dest, "node2");
+    auto response = std::static_pointer_cast<ReadIndexResponse>(state.raftOutMessages.front() -> content);
+    ASSERT_TRUE(response -> metadata.success);
+    ASSERT_EQ(response -> metadata.batch, 7);
+    ASSERT_EQ(response -> metadata.readIndex, state.termStartIndex);
+}
+
+TEST_F(RaftAtomicFixture, TestBoundedStaleReadsCheckLag) {
+    state.followerReads = FollowerReadMode::BOUNDED_STALE;
+    state.maxReadLag = 2;
+    state.leaderID = "node1";
+    state.currentTime = 1.0;
+    state.lastHeartbeatUpdate = 0.99;
+    state.leaderCommit = 2;
+    std::vector<std::shared_ptr<IMessage<LogEntryType>>> accepted;
+    model->HandleClientRequest(state, std::make_shared<ClientRequest>(ClientCommand{"client", 1, "key", "", ClientOperation::READ}), "client", accepted);
+    ASSERT_TRUE(state.pendingReads.empty());
+    ASSERT_EQ(state.raftOutMessages.back() -> content -> getType(), Task::CLIENT_RESPONSE);
+
+    // Too far behind, the read falls back to a read index
+    state.leaderCommit = 3;
+    model->HandleClientRequest(state, std::make_shared<ClientRequest>(ClientCommand{"client", 2, "key", "", ClientOperation::READ}), "client", accepted);
+    ASSERT_EQ(state.pendingReads.size(), 1);
+
+    // Writes still go to the leader
+    model->HandleClientRequest(state, std::make_shared<ClientRequest>(ClientCommand{"client", 3, "key", "v"}), "client", accepted);
+    auto redirect = std::static_pointer_cast<ClientResponse>(state.raftOutMessages.back() -> content);
+    ASSERT_EQ(redirect -> metadata.status, ClientStatus::REDIRECT);
+    ASSERT_EQ(redirect -> metadata.leaderHint, "node1");
+}
+
 // Main function for Google Test
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv); 
@@ -5,6 +5,7 @@
 #include "raft.hpp" 
 #include "../atomic/packet_processor.hpp"
 #include "../atomic/message_processor.hpp"
+#include "../atomic/disk.hpp"
 
 
 using namespace cadmium;
@@ -23,22 +24,76 @@ public:
 
         // Create instances of atomic models
         auto raft = addComponent<RaftModel>("raft");
-        auto messageProcessor = addComponent<MessageProcessorModel>("message-processor");
-        auto packetProcessor = addComponent<PacketProcessorModel>("packet-processor");
+        auto messageProcessor = addComponent<MaybeProfiled<MessageProcessorModel>>("message-processor");
+        auto packetProcessor = addComponent<MaybeProfiled<PacketProcessorModel>>("packet-processor");
+        auto disk = addComponent<MaybeProfiled<DiskModel>>("disk");
 
         // Pass the node id information to RAFT
         auto raftController = raft -> getComponent("raft-controller");
         std::dynamic_pointer_cast<RaftControllerModel>(raftController)->setNodeID(id);
 
+        // The node's other models record metrics and traces under its id too
+        std::dynamic_pointer_cast<Buffer<RaftMessage>>(raft -> getComponent("buffer")) -> setNodeID(id);
+        messageProcessor -> setNodeID(id);
+        packetProcessor -> setNodeID(id);
+        disk -> setNodeID(id);
+
 
 
         // Define couplings
-        addCoupling(raft -> getOutPort("output_external"), messageProcessor -> getInPort("input_raft_message")); // Internal Coupling (IC)
+        addCoupling(raft -> getOutPort("output_external"), disk -> getInPort("input_raft_message")); // Internal Coupling (IC)
+        addCoupling(disk -> getOutPort("output_raft_message"), messageProcessor -> getInPort("input_raft_message")); // Internal Coupling (IC)
         addCoupling(packetProcessor -> getOutPort("output_raft_message"), raft -> getInPort("external_input")); // Internal Coupling (IC)
+        addCoupling(raft -> getOutPort("output_backpressure"), packetProcessor -> getInPort("input_backpressure")); // Internal Coupling (IC)
         addEIC(getInPort("external_input"), packetProcessor -> getInPort("input_packet"));     // External Input Coupling (EIC)
         addEOC(messageProcessor ->getOutPort("output_packet"), getOutPort("output_external")); // External Output Coupling (EOC)
 
     }
+
+    // Setter function for the node's CPU: `cores` cores shared by the message and packet processors,
+    // each message costing `times`. Without one the processors are infinite servers.
+    void setCpu(size_t cores, const ServiceTimes& times = ServiceTimes()) {
+        cpu = std::make_shared<CpuPool>(cores);
+        std::dynamic_pointer_cast<MessageProcessorModel>(getComponent("message-processor")) -> setCpu(cpu, times);
+        std::dynamic_pointer_cast<PacketProcessorModel>(getComponent("packet-processor")) -> setCpu(cpu, times);
+    }
+
+    std::shared_ptr<CpuPool> getCpu() const {
+        return cpu;
+    }
+
+    // Setter function for the node's disk: messages wait for the log entries and votes they carry
+    // to be persisted. Without one nothing is persisted and messages go straight to the network.
+    void setDisk(const DiskConfig& config) {
+        std::dynamic_pointer_cast<DiskModel>(getComponent("disk")) -> setConfig(config);
+    }
+
+    // Setter function for how the node serves client reads while it leads, see RaftControllerModel::setReadMode
+    void setReadMode(ReadMode mode, double maxClockDrift = 0.01) {
+        auto raft = std::dynamic_pointer_cast<RaftModel>(getComponent("raft"));
+        std::dynamic_pointer_cast<RaftControllerModel>(raft -> getComponent("raft-controller")) -> setReadMode(mode, maxClockDrift);
+    }
+
+    // Setter function for the node's PreVote phase, see RaftControllerModel::setPreVote
+    void setPreVote(bool enabled) {
+        auto raft = std::dynamic_pointer_cast<RaftModel>(getComponent("raft"));
+        std::dynamic_pointer_cast<RaftControllerModel>(raft -> getComponent("raft-controller")) -> setPreVote(enabled);
+    }
+
+    // Setter function for the node's election and heartbeat timers, see RaftControllerModel::setTimeouts
+    void setTimeouts(const TimeoutConfig& config) {
+        auto raft = std::dynamic_pointer_cast<RaftModel>(getComponent("raft"));
+        std::dynamic_pointer_cast<RaftControllerModel>(raft -> getComponent("raft-controller")) -> setTimeouts(config);
+    }
+
+    // Setter function for whether the node serves client reads while it follows, see RaftControllerModel::setFollowerReads
+    void setFollowerReads(FollowerReadMode mode, int maxLag = 0, double maxStaleness = 2 * HEARTBEAT_INTERVAL) {
+        auto raft = std::dynamic_pointer_cast<RaftModel>(getComponent("raft"));
+        std::dynamic_pointer_cast<RaftControllerModel>(raft -> getComponent("raft-controller")) -> setFollowerReads(mode, maxLag, maxStaleness);
+    }
+
+private:
+    std::shared_ptr<CpuPool> cpu;
 };
 
 #endif
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "../atomic/buffer.hpp" 
 #include "../atomic/raft_controller.hpp"
 #include "../atomic/heartbeat_controller.hpp"
+#include "../../utils/profiling/model_profiler.hpp"
 
 
 
@@ -21,11 +22,12 @@ public:
 
         addInPort<std::shared_ptr<RaftMessage>>("external_input");
 		addOutPort<std::shared_ptr<RaftMessage>>("output_external");
+        addOutPort<FlowControl>("output_backpressure");
 
         // Create instances of atomic models
-        auto raftController = addComponent<RaftControllerModel>("raft-controller");
-        auto heartbeatController = addComponent<HeartbeatControllerModel>("heartbeat-controller");
-        auto buffer = addComponent<Buffer<RaftMessage>>("buffer");
+        auto raftController = addComponent<MaybeProfiled<RaftControllerModel>>("raft-controller");
+        auto heartbeatController = addComponent<MaybeProfiled<HeartbeatControllerModel>>("heartbeat-controller");
+        auto buffer = addComponent<MaybeProfiled<Buffer<RaftMessage>>>("buffer");
 
         // Define couplings
         addCoupling(buffer -> getOutPort("output_buffer"), raftController -> getInPort("input_buffer")); // Internal Coupling (IC)
@@ -33,6 +35,7 @@ public:
         addCoupling(heartbeatController -> getOutPort("output_heartbeat"), raftController -> getInPort("input_heartbeat")); // Internal Coupling (IC)
         addEIC(getInPort("external_input"), buffer -> getInPort("input_buffer"));     // External Input Coupling (EIC)
         addEOC(raftController ->getOutPort("output_external"), getOutPort("output_external")); // External Output Coupling (EOC)
+        addEOC(buffer -> getOutPort("output_backpressure"), getOutPort("output_backpressure")); // External Output Coupling (EOC)
 
     }
 };
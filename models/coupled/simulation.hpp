@@ -4,7 +4,10 @@
 #include <cadmium/core/modeling/coupled.hpp>
 #include "node.hpp"
 #include "../atomic/network.hpp"
+#include "../atomic/client.hpp"
 #include <unordered_map>
+#include <algorithm>
+#include <optional>
 
 
 
@@ -14,21 +17,58 @@ using namespace cadmium;
 class SimulationModel : public Coupled {
 public:
 
-    explicit SimulationModel(const std::string& id) : Coupled(id) {
+    // With a client config a "client" issues commands to the cluster, see ClientModel. The cluster
+    // has `clusterSize` nodes, "node0" onwards.
+    explicit SimulationModel(const std::string& id, AuthMode authMode = AuthMode::NONE,
+                             std::optional<ClientConfig> client = std::nullopt, size_t clusterSize = 3) : Coupled(id) {
 
 
         std::vector<std::string> nodesID;
         std::unordered_map<std::string, std::shared_ptr<NodeModel>> nodes;
         
 
-        for (int i = 0 ; i < 3; i++){
+        for (size_t i = 0 ; i < clusterSize; i++){
             auto nodeID = "node" + std::to_string(i);
             nodesID.push_back(nodeID); 
             nodes[nodeID] = addComponent<NodeModel>(nodeID);
         }
 
 
-        auto network = addComponent<NetworkModel>("network", nodesID);
+        std::vector<std::string> clientsID;
+        if (client) {
+            clientsID.push_back("client");
+        }
+        auto network = addComponent<MaybeProfiled<NetworkModel>>("network", nodesID, clientsID);
+        if (client) {
+            if (client -> servers.empty()) {
+                client -> servers = nodesID;
+            }
+            auto clientModel = addComponent<MaybeProfiled<ClientModel>>("client", *client);
+            addCoupling(network -> getOutPort("output_packet_client"), clientModel -> getInPort("input_packet")); // Internal Coupling (IC)
+            addCoupling(clientModel -> getOutPort("output_packet"), network -> getInPort("input_packet_client")); // Internal Coupling (IC)
+        }
+
+        // Cluster setup: RSA key pairs per node and a pre-shared HMAC key per pair of nodes
+        std::unordered_map<std::string, std::string> privateKeys;
+        std::vector<std::string> publicKeys;
+        std::unordered_map<std::string, std::unordered_map<std::string, std::string>> pairwiseKeys;
+        if (authMode != AuthMode::NONE) {
+            // Public keys are listed in the same sorted order the controllers intern members in
+            std::vector<std::string> sortedIDs = nodesID;
+            std::sort(sortedIDs.begin(), sortedIDs.end());
+            for (const auto& nodeID : sortedIDs) {
+                RSA::PrivateKey privateKey = Crypto::GeneratePrivateKey();
+                privateKeys[nodeID] = Crypto::PrivateKeyToBase64(privateKey);
+                publicKeys.push_back(Crypto::PublicKeyToBase64(Crypto::GeneratePublicKey(privateKey)));
+            }
+            for (size_t i = 0; i < sortedIDs.size(); i++) {
+                for (size_t j = i + 1; j < sortedIDs.size(); j++) {
+                    std::string key = Crypto::GenerateSymmetricKey();
+                    pairwiseKeys[sortedIDs[i]][sortedIDs[j]] = key;
+                    pairwiseKeys[sortedIDs[j]][sortedIDs[i]] = key;
+                }
+            }
+        }
 
         for (auto nodeID : nodesID) {
             auto raftChild = nodes[nodeID] -> getComponent("raft");
@@ -40,6 +80,8 @@ public:
             
             // Pass `peers` to setPeers()
             std::dynamic_pointer_cast<RaftControllerModel>(raftChildController)->setPeers(peers);
+            std::dynamic_pointer_cast<RaftControllerModel>(raftChildController)->setAuthentication(
+                authMode, privateKeys[nodeID], publicKeys, pairwiseKeys[nodeID]);
             
 
             addCoupling(network -> getOutPort("output_packet_"+ nodeID), nodes[nodeID] -> getInPort("external_input")); // Internal Coupling (IC)
@@ -48,6 +90,75 @@ public:
 
     };
 
+    // Setter function for every node's CPU, see NodeModel::setCpu
+    void setCpu(size_t cores, const ServiceTimes& times = ServiceTimes()) {
+        for (const auto& component : components) {
+            if (auto node = std::dynamic_pointer_cast<NodeModel>(component)) {
+                node -> setCpu(cores, times);
+            }
+        }
+    }
+
+    // Setter function for every node's disk, see NodeModel::setDisk
+    void setDisk(const DiskConfig& config) {
+        for (const auto& component : components) {
+            if (auto node = std::dynamic_pointer_cast<NodeModel>(component)) {
+                node -> setDisk(config);
+            }
+        }
+    }
+
+    // Setter function for every node's read path, see NodeModel::setReadMode
+    void setReadMode(ReadMode mode, double maxClockDrift = 0.01) {
+        for (const auto& component : components) {
+            if (auto node = std::dynamic_pointer_cast<NodeModel>(component)) {
+                node -> setReadMode(mode, maxClockDrift);
+            }
+        }
+    }
+
+    // Setter function for every node's PreVote phase, see NodeModel::setPreVote
+    void setPreVote(bool enabled) {
+        for (const auto& component : components) {
+            if (auto node = std::dynamic_pointer_cast<NodeModel>(component)) {
+                node -> setPreVote(enabled);
+            }
+        }
+    }
+
+    // Setter function for every node's election and heartbeat timers, see NodeModel::setTimeouts
+    void setTimeouts(const TimeoutConfig& config) {
+        for (const auto& component : components) {
+            if (auto node = std::dynamic_pointer_cast<NodeModel>(component)) {
+                node -> setTimeouts(config);
+            }
+        }
+    }
+
+    // Setter function for the network's delays, see NetworkModel::setLatency
+    void setLatency(double latency, double jitter) {
+        std::dynamic_pointer_cast<NetworkModel>(getComponent("network")) -> setLatency(latency, jitter);
+    }
+
+    // Setter function for the share of packets the network loses, see NetworkModel::setLossRate
+    void setLossRate(double lossRate) {
+        std::dynamic_pointer_cast<NetworkModel>(getComponent("network")) -> setLossRate(lossRate);
+    }
+
+    // Setter function to cut a node off for a while, see NetworkModel::isolate
+    void isolate(const std::string& node, double from, double until = std::numeric_limits<double>::infinity()) {
+        std::dynamic_pointer_cast<NetworkModel>(getComponent("network")) -> isolate(node, from, until);
+    }
+
+    // Setter function for every node's follower reads, see NodeModel::setFollowerReads
+    void setFollowerReads(FollowerReadMode mode, int maxLag = 0, double maxStaleness = 2 * HEARTBEAT_INTERVAL) {
+        for (const auto& component : components) {
+            if (auto node = std::dynamic_pointer_cast<NodeModel>(component)) {
+                node -> setFollowerReads(mode, maxLag, maxStaleness);
+            }
+        }
+    }
+
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,71 @@
+// Build the coupled models with every atomic wrapped in Profiled
+#define RAFT_PROFILE_MODELS
+#include <gtest/gtest.h>
+#include <sstream>
+#include "../simulation.hpp"
+#include <cadmium/core/simulation/root_coordinator.hpp>
+
+
+TEST(ProfilingTest, TestProfiledCountsEveryCall) {
+    ModelProfiler profiler;
+    Profiled<Buffer<std::string>> buffer("buffer");
+    AtomicInterface& atomic = buffer;
+
+    // Nothing is recorded while no profiler is active
+    atomic.timeAdvance();
+    ModelProfiler::Activate(&profiler);
+    atomic.externalTransition(0);
+    atomic.output();
+    atomic.internalTransition();
+    atomic.timeAdvance();
+    atomic.timeAdvance();
+    ModelProfiler::Activate(nullptr);
+
+    ASSERT_EQ(profiler.getEntries().size(), 1);
+    const ModelProfiler::Entry& entry = profiler.getEntries()[0];
+    EXPECT_EQ(entry.type.rfind("Buffer<", 0), 0);
+    EXPECT_EQ(entry.calls[static_cast<size_t>(ModelPhase::EXTERNAL)], 1);
+    EXPECT_EQ(entry.calls[static_cast<size_t>(ModelPhase::OUTPUT)], 1);
+    EXPECT_EQ(entry.calls[static_cast<size_t>(ModelPhase::INTERNAL)], 1);
+    EXPECT_EQ(entry.calls[static_cast<size_t>(ModelPhase::TIME_ADVANCE)], 2);
+}
+
+TEST(ProfilingTest, TestSimulationReportRanksEveryModelType) {
+    auto model = std::make_shared<SimulationModel>("simulation");
+    RootCoordinator root(model);
+    std::ostringstream report;
+    SimulateProfiled(root, 0.3, report);
+    EXPECT_EQ(ModelProfiler::Active(), nullptr);
+
+    std::string text = report.str();
+    for (const std::string type : {"RaftControllerModel", "HeartbeatControllerModel", "Buffer<RaftMessage>",
+                                   "NetworkModel", "PacketProcessorModel", "MessageProcessorModel"}) {
+        EXPECT_NE(text.find(type), std::string::npos) << type;
+    }
+
+    // Rows are ranked by total time
+    std::istringstream lines(text);
+    std::string line;
+    std::getline(lines, line);
+    std::getline(lines, line);
+    double previous = 1e300;
+    int rows = 0;
+    while (std::getline(lines, line)) {
+        std::istringstream fields(line);
+        std::string rank, type, function;
+        uint64_t calls;
+        double totalMs;
+        fields >> rank >> type >> function >> calls >> totalMs;
+        EXPECT_GT(calls, 0);
+        EXPECT_LE(totalMs, previous);
+        previous = totalMs;
+        rows++;
+    }
+    EXPECT_GE(rows, 6 * 3);
+}
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
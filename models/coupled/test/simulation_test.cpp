@@ -1,7 +1,9 @@
 #include <gtest/gtest.h>
+#include <set>
 #include "../simulation.hpp"
 #include "../../../logger/raft_logger.hpp"
 #include <cadmium/core/simulation/root_coordinator.hpp>
+#include <sstream>
 
 
 class SimulationFixture: public ::testing::Test
@@ -38,6 +40,171 @@ TEST_F(SimulationFixture, testBuildBufferRaftCoupledModel) {
 
 }
 
+TEST_F(SimulationFixture, testHMACAuthenticatedElection) {
+    auto model = std::make_shared<SimulationModel>("simulation", AuthMode::HMAC);
+    RootCoordinator root(model);
+    root.simulate(0.3);
+
+    // Messages are MAC tagged end to end, a leader must still be elected and accepted
+    int leaders = 0;
+    int followersWithLeader = 0;
+    for (const std::string nodeID : {"node0", "node1", "node2"}) {
+        auto raft = std::dynamic_pointer_cast<RaftModel>(std::dynamic_pointer_cast<NodeModel>(model -> getComponent(nodeID)) -> getComponent("raft"));
+        auto controller = std::dynamic_pointer_cast<RaftControllerModel>(raft -> getComponent("raft-controller"));
+        const RaftState& s = controller -> getState();
+        leaders += s.state == RaftStatus::LEADER;
+        followersWithLeader += (s.state != RaftStatus::LEADER && !s.leaderID.empty());
+    }
+    ASSERT_GE(leaders, 1);
+    ASSERT_GE(followersWithLeader, 1);
+}
+
+TEST_F(SimulationFixture, testElectionWithSharedCpu) {
+    auto model = std::make_shared<SimulationModel>("simulation", AuthMode::HMAC);
+    model -> setCpu(1);
+    RootCoordinator root(model);
+    root.simulate(0.3);
+
+    int leaders = 0;
+    for (const std::string nodeID : {"node0", "node1", "node2"}) {
+        auto node = std::dynamic_pointer_cast<NodeModel>(model -> getComponent(nodeID));
+        auto raft = std::dynamic_pointer_cast<RaftModel>(node -> getComponent("raft"));
+        auto controller = std::dynamic_pointer_cast<RaftControllerModel>(raft -> getComponent("raft-controller"));
+        leaders += controller -> getState().state == RaftStatus::LEADER;
+        // Every message in and out of the node went through its one core
+        ASSERT_GT(node -> getCpu() -> getJobs(), 0);
+        ASSERT_GT(node -> getCpu() -> getBusyTime(), 0);
+    }
+    ASSERT_GE(leaders, 1);
+}
+
+TEST_F(SimulationFixture, testElectionWithDisk) {
+    auto model = std::make_shared<SimulationModel>("simulation");
+    model -> setDisk(DiskConfig());
+    RootCoordinator root(model);
+    root.simulate(0.3);
+
+    int leaders = 0;
+    for (const std::string nodeID : {"node0", "node1", "node2"}) {
+        auto node = std::dynamic_pointer_cast<NodeModel>(model -> getComponent(nodeID));
+        auto raft = std::dynamic_pointer_cast<RaftModel>(node -> getComponent("raft"));
+        auto controller = std::dynamic_pointer_cast<RaftControllerModel>(raft -> getComponent("raft-controller"));
+        leaders += controller -> getState().state == RaftStatus::LEADER;
+        // Every node persisted at least its vote
+        auto disk = std::dynamic_pointer_cast<DiskModel>(node -> getComponent("disk"));
+        ASSERT_GT(disk -> getState().fsyncs, 0);
+    }
+    ASSERT_GE(leaders, 1);
+}
+
+TEST_F(SimulationFixture, testClosedLoopClientCompletesRequests) {
+    ClientConfig client;
+    client.arrivals = ArrivalProcess::CLOSED_LOOP;
+    client.outstanding = 2;
+    client.start = 0.3;  // After the first election
+    auto model = std::make_shared<SimulationModel>("simulation", AuthMode::NONE, client);
+    RootCoordinator root(model);
+    root.simulate(0.6);
+
+    auto clientModel = std::dynamic_pointer_cast<ClientModel>(model -> getComponent("client"));
+    const ClientState& s = clientModel -> getState();
+    ASSERT_GT(s.completed.size(), 0);
+    for (const auto& record : s.completed) {
+        ASSERT_GE(record.commitTime, record.submitTime);
+        ASSERT_GE(record.responseTime, record.applyTime);
+        ASSERT_GT(record.logIndex, 0);
+    }
+    ASSERT_GT(s.latencyPercentile(0.99), 0);
+}
+
+TEST_F(SimulationFixture, testReadIndexReadsSkipTheLog) {
+    ClientConfig client;
+    client.arrivals = ArrivalProcess::CLOSED_LOOP;
+    client.outstanding = 4;
+    client.start = 0.3;
+    client.readFraction = 1;
+    auto model = std::make_shared<SimulationModel>("simulation", AuthMode::NONE, client);
+    model -> setReadMode(ReadMode::READ_INDEX);
+    RootCoordinator root(model);
+    root.simulate(0.6);
+
+    const ClientState& s = std::dynamic_pointer_cast<ClientModel>(model -> getComponent("client")) -> getState();
+    ASSERT_GT(s.completed.size(), 100);
+    for (const std::string nodeID : {"node0", "node1", "node2"}) {
+        auto raft = std::dynamic_pointer_cast<RaftModel>(std::dynamic_pointer_cast<NodeModel>(model -> getComponent(nodeID)) -> getComponent("raft"));
+        auto controller = std::dynamic_pointer_cast<RaftControllerModel>(raft -> getComponent("raft-controller"));
+        // Elections and heartbeats only
+        ASSERT_LT(controller -> getState().messageLog.size(), 20);
+    }
+}
+
+TEST_F(SimulationFixture, testFollowerReadsSpreadOverFiveNodes) {
+    ClientConfig client;
+    client.arrivals = ArrivalProcess::CLOSED_LOOP;
+    client.outstanding = 8;
+    client.start = 0.3;
+    client.readFraction = 1;
+    client.spreadReads = true;
+    auto model = std::make_shared<SimulationModel>("simulation", AuthMode::NONE, client, 5);
+    model -> setReadMode(ReadMode::READ_INDEX);
+    model -> setFollowerReads(FollowerReadMode::READ_INDEX);
+    RootCoordinator root(model);
+    root.simulate(0.6);
+
+    const ClientState& s = std::dynamic_pointer_cast<ClientModel>(model -> getComponent("client")) -> getState();
+    ASSERT_GT(s.completed.size(), 100);
+    std::set<std::string> servedBy;
+    for (const auto& record : s.completed) {
+        servedBy.insert(record.servedBy);
+    }
+    ASSERT_EQ(servedBy.size(), 5);
+}
+
+TEST_F(SimulationFixture, testPreVoteKeepsTermThroughPartition) {
+    auto model = std::make_shared<SimulationModel>("simulation");
+    model -> setPreVote(true);
+    RootCoordinator root(model);
+    root.simulate(0.5);
+
+    auto controllerState = [&](const std::string& nodeID) -> const RaftState& {
+        auto raft = std::dynamic_pointer_cast<RaftModel>(std::dynamic_pointer_cast<NodeModel>(model -> getComponent(nodeID)) -> getComponent("raft"));
+        return std::dynamic_pointer_cast<RaftControllerModel>(raft -> getComponent("raft-controller")) -> getState();
+    };
+    const std::string leader = controllerState("node0").leaderID;
+    const int term = controllerState("node0").currentTerm;
+    ASSERT_FALSE(leader.empty());
+    const std::string follower = leader == "node0" ? "node1" : "node0";
+
+    // The follower times out over and over while cut off, but never wins a pre-vote
+    model -> isolate(follower, 0.5, 1.5);
+    root.simulate(2.0);
+    for (const std::string nodeID : {"node0", "node1", "node2"}) {
+        ASSERT_EQ(controllerState(nodeID).currentTerm, term);
+        ASSERT_EQ(controllerState(nodeID).leaderID, leader);
+    }
+}
+
+TEST_F(SimulationFixture, testSeededRunsAreReproducible) {
+    // Controller states of every node after a run seeded with `seed`
+    auto run = [](unsigned int seed) {
+        RandomNumberGeneratorDEVS::seed(seed);
+        auto model = std::make_shared<SimulationModel>("simulation");
+        RootCoordinator root(model);
+        root.simulate(0.5);
+        std::vector<std::string> states;
+        for (const std::string nodeID : {"node0", "node1", "node2"}) {
+            auto raft = std::dynamic_pointer_cast<RaftModel>(std::dynamic_pointer_cast<NodeModel>(model -> getComponent(nodeID)) -> getComponent("raft"));
+            auto controller = std::dynamic_pointer_cast<RaftControllerModel>(raft -> getComponent("raft-controller"));
+            std::ostringstream state;
+            state.precision(17);
+            state << controller -> getState();
+            states.push_back(state.str());
+        }
+        return states;
+    };
+    ASSERT_EQ(run(42), run(42));
+    ASSERT_NE(run(42), run(7));
+}
 
 // Main function for Google Test
 int main(int argc, char **argv) {
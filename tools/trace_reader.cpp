@@ -0,0 +1,182 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <string>
+#include "../logger/binary_trace.hpp"
+
+// Offline reader for binary simulation traces written by BinaryTraceLogger.
+//
+//   trace_reader <trace.bin> [--model NAME] [--port NAME] [--kind time|output|state]
+//                            [--from T] [--to T] [--csv]
+//
+// Without --csv a summary of the matching records is printed, with --csv every matching
+// record becomes a "time,kind,model_id,model,port,payload" line.
+
+struct Filter {
+    std::string model;
+    std::string port;
+    std::string kind;
+    double from = -std::numeric_limits<double>::infinity();
+    double to = std::numeric_limits<double>::infinity();
+
+    bool matches(const LogRecord& record, const std::string& kindName) const {
+        return (model.empty() || record.modelName == model)
+            && (port.empty() || record.portName == port)
+            && (kind.empty() || kindName == kind)
+            && record.time >= from && record.time <= to;
+    }
+};
+
+const char* KindName(LogRecordKind kind) {
+    switch (kind) {
+        case LogRecordKind::START: return "start";
+        case LogRecordKind::STOP: return "stop";
+        case LogRecordKind::TIME: return "time";
+        case LogRecordKind::OUTPUT: return "output";
+        case LogRecordKind::STATE: return "state";
+        case LogRecordKind::DIAGNOSTIC: return "diagnostic";
+    }
+    return "unknown";
+}
+
+// Quote a CSV field when it needs it, doubling embedded quotes
+void WriteCsvField(std::string& out, const std::string& field) {
+    if (field.find_first_of(",\"\n") == std::string::npos) {
+        out += field;
+        return;
+    }
+    out += '"';
+    for (char c : field) {
+        if (c == '"') {
+            out += '"';
+        }
+        out += c;
+    }
+    out += '"';
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <trace.bin> [--model NAME] [--port NAME] "
+                  << "[--kind time|output|state] [--from T] [--to T] [--csv]" << std::endl;
+        return 2;
+    }
+
+    Filter filter;
+    bool csv = false;
+    for (int i = 2; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--csv") {
+            csv = true;
+        } else if (i + 1 < argc && option == "--model") {
+            filter.model = argv[++i];
+        } else if (i + 1 < argc && option == "--port") {
+            filter.port = argv[++i];
+        } else if (i + 1 < argc && option == "--kind") {
+            filter.kind = argv[++i];
+        } else if (i + 1 < argc && option == "--from") {
+            filter.from = std::atof(argv[++i]);
+        } else if (i + 1 < argc && option == "--to") {
+            filter.to = std::atof(argv[++i]);
+        } else {
+            std::cerr << "unknown option " << option << std::endl;
+            return 2;
+        }
+    }
+
+    int fd = open(argv[1], O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0) {
+        std::cerr << "cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    void* mapped = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    if (mapped == MAP_FAILED) {
+        std::cerr << "cannot map " << argv[1] << std::endl;
+        close(fd);
+        return 1;
+    }
+    madvise(mapped, size, MADV_SEQUENTIAL);
+
+    int status = 0;
+    try {
+        BinaryTrace::Decoder decoder(static_cast<const char*>(mapped), size);
+        LogRecord record;
+        std::string out;
+        long total = 0;
+        long matched = 0;
+        double first = std::numeric_limits<double>::infinity();
+        double last = -std::numeric_limits<double>::infinity();
+        std::map<std::string, long> perModel;
+        std::map<std::string, long> perKind;
+
+        if (csv) {
+            out += "time,kind,model_id,model,port,payload\n";
+        }
+        while (decoder.next(record)) {
+            total++;
+            const char* kindName = KindName(record.kind);
+            if (!filter.matches(record, kindName)) {
+                continue;
+            }
+            matched++;
+            if (csv) {
+                char time[32];
+                out.append(time, std::snprintf(time, sizeof(time), "%.9g", record.time));
+                out += ',';
+                out += kindName;
+                out += ',';
+                out += std::to_string(record.modelId);
+                out += ',';
+                WriteCsvField(out, record.modelName);
+                out += ',';
+                WriteCsvField(out, record.portName);
+                out += ',';
+                WriteCsvField(out, record.payload);
+                out += '\n';
+                if (out.size() >= (1 << 20)) {
+                    std::cout.write(out.data(), out.size());
+                    out.clear();
+                }
+            } else {
+                perKind[kindName]++;
+                if (!record.modelName.empty()) {
+                    perModel[record.modelName]++;
+                }
+                if (record.kind == LogRecordKind::TIME || record.kind == LogRecordKind::OUTPUT || record.kind == LogRecordKind::STATE) {
+                    first = std::min(first, record.time);
+                    last = std::max(last, record.time);
+                }
+            }
+        }
+
+        if (csv) {
+            std::cout.write(out.data(), out.size());
+        } else {
+            std::cout << "trace: " << argv[1] << " (" << size << " bytes, resolution " << decoder.getResolution() << " s)\n"
+                      << "records: " << total << ", matching: " << matched << "\n";
+            if (matched > 0 && first <= last) {
+                std::cout << "time range: " << first << " - " << last << "\n";
+            }
+            for (const auto& [kind, count] : perKind) {
+                std::cout << "  " << kind << ": " << count << "\n";
+            }
+            for (const auto& [model, count] : perModel) {
+                std::cout << "  " << model << ": " << count << "\n";
+            }
+        }
+    } catch (const std::exception& error) {
+        std::cerr << argv[1] << ": " << error.what() << std::endl;
+        status = 1;
+    }
+
+    munmap(mapped, size);
+    close(fd);
+    return status;
+}
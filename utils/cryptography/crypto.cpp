@@ -1,4 +1,9 @@
 #include "crypto.hpp"
+#include <cstring>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#include <cpuid.h>
+#endif
 
 // Function to convert RSA Private Key to Base64-encoded string
 std::string Crypto::PrivateKeyToBase64(const RSA::PrivateKey& privateKey) {
@@ -128,3 +133,271 @@ bool Crypto::VerifySignature(const std::string& data, const std::string& base64P
     return verifier.VerifyMessage(hash, sizeof(hash), (const byte*)decodedSignature.data(), decodedSignature.size());
 }
 
+// Function to hash data (SHA-256) and return the raw digest as a string
+std::string Crypto::EntryDigest(const std::string& data) {
+    byte hash[SHA256::DIGESTSIZE];
+    HashData(data, hash);
+    return std::string((const char*)hash, sizeof(hash));
+}
+
+namespace {
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRYPTO_MULTI_BUFFER_AVX2 1
+
+// Batches smaller than this hash faster one message at a time than in half-empty lanes
+const size_t MULTI_BUFFER_MIN_BATCH = 8;
+
+const uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+const uint32_t SHA256_IV[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+const int LANES = 8;
+
+// One message being hashed in a lane: full blocks are read in place, the padded tail is copied out
+struct LaneJob {
+    const byte* data = nullptr;
+    size_t fullBlocks = 0;
+    size_t totalBlocks = 0;
+    size_t nextBlock = 0;
+    size_t output = 0;   // Index of the message in the batch
+    byte tail[128];
+};
+
+void PrepareLaneJob(LaneJob& job, const std::string& message, size_t output) {
+    size_t remainder = message.size() % 64;
+    job.data = (const byte*)message.data();
+    job.fullBlocks = message.size() / 64;
+    job.nextBlock = 0;
+    job.output = output;
+
+    // 0x80 terminator and the 64-bit big-endian bit length, spilling into a second block if needed
+    size_t tailBlocks = (remainder + 9 > 64) ? 2 : 1;
+    std::memset(job.tail, 0, sizeof(job.tail));
+    std::memcpy(job.tail, job.data + job.fullBlocks * 64, remainder);
+    job.tail[remainder] = 0x80;
+    uint64_t bits = static_cast<uint64_t>(message.size()) * 8;
+    for (int i = 0; i < 8; i++) {
+        job.tail[tailBlocks * 64 - 1 - i] = static_cast<byte>(bits >> (8 * i));
+    }
+    job.totalBlocks = job.fullBlocks + tailBlocks;
+}
+
+const byte* LaneJobBlock(const LaneJob& job) {
+    if (job.nextBlock < job.fullBlocks) {
+        return job.data + job.nextBlock * 64;
+    }
+    return job.tail + (job.nextBlock - job.fullBlocks) * 64;
+}
+
+__attribute__((target("avx2"))) inline __m256i Rotr(__m256i x, int n) {
+    return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+}
+
+// One SHA-256 compression of eight independent blocks, state and words are laid out [word][lane]
+__attribute__((target("avx2"))) void CompressLanesAVX2(uint32_t state[8][LANES], const uint32_t words[16][LANES]) {
+    __m256i w[16];
+    for (int t = 0; t < 16; t++) {
+        w[t] = _mm256_load_si256((const __m256i*)words[t]);
+    }
+    __m256i v[8];
+    for (int i = 0; i < 8; i++) {
+        v[i] = _mm256_load_si256((const __m256i*)state[i]);
+    }
+    __m256i a = v[0], b = v[1], c = v[2], d = v[3], e = v[4], f = v[5], g = v[6], h = v[7];
+
+    for (int t = 0; t < 64; t++) {
+        if (t >= 16) {
+            __m256i w2 = w[(t - 2) & 15];
+            __m256i w15 = w[(t - 15) & 15];
+            __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(Rotr(w15, 7), Rotr(w15, 18)), _mm256_srli_epi32(w15, 3));
+            __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(Rotr(w2, 17), Rotr(w2, 19)), _mm256_srli_epi32(w2, 10));
+            w[t & 15] = _mm256_add_epi32(_mm256_add_epi32(w[t & 15], s0), _mm256_add_epi32(w[(t - 7) & 15], s1));
+        }
+        __m256i bigSigma1 = _mm256_xor_si256(_mm256_xor_si256(Rotr(e, 6), Rotr(e, 11)), Rotr(e, 25));
+        __m256i choose = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+        __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, bigSigma1),
+                     _mm256_add_epi32(_mm256_add_epi32(choose, _mm256_set1_epi32(static_cast<int>(SHA256_K[t]))), w[t & 15]));
+        __m256i bigSigma0 = _mm256_xor_si256(_mm256_xor_si256(Rotr(a, 2), Rotr(a, 13)), Rotr(a, 22));
+        __m256i majority = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+        __m256i t2 = _mm256_add_epi32(bigSigma0, majority);
+        h = g;
+        g = f;
+        f = e;
+        e = _mm256_add_epi32(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = _mm256_add_epi32(t1, t2);
+    }
+
+    __m256i out[8] = {a, b, c, d, e, f, g, h};
+    for (int i = 0; i < 8; i++) {
+        _mm256_store_si256((__m256i*)state[i], _mm256_add_epi32(v[i], out[i]));
+    }
+}
+
+// Keep all eight lanes busy: whenever a lane finishes its message, the next one in the batch
+// starts there, so messages of different lengths share the lanes without padding to the longest
+void EntryDigestsAVX2(const std::vector<std::string>& data, std::vector<std::string>& digests) {
+    static const byte zeroBlock[64] = {};
+    LaneJob jobs[LANES];
+    bool active[LANES];
+    alignas(32) uint32_t state[8][LANES];
+    alignas(32) uint32_t words[16][LANES];
+    size_t next = 0;
+    int running = 0;
+
+    auto startJob = [&](int lane) {
+        active[lane] = next < data.size();
+        if (active[lane]) {
+            PrepareLaneJob(jobs[lane], data[next], next);
+            next++;
+            for (int i = 0; i < 8; i++) {
+                state[i][lane] = SHA256_IV[i];
+            }
+        }
+        return active[lane];
+    };
+    for (int lane = 0; lane < LANES; lane++) {
+        running += startJob(lane);
+    }
+
+    while (running > 0) {
+        // Gather the next block of every lane as big-endian words
+        for (int lane = 0; lane < LANES; lane++) {
+            const byte* block = active[lane] ? LaneJobBlock(jobs[lane]) : zeroBlock;
+            for (int t = 0; t < 16; t++) {
+                words[t][lane] = (uint32_t(block[4 * t]) << 24) | (uint32_t(block[4 * t + 1]) << 16)
+                               | (uint32_t(block[4 * t + 2]) << 8) | uint32_t(block[4 * t + 3]);
+            }
+        }
+
+        CompressLanesAVX2(state, words);
+
+        for (int lane = 0; lane < LANES; lane++) {
+            if (!active[lane] || ++jobs[lane].nextBlock < jobs[lane].totalBlocks) {
+                continue;
+            }
+            std::string& digest = digests[jobs[lane].output];
+            digest.resize(SHA256::DIGESTSIZE);
+            for (int i = 0; i < 8; i++) {
+                digest[4 * i] = static_cast<char>(state[i][lane] >> 24);
+                digest[4 * i + 1] = static_cast<char>(state[i][lane] >> 16);
+                digest[4 * i + 2] = static_cast<char>(state[i][lane] >> 8);
+                digest[4 * i + 3] = static_cast<char>(state[i][lane]);
+            }
+            if (!startJob(lane)) {
+                running--;
+            }
+        }
+    }
+}
+#endif
+
+}  // namespace
+
+// Function to hash a batch of independent messages (SHA-256), eight at a time in AVX2 lanes when the CPU has them
+std::vector<std::string> Crypto::EntryDigests(const std::vector<std::string>& data, BatchHashing mode) {
+    std::vector<std::string> digests(data.size());
+#ifdef CRYPTO_MULTI_BUFFER_AVX2
+    // SHA extensions hash a single stream faster than eight AVX2 lanes
+    static const bool shaExtensions = [] {
+        unsigned int eax, ebx, ecx, edx;
+        return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & (1u << 29));
+    }();
+    bool useLanes = (mode == BatchHashing::MULTI_BUFFER) || (mode == BatchHashing::AUTO && !shaExtensions);
+    if (useLanes && data.size() >= MULTI_BUFFER_MIN_BATCH && MultiBufferHashingAvailable()) {
+        EntryDigestsAVX2(data, digests);
+        return digests;
+    }
+#endif
+    // Portable path, one message at a time
+    for (size_t i = 0; i < data.size(); i++) {
+        digests[i] = EntryDigest(data[i]);
+    }
+    return digests;
+}
+
+// Function to check whether EntryDigests can use the AVX2 multi-buffer path on this CPU
+bool Crypto::MultiBufferHashingAvailable() {
+#ifdef CRYPTO_MULTI_BUFFER_AVX2
+    static const bool available = __builtin_cpu_supports("avx2");
+    return available;
+#else
+    return false;
+#endif
+}
+
+// Function to hash two digests together: returns H(left || right) as raw bytes
+std::string Crypto::LinkDigest(const std::string& left, const std::string& right) {
+    SHA256 sha256;
+    sha256.Update((const byte*)left.data(), left.size());
+    sha256.Update((const byte*)right.data(), right.size());
+
+    byte hash[SHA256::DIGESTSIZE];
+    sha256.Final(hash);
+    return std::string((const char*)hash, sizeof(hash));
+}
+
+// Function to extend a SHA-256 hash chain: returns H(previousDigest || H(data)) as raw bytes
+std::string Crypto::ChainDigest(const std::string& previousDigest, const std::string& data) {
+    // Hash the entry on its own first, the link only hashes two digests
+    return LinkDigest(previousDigest, EntryDigest(data));
+}
+
+// Function to create a random pre-shared HMAC key, returned as a Base64 string
+std::string Crypto::GenerateSymmetricKey() {
+    AutoSeededRandomPool rng;
+    byte key[SHA256::DIGESTSIZE];
+    rng.GenerateBlock(key, sizeof(key));
+
+    std::string base64Key;
+    StringSource(key, sizeof(key), true, new Base64Encoder(new StringSink(base64Key), false));
+    return base64Key;
+}
+
+// Function to compute an HMAC-SHA256 tag with a Base64 key and return it as a Base64 string
+std::string Crypto::ComputeHMAC(const std::string& data, const std::string& base64Key) {
+    // Decode the Base64 key
+    std::string decodedKey;
+    StringSource(base64Key, true, new Base64Decoder(new StringSink(decodedKey)));
+
+    // Compute the tag
+    HMAC<SHA256> hmac((const byte*)decodedKey.data(), decodedKey.size());
+    byte mac[HMAC<SHA256>::DIGESTSIZE];
+    hmac.CalculateDigest(mac, (const byte*)data.data(), data.size());
+
+    // Convert the tag to a Base64 string
+    std::string base64Mac;
+    StringSource(mac, sizeof(mac), true, new Base64Encoder(new StringSink(base64Mac), false));
+    return base64Mac;
+}
+
+// Function to verify a Base64 HMAC-SHA256 tag using the pre-shared Base64 key
+bool Crypto::VerifyHMAC(const std::string& data, const std::string& base64Key, const std::string& base64Mac) {
+    // Decode the Base64 key and tag
+    std::string decodedKey;
+    StringSource(base64Key, true, new Base64Decoder(new StringSink(decodedKey)));
+    std::string decodedMac;
+    StringSource(base64Mac, true, new Base64Decoder(new StringSink(decodedMac)));
+
+    if (decodedMac.size() != HMAC<SHA256>::DIGESTSIZE) {
+        return false;
+    }
+
+    // Constant time comparison is done by the verifier
+    HMAC<SHA256> hmac((const byte*)decodedKey.data(), decodedKey.size());
+    return hmac.VerifyDigest((const byte*)decodedMac.data(), (const byte*)data.data(), data.size());
+}
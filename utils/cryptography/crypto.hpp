@@ -7,12 +7,18 @@
 #include <osrng.h>
 #include <hex.h>
 #include <base64.h>
+#include <hmac.h>
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
 
 using namespace CryptoPP;
 
+// How Crypto::EntryDigests spreads a batch over the hash engine. AUTO takes the multi-buffer
+// lanes unless the CPU has SHA extensions, which make single-message hashing faster.
+enum class BatchHashing { AUTO, SEQUENTIAL, MULTI_BUFFER };
+
 class Crypto {
 public:
     // Function to convert RSA Private Key to Base64-encoded string
@@ -41,6 +47,30 @@ public:
 
     // Function to verify the signature using RSA public key and Base64-encoded signature string
     static bool VerifySignature(const std::string& data, const std::string& base64PublicKey, const std::string& base64Signature);
+
+    // Function to hash data (SHA-256) and return the raw digest as a string
+    static std::string EntryDigest(const std::string& data);
+
+    // Function to hash a batch of independent messages (SHA-256), eight at a time in AVX2 lanes when the CPU has them
+    static std::vector<std::string> EntryDigests(const std::vector<std::string>& data, BatchHashing mode = BatchHashing::AUTO);
+
+    // Function to check whether EntryDigests can use the AVX2 multi-buffer path on this CPU
+    static bool MultiBufferHashingAvailable();
+
+    // Function to hash two digests together: returns H(left || right) as raw bytes
+    static std::string LinkDigest(const std::string& left, const std::string& right);
+
+    // Function to extend a SHA-256 hash chain: returns H(previousDigest || H(data)) as raw bytes
+    static std::string ChainDigest(const std::string& previousDigest, const std::string& data);
+
+    // Function to create a random pre-shared HMAC key, returned as a Base64 string
+    static std::string GenerateSymmetricKey();
+
+    // Function to compute an HMAC-SHA256 tag with a Base64 key and return it as a Base64 string
+    static std::string ComputeHMAC(const std::string& data, const std::string& base64Key);
+
+    // Function to verify a Base64 HMAC-SHA256 tag using the pre-shared Base64 key
+    static bool VerifyHMAC(const std::string& data, const std::string& base64Key, const std::string& base64Mac);
 };
 
 #endif // CRYPTO_DEVS_HPP
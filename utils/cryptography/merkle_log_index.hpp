@@ -0,0 +1,197 @@
+#ifndef MERKLE_LOG_INDEX_HPP
+#define MERKLE_LOG_INDEX_HPP
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include "crypto.hpp"
+
+// Outcome of reconciling a follower's log against the leader's through subtree hashes
+struct ResyncReport {
+    int roundTrips = 0;        // Request/response exchanges, including the final entry transfer
+    size_t hashBytes = 0;      // Bytes spent on subtree hashes and mismatch bitmaps
+    size_t entryBytes = 0;     // Bytes of leader entries shipped for the divergent ranges
+    std::vector<std::pair<size_t, size_t>> divergentRanges;  // [begin, end) entry indices to replace
+};
+
+// Merkle tree over fixed-size segments of the Raft log. A leaf is the hash chain of the entry
+// digests in its segment and is extended on every append, parents are rehashed lazily along
+// the right spine when a subtree hash is requested. Trees with different lengths line up
+// because a node always covers the same leaf range, missing subtrees hash to "".
+class MerkleLogIndex {
+    public:
+        MerkleLogIndex() : MerkleLogIndex(64) {}
+
+        explicit MerkleLogIndex(size_t _segmentSize) : segmentSize(_segmentSize) {}
+
+        // Add the digest of the next log entry
+        void append(const std::string& entryDigest) {
+            size_t leaf = size() / segmentSize;
+            entryDigests.append(entryDigest);
+            if (levels.empty()) {
+                levels.emplace_back();
+            }
+            if (leaf == levels[0].size()) {
+                levels[0].push_back(Crypto::LinkDigest("", entryDigest));
+            } else {
+                levels[0][leaf] = Crypto::LinkDigest(levels[0][leaf], entryDigest);
+            }
+            markDirty(leaf);
+        }
+
+        // Drop every entry from index size onwards
+        void truncate(size_t size) {
+            if (size >= this -> size()) {
+                return;
+            }
+            entryDigests.resize(size * SHA256::DIGESTSIZE);
+            size_t leaves = (size + segmentSize - 1) / segmentSize;
+            levels[0].resize(leaves);
+            // Rebuild the now partial last leaf from its entries
+            if (leaves > 0 && size % segmentSize != 0) {
+                std::string leafHash;
+                for (size_t i = (leaves - 1) * segmentSize; i < size; i++) {
+                    leafHash = Crypto::LinkDigest(leafHash, entryDigests.substr(i * SHA256::DIGESTSIZE, SHA256::DIGESTSIZE));
+                }
+                levels[0][leaves - 1] = leafHash;
+            }
+            markDirty(leaves > 0 ? leaves - 1 : 0);
+        }
+
+        size_t size() const { return entryDigests.size() / SHA256::DIGESTSIZE; }
+
+        size_t getSegmentSize() const { return segmentSize; }
+
+        size_t leafCount() const { return levels.empty() ? 0 : levels[0].size(); }
+
+        // Hash of the node covering leaves [index * 2^level, (index + 1) * 2^level)
+        std::string nodeHash(size_t level, size_t index) const {
+            refresh();
+            if (level < levels.size()) {
+                return index < levels[level].size() ? levels[level][index] : "";
+            }
+            // Above our own root, the right half is empty
+            return combine(nodeHash(level - 1, 2 * index), nodeHash(level - 1, 2 * index + 1));
+        }
+
+        std::string rootHash() const {
+            refresh();
+            return levels.empty() || levels.back().empty() ? "" : levels.back()[0];
+        }
+
+        // Walk both trees top-down, one level per round trip: the follower sends the hashes of
+        // the children of every mismatched node and the leader answers with a mismatch bitmap.
+        // Divergent leaves are then fetched from the leader in one last exchange.
+        static ResyncReport Reconcile(const MerkleLogIndex& follower, const MerkleLogIndex& leader,
+                                      const std::function<size_t(size_t)>& entryBytes) {
+            ResyncReport report;
+            size_t segment = leader.segmentSize;
+            size_t leaves = std::max(follower.leafCount(), leader.leafCount());
+            if (leaves == 0) {
+                return report;
+            }
+
+            size_t top = 0;
+            while ((size_t(1) << top) < leaves) {
+                top++;
+            }
+
+            std::vector<size_t> frontier = {0};
+            for (size_t level = top + 1; level-- > 0;) {
+                report.roundTrips++;
+                report.hashBytes += frontier.size() * SHA256::DIGESTSIZE + (frontier.size() + 7) / 8;
+
+                std::vector<size_t> mismatched;
+                for (size_t index : frontier) {
+                    if (follower.nodeHash(level, index) != leader.nodeHash(level, index)) {
+                        mismatched.push_back(index);
+                    }
+                }
+                if (level == 0 || mismatched.empty()) {
+                    frontier = (level == 0) ? mismatched : std::vector<size_t>{};
+                    break;
+                }
+
+                // Children that start past both logs are empty on both sides, skip them
+                frontier.clear();
+                for (size_t index : mismatched) {
+                    for (size_t child : {2 * index, 2 * index + 1}) {
+                        if ((child << (level - 1)) < leaves) {
+                            frontier.push_back(child);
+                        }
+                    }
+                }
+            }
+
+            // Merge adjacent divergent leaves into entry ranges
+            for (size_t leaf : frontier) {
+                size_t begin = leaf * segment;
+                size_t end = (leaf + 1) * segment;
+                if (!report.divergentRanges.empty() && report.divergentRanges.back().second == begin) {
+                    report.divergentRanges.back().second = end;
+                } else {
+                    report.divergentRanges.emplace_back(begin, end);
+                }
+            }
+
+            // Ship the leader's entries for those ranges, the follower drops its own copies
+            for (auto& range : report.divergentRanges) {
+                range.second = std::min(range.second, std::max(leader.size(), follower.size()));
+                for (size_t i = range.first; i < std::min(range.second, leader.size()); i++) {
+                    report.entryBytes += entryBytes(i);
+                }
+            }
+            if (!report.divergentRanges.empty()) {
+                report.roundTrips++;
+            }
+            return report;
+        }
+
+    private:
+        size_t segmentSize;
+        std::string entryDigests;  // Raw entry digests back to back, kept to rebuild a truncated leaf
+        mutable std::vector<std::vector<std::string>> levels;  // levels[0] holds the leaves
+        mutable bool dirty = false;
+        mutable size_t dirtyLeaf = 0;  // Leftmost leaf whose ancestors are stale
+
+        static std::string combine(const std::string& left, const std::string& right) {
+            if (left.empty() && right.empty()) {
+                return "";
+            }
+            return Crypto::LinkDigest(left, right);
+        }
+
+        void markDirty(size_t leaf) {
+            dirtyLeaf = dirty ? std::min(dirtyLeaf, leaf) : leaf;
+            dirty = true;
+        }
+
+        // Rehash the ancestors of every leaf at or right of dirtyLeaf
+        void refresh() const {
+            if (!dirty) {
+                return;
+            }
+            size_t from = dirtyLeaf;
+            size_t level = 0;
+            while (levels[level].size() > 1) {
+                size_t parents = (levels[level].size() + 1) / 2;
+                if (levels.size() <= level + 1) {
+                    levels.emplace_back();
+                }
+                levels[level + 1].resize(parents);
+                from /= 2;
+                for (size_t i = from; i < parents; i++) {
+                    const std::string& left = levels[level][2 * i];
+                    std::string right = (2 * i + 1 < levels[level].size()) ? levels[level][2 * i + 1] : "";
+                    levels[level + 1][i] = combine(left, right);
+                }
+                level++;
+            }
+            // Drop levels left over from a longer log
+            levels.resize(level + 1);
+            dirty = false;
+        }
+};
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef DIAGNOSTICS_HPP
+#define DIAGNOSTICS_HPP
+
+#include <sstream>
+#include <string>
+
+// Severity of a diagnostic message, in increasing order
+enum class DiagLevel : int { TRACE = 0, DEBUG = 1, INFO = 2, WARN = 3, ERROR = 4, OFF = 5 };
+
+// Levels below this are compiled out of RAFT_DIAG entirely, arguments included.
+// Build with -DRAFT_DIAG_COMPILED_LEVEL=5 to strip every diagnostic.
+#ifndef RAFT_DIAG_COMPILED_LEVEL
+#define RAFT_DIAG_COMPILED_LEVEL 1
+#endif
+
+// Receives the diagnostics that pass the runtime level, e.g. RAFTLogger
+class DiagnosticSink {
+    public:
+        virtual ~DiagnosticSink() = default;
+        virtual void logDiagnostic(DiagLevel level, double time, const std::string& source, const std::string& message) = 0;
+};
+
+// Process-wide diagnostic switchboard. Models emit through RAFT_DIAG, which only builds the
+// message when the level is compiled in, enabled at runtime and a sink is installed, so
+// disabled levels cost one comparison. The simulation is single threaded, like the models
+// that emit diagnostics from their transitions.
+class Diagnostics {
+    public:
+        static bool Enabled(DiagLevel level) {
+            return sink != nullptr && level >= runtimeLevel;
+        }
+
+        static void SetLevel(DiagLevel level) {
+            runtimeLevel = level;
+        }
+
+        static DiagLevel Level() {
+            return runtimeLevel;
+        }
+
+        static void SetSink(DiagnosticSink* _sink) {
+            sink = _sink;
+        }
+
+        static DiagnosticSink* Sink() {
+            return sink;
+        }
+
+        static void Emit(DiagLevel level, double time, const std::string& source, const std::string& message) {
+            if (sink) {
+                sink -> logDiagnostic(level, time, source, message);
+            }
+        }
+
+        static const char* LevelName(DiagLevel level) {
+            switch (level) {
+                case DiagLevel::TRACE: return "TRACE";
+                case DiagLevel::DEBUG: return "DEBUG";
+                case DiagLevel::INFO: return "INFO";
+                case DiagLevel::WARN: return "WARN";
+                case DiagLevel::ERROR: return "ERROR";
+                case DiagLevel::OFF: return "OFF";
+            }
+            return "UNKNOWN";
+        }
+
+    private:
+        inline static DiagnosticSink* sink = nullptr;
+        inline static DiagLevel runtimeLevel = DiagLevel::INFO;
+};
+
+// RAFT_DIAG(DiagLevel::DEBUG, s.currentTime, s.nodeID, "Appended entry #" << index);
+// The message is a stream expression and is only evaluated when the diagnostic is emitted.
+#define RAFT_DIAG(level, time, source, message)                                           \
+    do {                                                                                  \
+        if constexpr (static_cast<int>(level) >= RAFT_DIAG_COMPILED_LEVEL) {              \
+            if (Diagnostics::Enabled(level)) {                                            \
+                std::ostringstream diagStream;                                            \
+                diagStream << message;                                                    \
+                Diagnostics::Emit(level, time, source, diagStream.str());                 \
+            }                                                                             \
+        }                                                                                 \
+    } while (false)
+
+#endif
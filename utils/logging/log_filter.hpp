@@ -0,0 +1,179 @@
+#ifndef LOG_FILTER_HPP
+#define LOG_FILTER_HPP
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Which log records to keep. Every rule that is set must pass, empty rules keep everything.
+struct LogFilterConfig {
+    std::vector<std::string> models;  // Globs ('*', '?') on model names, or on "<node>/<model>" for models that know their node
+    std::vector<std::string> ports;   // Output port names
+    std::vector<std::pair<double, double>> windows;  // Simulation time windows [from, to]
+    size_t sampleEvery = 1;           // Keep 1 in N of the records that pass the rules above, counted per model
+    bool states = true;
+    bool outputs = true;
+};
+
+// Decides which records reach the logger. Model and port decisions are cached per model so a
+// glob is matched once, the simulation time comes from logTime.
+//
+// cadmium builds the state string before calling the logger, so models check the active
+// filter in logState() first (WantsState) and skip formatting when the record would be
+// dropped. The logger then reuses that decision for the same record instead of deciding twice.
+// There is one active filter per process, installed by FilteredLogger.
+class LogFilter {
+    public:
+        explicit LogFilter(LogFilterConfig _config) : config(std::move(_config)) {}
+
+        // '*' matches any run of characters, '?' any single character
+        static bool GlobMatch(const std::string& pattern, const std::string& text) {
+            size_t p = 0, t = 0, star = std::string::npos, resume = 0;
+            while (t < text.size()) {
+                if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t])) {
+                    p++;
+                    t++;
+                } else if (p < pattern.size() && pattern[p] == '*') {
+                    star = p++;
+                    resume = t;
+                } else if (star != std::string::npos) {
+                    p = star + 1;
+                    t = ++resume;
+                } else {
+                    return false;
+                }
+            }
+            while (p < pattern.size() && pattern[p] == '*') {
+                p++;
+            }
+            return p == pattern.size();
+        }
+
+        static LogFilter* Active() {
+            return activeFilter;
+        }
+
+        static void Activate(LogFilter* filter) {
+            activeFilter = filter;
+        }
+
+        // Lazy formatting hook for logState(): false when the active filter drops this state.
+        // node qualifies the model name for models that know which node they belong to.
+        static bool WantsState(const void* model, const std::string& modelName, const std::string& node = "") {
+            LogFilter* filter = activeFilter;
+            return !filter || filter -> decideState(filter -> hookedModels[model], modelName, node);
+        }
+
+        void setTime(double time) {
+            currentTime = time;
+        }
+
+        bool inWindow() const {
+            if (config.windows.empty()) {
+                return true;
+            }
+            for (const auto& [from, to] : config.windows) {
+                if (currentTime >= from && currentTime <= to) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Called by the logger for every state record, reuses the decision the model's hook just made
+        bool takeStateDecision(long modelId, const std::string& modelName) {
+            ModelEntry& entry = loggedModels[modelId];
+            if (pending && pendingModel == modelName) {
+                pending = false;
+                // Remember the node so this model's outputs match "<node>/<model>" globs too
+                if (entry.node != pendingNode) {
+                    entry.node = pendingNode;
+                    entry.resolved = false;
+                }
+                return pendingDecision;
+            }
+            bool keep = decideState(entry, modelName, entry.node);
+            pending = false;
+            return keep;
+        }
+
+        bool admitOutput(long modelId, const std::string& modelName, const std::string& portName) {
+            if (!config.outputs || !inWindow()) {
+                return false;
+            }
+            ModelEntry& entry = loggedModels[modelId];
+            resolve(entry, modelName, entry.node);
+            if (!entry.matched) {
+                return false;
+            }
+            PortEntry& port = entry.ports[portName];
+            if (!port.resolved) {
+                port.resolved = true;
+                port.matched = config.ports.empty()
+                    || std::find(config.ports.begin(), config.ports.end(), portName) != config.ports.end();
+            }
+            return port.matched && sample(port.outputs);
+        }
+
+        const LogFilterConfig& getConfig() const {
+            return config;
+        }
+
+    private:
+        struct PortEntry {
+            bool resolved = false;
+            bool matched = false;
+            size_t outputs = 0;  // Outputs that passed the other rules, for sampling
+        };
+
+        // Cached decisions for one model, so globs are matched once
+        struct ModelEntry {
+            bool resolved = false;
+            bool matched = false;
+            std::string node;
+            size_t states = 0;  // States that passed the other rules, for sampling
+            std::unordered_map<std::string, PortEntry> ports;
+        };
+
+        inline static LogFilter* activeFilter = nullptr;
+
+        LogFilterConfig config;
+        double currentTime = 0;
+        std::unordered_map<const void*, ModelEntry> hookedModels;  // Models deciding in logState()
+        std::unordered_map<long, ModelEntry> loggedModels;         // By cadmium model id
+        bool pending = false;
+        std::string pendingModel;
+        std::string pendingNode;
+        bool pendingDecision = false;
+
+        bool decideState(ModelEntry& entry, const std::string& modelName, const std::string& node) {
+            resolve(entry, modelName, node);
+            bool keep = config.states && inWindow() && entry.matched && sample(entry.states);
+            pending = true;
+            pendingModel = modelName;
+            pendingNode = node;
+            pendingDecision = keep;
+            return keep;
+        }
+
+        void resolve(ModelEntry& entry, const std::string& modelName, const std::string& node) {
+            if (entry.resolved && entry.node == node) {
+                return;
+            }
+            entry.resolved = true;
+            entry.node = node;
+            entry.matched = config.models.empty();
+            for (const auto& pattern : config.models) {
+                entry.matched = entry.matched || GlobMatch(pattern, modelName)
+                    || (!node.empty() && GlobMatch(pattern, node + "/" + modelName));
+            }
+        }
+
+        bool sample(size_t& counter) const {
+            return config.sampleEvery <= 1 || counter++ % config.sampleEvery == 0;
+        }
+};
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef STATE_DELTA_HPP
+#define STATE_DELTA_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Logs a model state as the fields that changed since the previous log of the same model.
+// Every keyframeInterval-th line is a full keyframe, so the state at any point of a trace is
+// the last keyframe before it with the following deltas applied. Fields are compared through
+// a 64-bit fingerprint and only the changed ones are formatted.
+//
+//   keyframe:  RaftState { state: LEADER, currentTerm: 2, ... }
+//   delta:     RaftState ~ { currentTime: 5.07 }
+//
+// A state type lists its fields once, in a fixed order, with
+//   template <typename Writer> void describe(Writer& w) const { w.field("name", value); ... }
+// Containers and secrets are described by a summary (a size, a flag), never by their content.
+class StateDelta {
+    public:
+        // Keyframe interval for models that do not set their own, 1 logs every state in full
+        inline static size_t defaultKeyframeInterval = 64;
+
+        class Writer {
+            public:
+                Writer(std::ostream& _os, std::vector<uint64_t>* _fingerprints, bool _keyframe)
+                    : os(_os), fingerprints(_fingerprints), keyframe(_keyframe) {}
+
+                template <typename T>
+                void field(const char* name, const T& value) {
+                    bool changed = keyframe;
+                    if (fingerprints) {
+                        uint64_t current = fingerprint(value);
+                        if (index == fingerprints -> size()) {
+                            fingerprints -> push_back(current);
+                            changed = true;
+                        } else if ((*fingerprints)[index] != current) {
+                            (*fingerprints)[index] = current;
+                            changed = true;
+                        }
+                    }
+                    index++;
+                    if (changed) {
+                        os << (written++ ? ", " : "") << name << ": ";
+                        if constexpr (std::is_same_v<T, bool>) {
+                            os << (value ? "true" : "false");
+                        } else {
+                            os << value;
+                        }
+                    }
+                }
+
+            private:
+                std::ostream& os;
+                std::vector<uint64_t>* fingerprints;
+                bool keyframe;
+                size_t index = 0;
+                size_t written = 0;
+
+                template <typename T>
+                static uint64_t fingerprint(const T& value) {
+                    if constexpr (std::is_enum_v<T>) {
+                        return static_cast<uint64_t>(value);
+                    } else if constexpr (std::is_floating_point_v<T>) {
+                        double widened = value;
+                        uint64_t bits;
+                        std::memcpy(&bits, &widened, sizeof(bits));
+                        return bits;
+                    } else if constexpr (std::is_arithmetic_v<T>) {
+                        return static_cast<uint64_t>(value);
+                    } else {
+                        return std::hash<std::string>{}(std::string(value));
+                    }
+                }
+        };
+
+        explicit StateDelta(size_t _keyframeInterval = defaultKeyframeInterval) : keyframeInterval(_keyframeInterval) {}
+
+        // Full description, what operator<< of a state prints
+        template <typename State>
+        static void full(std::ostream& os, const char* typeName, const State& state) {
+            os << typeName << " { ";
+            Writer writer(os, nullptr, true);
+            state.describe(writer);
+            os << " }";
+        }
+
+        // Changed fields only, or everything on a keyframe
+        template <typename State>
+        std::string log(const char* typeName, const State& state) {
+            bool keyframe = keyframeInterval <= 1 || logged % keyframeInterval == 0;
+            logged++;
+            // Reuse the stream, constructing one costs more than most deltas
+            os.str("");
+            os << typeName << (keyframe ? " { " : " ~ { ");
+            Writer writer(os, &fingerprints, keyframe);
+            state.describe(writer);
+            os << " }";
+            return os.str();
+        }
+
+    private:
+        size_t keyframeInterval;
+        size_t logged = 0;
+        std::vector<uint64_t> fingerprints;  // Last logged fingerprint of every field, in describe order
+        std::ostringstream os;
+};
+
+#endif
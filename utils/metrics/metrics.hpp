@@ -0,0 +1,303 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+// Monotonic event count
+class Counter {
+    public:
+        void add(uint64_t n = 1) {
+            total.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        uint64_t value() const {
+            return total.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<uint64_t> total{0};
+};
+
+// Current level of something (queue depth, term), remembers the highest level seen
+class Gauge {
+    public:
+        void set(int64_t value) {
+            current.store(value, std::memory_order_relaxed);
+            raiseMax(value);
+        }
+
+        void add(int64_t delta) {
+            raiseMax(current.fetch_add(delta, std::memory_order_relaxed) + delta);
+        }
+
+        int64_t value() const {
+            return current.load(std::memory_order_relaxed);
+        }
+
+        int64_t max() const {
+            return highest.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<int64_t> current{0};
+        std::atomic<int64_t> highest{0};
+
+        void raiseMax(int64_t value) {
+            int64_t seen = highest.load(std::memory_order_relaxed);
+            while (value > seen && !highest.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+            }
+        }
+};
+
+// HDR-style histogram: values are counted in integer units, exact below 2^significantBits units
+// and in log-linear buckets above, so every recorded value is known to within
+// 2^-(significantBits - 1) of itself. Values above 2^maxBits units land in the last bucket.
+class Histogram {
+    public:
+        // unit is the resolution in the caller's units, e.g. 1e-9 to record seconds at 1ns
+        explicit Histogram(double _unit = 1e-9, int _significantBits = 6, int _maxBits = 40)
+            : unit(_unit), significantBits(_significantBits), maxValue((uint64_t(1) << _maxBits) - 1) {
+            bucketCount = index(maxValue) + 1;
+            buckets = std::make_unique<std::atomic<uint64_t>[]>(bucketCount);
+            for (size_t i = 0; i < bucketCount; i++) {
+                buckets[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        void record(double value) {
+            uint64_t units = value <= 0 ? 0 : static_cast<uint64_t>(std::min(value / unit + 0.5, static_cast<double>(maxValue)));
+            buckets[index(units)].fetch_add(1, std::memory_order_relaxed);
+            recorded.fetch_add(1, std::memory_order_relaxed);
+            sum.fetch_add(units, std::memory_order_relaxed);
+            uint64_t seen = lowest.load(std::memory_order_relaxed);
+            while (units < seen && !lowest.compare_exchange_weak(seen, units, std::memory_order_relaxed)) {
+            }
+            seen = highest.load(std::memory_order_relaxed);
+            while (units > seen && !highest.compare_exchange_weak(seen, units, std::memory_order_relaxed)) {
+            }
+        }
+
+        uint64_t count() const {
+            return recorded.load(std::memory_order_relaxed);
+        }
+
+        double mean() const {
+            uint64_t n = count();
+            return n == 0 ? 0 : sum.load(std::memory_order_relaxed) * unit / n;
+        }
+
+        double min() const {
+            return count() == 0 ? 0 : lowest.load(std::memory_order_relaxed) * unit;
+        }
+
+        double max() const {
+            return highest.load(std::memory_order_relaxed) * unit;
+        }
+
+        // Value at quantile q in [0, 1], reported as the middle of its bucket
+        double percentile(double q) const {
+            uint64_t n = count();
+            if (n == 0) {
+                return 0;
+            }
+            uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * n)));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < bucketCount; i++) {
+                seen += buckets[i].load(std::memory_order_relaxed);
+                if (seen >= rank) {
+                    uint64_t low = bucketLow(i);
+                    double middle = low + (bucketWidth(i) - 1) / 2.0;
+                    return std::clamp(middle * unit, min(), max());
+                }
+            }
+            return max();
+        }
+
+    private:
+        double unit;
+        int significantBits;
+        uint64_t maxValue;
+        size_t bucketCount = 0;
+        std::unique_ptr<std::atomic<uint64_t>[]> buckets;
+        std::atomic<uint64_t> recorded{0};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> lowest{UINT64_MAX};
+        std::atomic<uint64_t> highest{0};
+
+        // Values below 2^significantBits get their own bucket, above that each power of two
+        // is split into 2^(significantBits - 1) buckets
+        size_t index(uint64_t value) const {
+            uint64_t subBuckets = uint64_t(1) << significantBits;
+            if (value < subBuckets) {
+                return static_cast<size_t>(value);
+            }
+            int shift = (63 - __builtin_clzll(value)) - significantBits + 1;
+            uint64_t half = subBuckets >> 1;
+            return static_cast<size_t>(subBuckets + (shift - 1) * half + ((value >> shift) - half));
+        }
+
+        uint64_t bucketLow(size_t i) const {
+            uint64_t subBuckets = uint64_t(1) << significantBits;
+            if (i < subBuckets) {
+                return i;
+            }
+            uint64_t half = subBuckets >> 1;
+            uint64_t shift = (i - subBuckets) / half + 1;
+            return ((i - subBuckets) % half + half) << shift;
+        }
+
+        uint64_t bucketWidth(size_t i) const {
+            uint64_t subBuckets = uint64_t(1) << significantBits;
+            return i < subBuckets ? 1 : uint64_t(1) << ((i - subBuckets) / (subBuckets >> 1) + 1);
+        }
+};
+
+// Owns every metric of a run, named "<scope>/<name>" where the scope is a model (e.g.
+// "node1/raft-controller"). Registration takes a lock, recording into a registered metric
+// never does. Models record into the active registry, installed by MetricsLogger.
+class MetricsRegistry {
+    public:
+        MetricsRegistry() : id(nextId.fetch_add(1)) {}
+
+        MetricsRegistry(const MetricsRegistry&) = delete;
+        MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+        Counter& counter(const std::string& scope, const std::string& name) {
+            return get(counters, scope + "/" + name);
+        }
+
+        Gauge& gauge(const std::string& scope, const std::string& name) {
+            return get(gauges, scope + "/" + name);
+        }
+
+        Histogram& histogram(const std::string& scope, const std::string& name, double unit = 1e-9) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto& slot = histograms[scope + "/" + name];
+            if (!slot) {
+                slot = std::make_unique<Histogram>(unit);
+            }
+            return *slot;
+        }
+
+        // One CSV row per metric: time,metric,type,value,count,mean,p50,p90,p99,max
+        void writeSnapshot(std::ostream& out, double time) const {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto& [name, counter] : counters) {
+                out << time << ',' << name << ",counter," << counter -> value() << ",,,,,,\n";
+            }
+            for (const auto& [name, gauge] : gauges) {
+                out << time << ',' << name << ",gauge," << gauge -> value() << ",,,,,," << gauge -> max() << '\n';
+            }
+            for (const auto& [name, histogram] : histograms) {
+                out << time << ',' << name << ",histogram,," << histogram -> count() << ',' << histogram -> mean() << ','
+                    << histogram -> percentile(0.5) << ',' << histogram -> percentile(0.9) << ','
+                    << histogram -> percentile(0.99) << ',' << histogram -> max() << '\n';
+            }
+        }
+
+        static void WriteSnapshotHeader(std::ostream& out) {
+            out << "time,metric,type,value,count,mean,p50,p90,p99,max\n";
+        }
+
+        // Lookups for tests and reports, nullptr when the metric was never registered
+        const Counter* findCounter(const std::string& name) const {
+            return find(counters, name);
+        }
+
+        const Gauge* findGauge(const std::string& name) const {
+            return find(gauges, name);
+        }
+
+        const Histogram* findHistogram(const std::string& name) const {
+            return find(histograms, name);
+        }
+
+        // Distinguishes registries, so cached metric pointers are not reused across runs
+        uint64_t getId() const {
+            return id;
+        }
+
+        static MetricsRegistry* Active() {
+            return activeRegistry;
+        }
+
+        static void Activate(MetricsRegistry* registry) {
+            activeRegistry = registry;
+        }
+
+    private:
+        inline static std::atomic<uint64_t> nextId{1};
+        inline static MetricsRegistry* activeRegistry = nullptr;
+
+        uint64_t id;
+        mutable std::mutex mutex;
+        // Sorted by name so snapshots list a model's metrics together
+        std::map<std::string, std::unique_ptr<Counter>> counters;
+        std::map<std::string, std::unique_ptr<Gauge>> gauges;
+        std::map<std::string, std::unique_ptr<Histogram>> histograms;
+
+        template <typename Metric>
+        Metric& get(std::map<std::string, std::unique_ptr<Metric>>& metrics, const std::string& name) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto& slot = metrics[name];
+            if (!slot) {
+                slot = std::make_unique<Metric>();
+            }
+            return *slot;
+        }
+
+        template <typename Metric>
+        const Metric* find(const std::map<std::string, std::unique_ptr<Metric>>& metrics, const std::string& name) const {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = metrics.find(name);
+            return it == metrics.end() ? nullptr : it -> second.get();
+        }
+};
+
+// A model's registered metrics, looked up in the active registry on first use and again only
+// when the active registry or the model's scope changes. Handles is a struct of metric pointers
+// constructible from (MetricsRegistry&, scope).
+template <typename Handles>
+class MetricsBinding {
+    public:
+        // nullptr when no registry is active, models then record nothing
+        Handles* get(const std::string& scope) {
+            MetricsRegistry* registry = MetricsRegistry::Active();
+            if (!registry) {
+                return nullptr;
+            }
+            if (registry -> getId() != boundRegistry) {
+                handles = Handles(*registry, scope);
+                boundRegistry = registry -> getId();
+            }
+            return &handles;
+        }
+
+        // Forget the bound metrics, e.g. after the model's scope changed
+        void reset() {
+            boundRegistry = 0;
+        }
+
+    private:
+        Handles handles;
+        uint64_t boundRegistry = 0;
+};
+
+// Metrics recorded by the packet and message processors, scoped "<node>/<processor>"
+struct ProcessorMetrics {
+    Histogram* queueWait = nullptr;  // From arrival to departure, in seconds
+
+    ProcessorMetrics() = default;
+    ProcessorMetrics(MetricsRegistry& registry, const std::string& scope)
+        : queueWait(&registry.histogram(scope, "queue_wait")) {}
+};
+
+#endif
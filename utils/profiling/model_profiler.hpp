@@ -0,0 +1,245 @@
+#ifndef MODEL_PROFILER_HPP
+#define MODEL_PROFILER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+#include <cadmium/core/modeling/atomic.hpp>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// The DEVS functions of an atomic model that are timed
+enum class ModelPhase { INTERNAL, EXTERNAL, OUTPUT, TIME_ADVANCE };
+
+// Wall time and call counts of the atomic model functions, per model type. Times are read from
+// the TSC (steady_clock where there is none) and converted to seconds for the report by
+// comparing the TSC against steady_clock over the lifetime of the profiler.
+class ModelProfiler {
+    public:
+        static constexpr size_t PHASES = 4;
+
+        struct Entry {
+            std::string type;
+            uint64_t calls[PHASES] = {};
+            uint64_t ticks[PHASES] = {};
+        };
+
+        ModelProfiler() : id(nextId.fetch_add(1)), startTicks(Now()), startTime(std::chrono::steady_clock::now()) {}
+
+        static ModelProfiler* Active() {
+            return activeProfiler;
+        }
+
+        static void Activate(ModelProfiler* profiler) {
+            activeProfiler = profiler;
+        }
+
+        static uint64_t Now() {
+#if defined(__x86_64__) || defined(__i386__)
+            return __rdtsc();
+#else
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+        }
+
+        // Slot for a model type, the caller caches it together with getId()
+        size_t typeIndex(const std::string& type) {
+            for (size_t i = 0; i < entries.size(); i++) {
+                if (entries[i].type == type) {
+                    return i;
+                }
+            }
+            entries.push_back(Entry{type});
+            return entries.size() - 1;
+        }
+
+        void add(size_t type, ModelPhase phase, uint64_t ticks) {
+            entries[type].calls[static_cast<size_t>(phase)]++;
+            entries[type].ticks[static_cast<size_t>(phase)] += ticks;
+        }
+
+        const std::vector<Entry>& getEntries() const {
+            return entries;
+        }
+
+        uint64_t getId() const {
+            return id;
+        }
+
+        // Seconds per tick, measured against steady_clock since construction
+        double secondsPerTick() const {
+#if defined(__x86_64__) || defined(__i386__)
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+            uint64_t ticks = Now() - startTicks;
+            return (ticks == 0 || seconds <= 0) ? 1e-9 : seconds / ticks;
+#else
+            return 1e-9;
+#endif
+        }
+
+        static const char* PhaseName(ModelPhase phase) {
+            switch (phase) {
+                case ModelPhase::INTERNAL: return "internalTransition";
+                case ModelPhase::EXTERNAL: return "externalTransition";
+                case ModelPhase::OUTPUT: return "output";
+                case ModelPhase::TIME_ADVANCE: return "timeAdvance";
+            }
+            return "unknown";
+        }
+
+        // One row per model type and function, most expensive first
+        void report(std::ostream& out) const {
+            struct Row {
+                const Entry* entry;
+                ModelPhase phase;
+            };
+            std::vector<Row> rows;
+            uint64_t totalTicks = 0;
+            for (const auto& entry : entries) {
+                for (size_t phase = 0; phase < PHASES; phase++) {
+                    if (entry.calls[phase] > 0) {
+                        rows.push_back({&entry, static_cast<ModelPhase>(phase)});
+                        totalTicks += entry.ticks[phase];
+                    }
+                }
+            }
+            std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+                return a.entry -> ticks[static_cast<size_t>(a.phase)] > b.entry -> ticks[static_cast<size_t>(b.phase)];
+            });
+
+            double tick = secondsPerTick();
+            out << "Model profile (wall time)\n"
+                << std::left << std::setw(6) << "rank" << std::setw(36) << "model" << std::setw(20) << "function"
+                << std::right << std::setw(12) << "calls" << std::setw(14) << "total ms" << std::setw(12) << "mean ns"
+                << std::setw(9) << "share" << "\n";
+            for (size_t i = 0; i < rows.size(); i++) {
+                size_t phase = static_cast<size_t>(rows[i].phase);
+                uint64_t calls = rows[i].entry -> calls[phase];
+                uint64_t ticks = rows[i].entry -> ticks[phase];
+                out << std::left << std::setw(6) << i + 1 << std::setw(36) << rows[i].entry -> type
+                    << std::setw(20) << PhaseName(rows[i].phase) << std::right << std::setw(12) << calls
+                    << std::fixed << std::setprecision(3) << std::setw(14) << ticks * tick * 1e3
+                    << std::setprecision(0) << std::setw(12) << ticks * tick * 1e9 / calls
+                    << std::setprecision(1) << std::setw(8) << (totalTicks ? 100.0 * ticks / totalTicks : 0) << "%\n"
+                    << std::defaultfloat;
+            }
+        }
+
+    private:
+        inline static std::atomic<uint64_t> nextId{1};
+        inline static ModelProfiler* activeProfiler = nullptr;
+
+        uint64_t id;
+        uint64_t startTicks;
+        std::chrono::steady_clock::time_point startTime;
+        std::vector<Entry> entries;
+};
+
+// Readable name of a C++ type, e.g. "Buffer<RaftMessage>"
+inline std::string DemangledTypeName(const std::type_info& type) {
+    int status = 0;
+    std::unique_ptr<char, void (*)(void*)> name(abi::__cxa_demangle(type.name(), nullptr, nullptr, &status), std::free);
+    return (status == 0 && name) ? name.get() : type.name();
+}
+
+template <typename S>
+S AtomicStateOf(const cadmium::Atomic<S>*);
+
+// Decorator that times the DEVS functions of Model into the active ModelProfiler. With no
+// profiler active each call costs one extra branch.
+//
+//   auto network = addComponent<Profiled<NetworkModel>>("network", nodesID);
+template <typename Model>
+class Profiled : public Model {
+    public:
+        using State = decltype(AtomicStateOf(std::declval<Model*>()));
+        using Model::Model;
+
+        void internalTransition(State& s) const override {
+            Timer timer(ModelPhase::INTERNAL);
+            Model::internalTransition(s);
+        }
+
+        void externalTransition(State& s, double e) const override {
+            Timer timer(ModelPhase::EXTERNAL);
+            Model::externalTransition(s, e);
+        }
+
+        // Not timed itself, it is made of the two transitions above
+        void confluentTransition(State& s, double e) const override {
+            Model::confluentTransition(s, e);
+        }
+
+        void output(const State& s) const override {
+            Timer timer(ModelPhase::OUTPUT);
+            Model::output(s);
+        }
+
+        double timeAdvance(const State& s) const override {
+            Timer timer(ModelPhase::TIME_ADVANCE);
+            return Model::timeAdvance(s);
+        }
+
+    private:
+        // Slot of Model in the profiler it was last resolved against
+        inline static uint64_t boundProfiler = 0;
+        inline static size_t typeSlot = 0;
+
+        class Timer {
+            public:
+                explicit Timer(ModelPhase _phase) : profiler(ModelProfiler::Active()), phase(_phase) {
+                    if (profiler) {
+                        start = ModelProfiler::Now();
+                    }
+                }
+
+                ~Timer() {
+                    if (profiler) {
+                        uint64_t ticks = ModelProfiler::Now() - start;
+                        if (boundProfiler != profiler -> getId()) {
+                            typeSlot = profiler -> typeIndex(DemangledTypeName(typeid(Model)));
+                            boundProfiler = profiler -> getId();
+                        }
+                        profiler -> add(typeSlot, phase, ticks);
+                    }
+                }
+
+            private:
+                ModelProfiler* profiler;
+                ModelPhase phase;
+                uint64_t start = 0;
+        };
+};
+
+// Atomic models in the coupled models are wrapped only when built with -DRAFT_PROFILE_MODELS,
+// so normal builds pay nothing
+#ifdef RAFT_PROFILE_MODELS
+template <typename Model>
+using MaybeProfiled = Profiled<Model>;
+#else
+template <typename Model>
+using MaybeProfiled = Model;
+#endif
+
+// Run the simulation with a profiler active and write the ranked report when it returns
+template <typename Root>
+void SimulateProfiled(Root& root, double time, std::ostream& out) {
+    ModelProfiler profiler;
+    ModelProfiler* previous = ModelProfiler::Active();
+    ModelProfiler::Activate(&profiler);
+    root.simulate(time);
+    ModelProfiler::Activate(previous);
+    profiler.report(out);
+}
+
+#endif
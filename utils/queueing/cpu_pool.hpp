@@ -0,0 +1,60 @@
+#ifndef CPU_POOL_HPP
+#define CPU_POOL_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// The cores of one node, shared by all of its models. Jobs are served first come first served:
+// each takes the core that frees up first and keeps it until done. Models submit a job when it
+// arrives and get back the simulation time it completes. Arrivals reach the pool in simulation
+// time order, so choosing the core at submission is exact.
+class CpuPool {
+    public:
+        explicit CpuPool(size_t cores = 1) : freeAt(std::max<size_t>(cores, 1), 0.0) {}
+
+        // Completion time of a job arriving at `arrival` that needs `service` seconds of one core
+        double submit(double arrival, double service) {
+            std::pop_heap(freeAt.begin(), freeAt.end(), std::greater<double>());
+            double start = std::max(arrival, freeAt.back());
+            freeAt.back() = start + service;
+            std::push_heap(freeAt.begin(), freeAt.end(), std::greater<double>());
+
+            jobs++;
+            busyTime += service;
+            waitTime += start - arrival;
+            return start + service;
+        }
+
+        size_t getCores() const {
+            return freeAt.size();
+        }
+
+        uint64_t getJobs() const {
+            return jobs;
+        }
+
+        // Core-seconds spent on jobs submitted so far
+        double getBusyTime() const {
+            return busyTime;
+        }
+
+        // Seconds jobs spent waiting for a core, summed
+        double getWaitTime() const {
+            return waitTime;
+        }
+
+        // Share of the cores' capacity used up to `now`
+        double utilization(double now) const {
+            return now > 0 ? busyTime / (now * freeAt.size()) : 0;
+        }
+
+    private:
+        std::vector<double> freeAt;  // Min-heap, when each core is next free
+        uint64_t jobs = 0;
+        double busyTime = 0;
+        double waitTime = 0;
+};
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef DELAY_LINE_HPP
+#define DELAY_LINE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Items held until an absolute due time, the event list of a DEVS model that delays what passes
+// through it. timeAdvance is the time left until nextDue(); output emits every item due at that
+// instant as one bag (forEachDue) and internalTransition removes the same items (popDue). Passing
+// the current time also takes items that are overdue, e.g. held back while a model was paused.
+// Items come out in due order, those due together in the order they were pushed.
+template <typename T>
+class DelayLine {
+    public:
+        struct Entry {
+            T item;
+            double since;  // When the item entered the line
+            double due;
+            uint64_t sequence;
+        };
+
+        void push(T item, double since, double due) {
+            entries.push_back(Entry{std::move(item), since, due, pushed++});
+            std::push_heap(entries.begin(), entries.end(), Later());
+        }
+
+        size_t size() const {
+            return entries.size();
+        }
+
+        bool empty() const {
+            return entries.empty();
+        }
+
+        // Infinity when empty
+        double nextDue() const {
+            return entries.empty() ? std::numeric_limits<double>::infinity() : entries.front().due;
+        }
+
+        // Remaining time from `now`, never negative
+        double timeUntilNext(double now) const {
+            return std::max(0.0, nextDue() - now);
+        }
+
+        // The earliest entry
+        const Entry& top() const {
+            return entries.front();
+        }
+
+        // Calls f(entry) for every entry due by nextDue() or `now`, whichever is later
+        template <typename F>
+        void forEachDue(F f, double now = -std::numeric_limits<double>::infinity()) const {
+            if (entries.empty()) {
+                return;
+            }
+            std::vector<const Entry*> due;
+            collectDue(0, std::max(entries.front().due, now), due);
+            std::sort(due.begin(), due.end(), [](const Entry* a, const Entry* b) { return Later()(*b, *a); });
+            for (const Entry* entry : due) {
+                f(*entry);
+            }
+        }
+
+        // Removes and returns the entries forEachDue visits, in the same order
+        std::vector<Entry> popDue(double now = -std::numeric_limits<double>::infinity()) {
+            std::vector<Entry> due;
+            if (entries.empty()) {
+                return due;
+            }
+            double time = std::max(entries.front().due, now);
+            while (!entries.empty() && entries.front().due <= time) {
+                std::pop_heap(entries.begin(), entries.end(), Later());
+                due.push_back(std::move(entries.back()));
+                entries.pop_back();
+            }
+            return due;
+        }
+
+    private:
+        // Heap order: earliest due first, then push order
+        struct Later {
+            bool operator()(const Entry& a, const Entry& b) const {
+                return a.due != b.due ? a.due > b.due : a.sequence > b.sequence;
+            }
+        };
+
+        std::vector<Entry> entries;  // Binary min-heap under Later
+        uint64_t pushed = 0;
+
+        // Children are never due earlier than their parent, so only subtrees rooted at a due entry are searched
+        void collectDue(size_t i, double time, std::vector<const Entry*>& due) const {
+            if (i >= entries.size() || entries[i].due > time) {
+                return;
+            }
+            due.push_back(&entries[i]);
+            collectDue(2 * i + 1, time, due);
+            collectDue(2 * i + 2, time, due);
+        }
+};
+
+#endif
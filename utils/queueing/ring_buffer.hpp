@@ -0,0 +1,98 @@
+#ifndef RING_BUFFER_HPP
+#define RING_BUFFER_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// FIFO over one contiguous array. With a capacity the ring never reallocates and push_back
+// refuses when full; with capacity 0 it is unbounded and doubles its storage as needed.
+template <typename T>
+class RingBuffer {
+    public:
+        RingBuffer() : RingBuffer(0) {}
+
+        explicit RingBuffer(size_t _capacity) : capacity(_capacity), slots(_capacity ? _capacity : 8) {}
+
+        size_t size() const {
+            return count;
+        }
+
+        bool empty() const {
+            return count == 0;
+        }
+
+        bool bounded() const {
+            return capacity != 0;
+        }
+
+        bool full() const {
+            return bounded() && count == capacity;
+        }
+
+        size_t getCapacity() const {
+            return capacity;
+        }
+
+        // False, leaving the ring unchanged, when it is bounded and full
+        bool push_back(T value) {
+            if (count == slots.size()) {
+                if (bounded()) {
+                    return false;
+                }
+                grow();
+            }
+            slots[(head + count) % slots.size()] = std::move(value);
+            count++;
+            return true;
+        }
+
+        void pop_front() {
+            slots[head] = T();
+            head = (head + 1) % slots.size();
+            count--;
+        }
+
+        T& front() {
+            return slots[head];
+        }
+
+        const T& front() const {
+            return slots[head];
+        }
+
+        // i-th element from the front
+        T& operator[](size_t i) {
+            return slots[(head + i) % slots.size()];
+        }
+
+        const T& operator[](size_t i) const {
+            return slots[(head + i) % slots.size()];
+        }
+
+        // Remove the i-th element from the front, shifting the elements behind it forward
+        void erase(size_t i) {
+            for (; i + 1 < count; i++) {
+                (*this)[i] = std::move((*this)[i + 1]);
+            }
+            (*this)[count - 1] = T();
+            count--;
+        }
+
+    private:
+        size_t capacity;
+        std::vector<T> slots;
+        size_t head = 0;
+        size_t count = 0;
+
+        void grow() {
+            std::vector<T> larger(slots.size() * 2);
+            for (size_t i = 0; i < count; i++) {
+                larger[i] = std::move((*this)[i]);
+            }
+            slots = std::move(larger);
+            head = 0;
+        }
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef SERVICE_TIMES_HPP
+#define SERVICE_TIMES_HPP
+
+#include <map>
+#include <memory>
+#include "../stochastic/random.hpp"
+#include "../../messages/raft/raft_messages.hpp"
+
+// Where a message uses the CPU: the message processor encodes outgoing messages, the packet
+// processor decodes incoming ones
+enum class CpuStage { ENCODE, DECODE };
+
+// Mean CPU time a Raft message costs, by stage, message type and size, plus the cost of the
+// authentication it carries. Samples are exponential around the mean unless `exponential` is off.
+struct ServiceTimes {
+    std::map<Task, double> encode;  // Seconds per message type, `base` for types not listed
+    std::map<Task, double> decode;
+    double base = 1e-6;
+    double perEntry = 2e-7;  // Per AppendEntries log entry
+    double mac = 1e-6;  // Per HMAC tag computed (encode) or checked (decode)
+    double sign = 1e-3;  // RSA signature, encode
+    double verify = 5e-5;  // RSA signature check, decode
+    bool exponential = true;
+
+    double mean(CpuStage stage, const RaftMessage& msg) const {
+        const std::map<Task, double>& table = stage == CpuStage::ENCODE ? encode : decode;
+        Task task = msg.content -> getType();
+        auto listed = table.find(task);
+        double seconds = listed != table.end() ? listed -> second : base;
+
+        if (task == Task::APPEND_ENTRIES) {
+            seconds += perEntry * std::static_pointer_cast<AppendEntries>(msg.content) -> metadata.entries.size();
+        }
+        if (IsSigned(msg)) {
+            seconds += stage == CpuStage::ENCODE ? sign : verify;
+        }
+        // A broadcast is tagged once per peer, each receiver checks its own tag
+        if (!msg.macVector.empty()) {
+            seconds += mac * (stage == CpuStage::ENCODE ? msg.macVector.size() : 1);
+        }
+        return seconds;
+    }
+
+    double sample(CpuStage stage, const RaftMessage& msg) const {
+        double seconds = mean(stage, msg);
+        return (exponential && seconds > 0) ? RandomNumberGeneratorDEVS::generateExponentialDelay(1.0 / seconds) : seconds;
+    }
+
+    // Whether the message carries a real RSA signature rather than the controller's placeholder
+    static bool IsSigned(const RaftMessage& msg) {
+        const std::string* signature = nullptr;
+        switch (msg.content -> getType()) {
+            case Task::VOTE_REQUEST:
+                signature = &std::static_pointer_cast<RequestVote>(msg.content) -> msgDigestSigned;
+                break;
+            case Task::VOTE_RESPONSE:
+                signature = &std::static_pointer_cast<ResponseVote>(msg.content) -> msgDigestSigned;
+                break;
+            case Task::APPEND_ENTRIES:
+                signature = &std::static_pointer_cast<AppendEntries>(msg.content) -> msgDigestSigned;
+                break;
+            case Task::APPEND_ENTRIES_RESPONSE:
+                signature = &std::static_pointer_cast<AppendEntriesResponse>(msg.content) -> msgDigestSigned;
+                break;
+            case Task::READ_INDEX_REQUEST:
+                signature = &std::static_pointer_cast<ReadIndexRequest>(msg.content) -> msgDigestSigned;
+                break;
+            case Task::READ_INDEX_RESPONSE:
+                signature = &std::static_pointer_cast<ReadIndexResponse>(msg.content) -> msgDigestSigned;
+                break;
+            case Task::PRE_VOTE_REQUEST:
+                signature = &std::static_pointer_cast<PreVoteRequest>(msg.content) -> msgDigestSigned;
+                break;
+            case Task::PRE_VOTE_RESPONSE:
+                signature = &std::static_pointer_cast<PreVoteResponse>(msg.content) -> msgDigestSigned;
+                break;
+            default:
+                break;
+        }
+        return signature && !signature -> empty() && *signature != "msgDigestSigned";
+    }
+};
+
+#endif
@@ -21,4 +21,8 @@ double RandomNumberGeneratorDEVS::generateUniformDelay(double min, double max) {
     std::uniform_real_distribution<> dis(min, max);
     // Generate a random number between min and max
     return dis(gen);
-}
\ No newline at end of file
+}
+
+void RandomNumberGeneratorDEVS::seed(unsigned int value) {
+    gen.seed(value);
+}
@@ -10,6 +10,8 @@ class RandomNumberGeneratorDEVS {
         static double generateExponentialDelay(double lambda);
         static double generateGaussianDelay(double mean, double stddev);
         static double generateUniformDelay(double min, double max);
+        // Reseed the shared generator, runs built after the same seed draw the same delays
+        static void seed(unsigned int value);
 };
 
 #endif
\ No newline at end of file
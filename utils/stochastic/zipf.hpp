@@ -0,0 +1,38 @@
+#ifndef ZIPF_HPP
+#define ZIPF_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "random.hpp"
+
+// Ranks 0..n-1, rank k drawn with probability proportional to 1 / (k + 1)^theta. The CDF is
+// built once, each sample is a binary search over it.
+class ZipfDistribution {
+    public:
+        ZipfDistribution(size_t n, double theta) : cdf(std::max<size_t>(n, 1)) {
+            double total = 0;
+            for (size_t k = 0; k < cdf.size(); k++) {
+                total += 1.0 / std::pow(static_cast<double>(k + 1), theta);
+                cdf[k] = total;
+            }
+            for (double& value : cdf) {
+                value /= total;
+            }
+        }
+
+        size_t sample() const {
+            double u = RandomNumberGeneratorDEVS::generateUniformDelay(0, 1);
+            size_t rank = std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+            return std::min(rank, cdf.size() - 1);
+        }
+
+        size_t size() const {
+            return cdf.size();
+        }
+
+    private:
+        std::vector<double> cdf;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef RTT_ESTIMATOR_HPP
+#define RTT_ESTIMATOR_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Smoothed round-trip time and its mean deviation, updated per sample as TCP does (RFC 6298): the
+// first sample sets both, later ones move the average by 1/8 and the deviation by 1/4 of the error.
+class RttEstimator {
+    public:
+        void observe(double sample) {
+            if (samples == 0) {
+                srtt = sample;
+                rttvar = sample / 2;
+            } else {
+                rttvar = (1 - beta) * rttvar + beta * std::fabs(srtt - sample);
+                srtt = (1 - alpha) * srtt + alpha * sample;
+            }
+            samples++;
+        }
+
+        // Take over an estimate made elsewhere, it counts as one sample
+        void assume(double smoothed, double variation) {
+            srtt = smoothed;
+            rttvar = variation;
+            samples = std::max<uint64_t>(samples, 1);
+        }
+
+        double smoothed() const {
+            return srtt;
+        }
+
+        double variation() const {
+            return rttvar;
+        }
+
+        uint64_t count() const {
+            return samples;
+        }
+
+        // A round trip rarely takes longer than this
+        double timeout() const {
+            return srtt + 4 * rttvar;
+        }
+
+    private:
+        static constexpr double alpha = 0.125;
+        static constexpr double beta = 0.25;
+        double srtt = 0;
+        double rttvar = 0;
+        uint64_t samples = 0;
+};
+
+#endif
@@ -0,0 +1,207 @@
+#ifndef MESSAGE_TRACER_HPP
+#define MESSAGE_TRACER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// One step of a message's journey: the span it spent in a model, or an instant (begin == end)
+struct TraceEvent {
+    uint64_t traceId;
+    std::string node;    // Chrome trace process, e.g. "node1" or "network"
+    std::string model;   // Chrome trace thread, e.g. "packet-processor"
+    std::string name;    // What happened, e.g. "APPEND_ENTRIES"
+    std::string branch;  // Destination a broadcast copy is heading to, "" before the network fans it out
+    double begin;
+    double end;
+    bool instant;
+};
+
+// Collects per-hop timestamps of traced messages and writes them as Chrome trace-event JSON,
+// which chrome://tracing and ui.perfetto.dev open directly. Each model records the span a
+// message spent with it when the message leaves, and flow arrows chain the spans of one trace
+// id, one chain per destination of a broadcast. The tracer is off unless one is active
+// (installed by ChromeTraceLogger), models then skip all tracing work.
+class MessageTracer {
+    public:
+        static MessageTracer* Active() {
+            return activeTracer;
+        }
+
+        static void Activate(MessageTracer* tracer) {
+            activeTracer = tracer;
+        }
+
+        // Id for a new message, 0 (untraced) when no tracer is active
+        static uint64_t NextTraceId() {
+            return activeTracer ? ++activeTracer -> lastTraceId : 0;
+        }
+
+        void span(uint64_t traceId, const std::string& node, const std::string& model, const std::string& name,
+                  double begin, double end, const std::string& branch = "") {
+            if (traceId != 0) {
+                events.push_back({traceId, node, model, name, branch, begin, end, false});
+            }
+        }
+
+        void instant(uint64_t traceId, const std::string& node, const std::string& model, const std::string& name,
+                     double time, const std::string& branch = "") {
+            if (traceId != 0) {
+                events.push_back({traceId, node, model, name, branch, time, time, true});
+            }
+        }
+
+        const std::vector<TraceEvent>& getEvents() const {
+            return events;
+        }
+
+        // Chrome trace-event JSON, times in microseconds of simulation time
+        void writeChromeTrace(std::ostream& out) const {
+            std::map<std::string, int> processes;
+            std::map<std::pair<int, std::string>, int> threads;
+            auto processId = [&](const std::string& node) {
+                return processes.emplace(node, static_cast<int>(processes.size()) + 1).first -> second;
+            };
+            auto threadId = [&](int pid, const std::string& model) {
+                return threads.emplace(std::make_pair(pid, model), static_cast<int>(threads.size()) + 1).first -> second;
+            };
+
+            std::streamsize precision = out.precision(15);
+            out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+            bool first = true;
+            auto separator = [&]() {
+                out << (first ? "\n" : ",\n");
+                first = false;
+            };
+
+            for (const auto& event : events) {
+                int pid = processId(event.node);
+                int tid = threadId(pid, event.model);
+                separator();
+                out << "{\"name\":\"" << escape(event.name) << "\",\"cat\":\"raft\",\"ph\":\"" << (event.instant ? "i" : "X")
+                    << "\",\"ts\":" << micros(event.begin);
+                if (event.instant) {
+                    out << ",\"s\":\"t\"";
+                } else {
+                    out << ",\"dur\":" << micros(event.end - event.begin);
+                }
+                out << ",\"pid\":" << pid << ",\"tid\":" << tid
+                    << ",\"args\":{\"trace_id\":" << event.traceId;
+                if (!event.branch.empty()) {
+                    out << ",\"to\":\"" << escape(event.branch) << "\"";
+                }
+                out << "}}";
+            }
+
+            // Flow arrows, one chain per trace id and destination
+            uint64_t flowId = 0;
+            for (const auto& chain : chains()) {
+                flowId++;
+                for (size_t i = 0; i < chain.size(); i++) {
+                    const TraceEvent& event = *chain[i];
+                    int pid = processId(event.node);
+                    separator();
+                    out << "{\"name\":\"message\",\"cat\":\"flow\",\"ph\":\""
+                        << (i == 0 ? "s" : (i + 1 == chain.size() ? "f" : "t"))
+                        << "\",\"id\":" << flowId << ",\"ts\":" << micros(event.begin)
+                        << ",\"pid\":" << pid << ",\"tid\":" << threadId(pid, event.model);
+                    if (i != 0) {
+                        out << ",\"bp\":\"e\"";
+                    }
+                    out << "}";
+                }
+            }
+
+            // Names for the process and thread ids
+            for (const auto& [node, pid] : processes) {
+                separator();
+                out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"args\":{\"name\":\"" << escape(node) << "\"}}";
+            }
+            for (const auto& [key, tid] : threads) {
+                separator();
+                out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << key.first << ",\"tid\":" << tid
+                    << ",\"args\":{\"name\":\"" << escape(key.second) << "\"}}";
+            }
+            out << "\n]}\n";
+            out.precision(precision);
+        }
+
+    private:
+        inline static MessageTracer* activeTracer = nullptr;
+
+        uint64_t lastTraceId = 0;
+        std::vector<TraceEvent> events;
+
+        // Events of each trace id in time order, the shared prefix repeated for every destination
+        std::vector<std::vector<const TraceEvent*>> chains() const {
+            std::map<uint64_t, std::vector<const TraceEvent*>> byTrace;
+            for (const auto& event : events) {
+                byTrace[event.traceId].push_back(&event);
+            }
+            std::vector<std::vector<const TraceEvent*>> result;
+            for (auto& [traceId, traceEvents] : byTrace) {
+                std::stable_sort(traceEvents.begin(), traceEvents.end(),
+                                 [](const TraceEvent* a, const TraceEvent* b) { return a -> begin < b -> begin; });
+                std::map<std::string, std::vector<const TraceEvent*>> branches;
+                std::vector<const TraceEvent*> shared;
+                for (const TraceEvent* event : traceEvents) {
+                    if (event -> branch.empty()) {
+                        shared.push_back(event);
+                    } else {
+                        branches[event -> branch].push_back(event);
+                    }
+                }
+                if (branches.empty()) {
+                    branches[""];
+                }
+                for (auto& [branch, branchEvents] : branches) {
+                    std::vector<const TraceEvent*> chain;
+                    std::merge(shared.begin(), shared.end(), branchEvents.begin(), branchEvents.end(), std::back_inserter(chain),
+                               [](const TraceEvent* a, const TraceEvent* b) { return a -> begin < b -> begin; });
+                    if (chain.size() > 1) {
+                        result.push_back(std::move(chain));
+                    }
+                }
+            }
+            return result;
+        }
+
+        static double micros(double seconds) {
+            return seconds * 1e6;
+        }
+
+        static std::string escape(const std::string& text) {
+            std::string escaped;
+            for (char c : text) {
+                if (c == '"' || c == '\\') {
+                    escaped += '\\';
+                }
+                escaped += c;
+            }
+            return escaped;
+        }
+};
+
+// Trace id of a message, 0 for message types that do not carry one
+template <typename Message, typename = void>
+struct TraceIdOf {
+    static uint64_t get(const Message&) {
+        return 0;
+    }
+};
+
+template <typename Message>
+struct TraceIdOf<Message, std::void_t<decltype(std::declval<Message>().traceId)>> {
+    static uint64_t get(const Message& message) {
+        return message.traceId;
+    }
+};
+
+#endif